@@ -0,0 +1,225 @@
+#include "assemblyparser.h"
+
+#include "resultutils.h"
+#include "rustdemangle.h"
+#include "rusttr.h"
+
+#include <utils/algorithm.h>
+
+#include <QFile>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+QList<int> AssemblyModule::functionsAt(const FilePath &file, int line, bool *inlined) const
+{
+    QList<int> result;
+    const int fileIndex = int(files.indexOf(file));
+    if (fileIndex < 0)
+        return result;
+
+    // Closures are defined inside of the function they belong to, the
+    // innermost definition around the line wins.
+    int definitionLine = 0;
+    for (int i = 0; i < functions.size(); ++i) {
+        const AssemblyFunction &function = functions.at(i);
+        if (function.file != fileIndex || function.line > line || function.lastLine < line
+            || function.line < definitionLine) {
+            continue;
+        }
+        if (function.line > definitionLine) {
+            result.clear();
+            definitionLine = function.line;
+        }
+        result.append(i);
+    }
+    *inlined = result.isEmpty();
+    if (!result.isEmpty())
+        return result;
+
+    for (int i = 0; i < functions.size(); ++i) {
+        const QList<AssemblyLine> &lines = functions.at(i).lines;
+        if (std::any_of(lines.cbegin(), lines.cend(), [fileIndex, line](const AssemblyLine &l) {
+                return l.file == fileIndex && l.line == line;
+            })) {
+            result.append(i);
+        }
+    }
+    return result;
+}
+
+AssemblyParser::AssemblyParser(AssemblyModule &module, const FilePath &workingDirectory)
+    : m_module(module)
+    , m_workingDirectory(workingDirectory)
+{}
+
+int AssemblyParser::fileIndex(const FilePath &file)
+{
+    const int index = int(m_module.files.indexOf(file));
+    if (index >= 0)
+        return index;
+    m_module.files.append(file);
+    return int(m_module.files.size()) - 1;
+}
+
+void AssemblyParser::startFunction(const QString &symbol)
+{
+    m_function = {};
+    m_function.symbol = symbol;
+    m_function.name = demangleRustSymbol(symbol);
+    if (m_function.name.isEmpty())
+        m_function.name = symbol;
+    m_inFunction = true;
+    m_label.clear();
+    m_line = 0;
+}
+
+void AssemblyParser::finishFunction()
+{
+    if (!m_function.lines.isEmpty())
+        m_module.functions.append(std::move(m_function));
+    m_function = {};
+    m_inFunction = false;
+}
+
+void AssemblyParser::addLine(const QString &line)
+{
+    static const QRegularExpression fileDirective(
+        R"(^\.file\s+(\d+)\s+"([^"]*)"(?:\s+"([^"]*)")?)");
+    static const QRegularExpression locDirective(R"(^\.loc\s+(\d+)\s+(\d+))");
+    static const QRegularExpression typeDirective(R"(^\.type\s+"?([^",\s]+)"?\s*,\s*[@%]function)");
+    static const QRegularExpression sizeDirective(R"(^\.size\s+"?([^",\s]+)"?\s*,)");
+
+    const QString trimmed = line.trimmed();
+    if (trimmed.isEmpty())
+        return;
+
+    // Comment lines, "# %bb.0:" on x86, "// %bb.0:" on ARM.
+    if (trimmed.startsWith('#') || trimmed.startsWith("//")) {
+        if (trimmed.startsWith("//"))
+            m_module.commentPrefix = "//";
+        return;
+    }
+
+    const qsizetype colon = trimmed.indexOf(':');
+    const bool isLabel = !line.at(0).isSpace() && colon > 0 && !trimmed.left(colon).contains(' ')
+                         && !trimmed.left(colon).contains('\t');
+    if (isLabel) {
+        QString label = trimmed.left(colon);
+        if (label.startsWith('"'))
+            label = label.mid(1, label.size() - 2);
+        if (m_functionSymbols.contains(label)) {
+            if (m_inFunction)
+                finishFunction();
+            startFunction(label);
+        } else if (label.startsWith(".L") || label.startsWith('L')) {
+            // Only the basic blocks are jumped to, ".Ltmp" and alike mark
+            // debug information.
+            if (m_inFunction && (label.startsWith(".LBB") || label.startsWith("LBB")))
+                m_function.lines.append({label + ':', -1, 0});
+        } else {
+            if (m_inFunction)
+                finishFunction();
+            m_label = label;
+        }
+        return;
+    }
+
+    if (trimmed.startsWith('.')) {
+        if (const QRegularExpressionMatch match = locDirective.match(trimmed); match.hasMatch()) {
+            m_file = m_files.value(match.captured(1).toInt(), -1);
+            m_line = match.captured(2).toInt();
+            if (m_inFunction && m_line > 0) {
+                if (m_function.file < 0) {
+                    m_function.file = m_file;
+                    m_function.line = m_line;
+                }
+                if (m_file == m_function.file)
+                    m_function.lastLine = qMax(m_function.lastLine, m_line);
+            }
+        } else if (const QRegularExpressionMatch match = fileDirective.match(trimmed);
+                   match.hasMatch()) {
+            // DWARF 5 has the directory and the file name, older versions a path.
+            const FilePath file = match.hasCaptured(3)
+                ? m_workingDirectory.resolvePath(match.captured(2)).resolvePath(match.captured(3))
+                : m_workingDirectory.resolvePath(match.captured(2));
+            m_files.insert(match.captured(1).toInt(), fileIndex(file.cleanPath()));
+        } else if (const QRegularExpressionMatch match = typeDirective.match(trimmed);
+                   match.hasMatch()) {
+            m_functionSymbols.insert(match.captured(1));
+        } else if (trimmed.startsWith(".cfi_startproc")) {
+            // Mach-O has no ".type", the label right before starts the function.
+            if (!m_inFunction && !m_label.isEmpty())
+                startFunction(m_label);
+        } else if (trimmed.startsWith(".cfi_endproc")) {
+            if (m_inFunction)
+                finishFunction();
+        } else if (const QRegularExpressionMatch match = sizeDirective.match(trimmed);
+                   match.hasMatch()) {
+            if (m_inFunction && match.captured(1) == m_function.symbol)
+                finishFunction();
+        }
+        return;
+    }
+
+    if (!m_inFunction)
+        return;
+    QString text = line;
+    while (!text.isEmpty() && text.back().isSpace())
+        text.chop(1);
+    if (mayContainRustSymbol(text))
+        text = demangleRustSymbols(text);
+    m_function.lines.append({text, m_file, m_line});
+}
+
+bool AssemblyModule::isOutdated() const
+{
+    // Only a stat per source, this runs on the GUI thread for every lookup.
+    return Utils::anyOf(sources, [this](const FilePath &source) {
+        return source.lastModified() >= builtAt;
+    });
+}
+
+void buildAssembly(QPromise<AssemblyModule> &promise, const CrateEmitBuild &build)
+{
+    AssemblyModule module;
+    module.builtAt = QDateTime::currentDateTime();
+    QString error;
+    const FilePaths assemblyFiles = runCrateEmitBuild(
+        build, "s", [&promise] { return promise.isCanceled(); }, &module.sources, &error);
+    if (promise.isCanceled())
+        return;
+    if (assemblyFiles.isEmpty()) {
+        reportWorkerFailure(promise, error);
+        return;
+    }
+
+    promise.setProgressRange(0, int(assemblyFiles.size()));
+    for (int i = 0; i < assemblyFiles.size(); ++i) {
+        QFile input(assemblyFiles.at(i).toFSPathString());
+        if (!input.open(QIODevice::ReadOnly)) {
+            reportWorkerFailure(promise, Tr::tr("Cannot open %1.")
+                                             .arg(assemblyFiles.at(i).toUserOutput()));
+            return;
+        }
+        AssemblyParser parser(module, build.workingDirectory);
+        while (!input.atEnd())
+            parser.addLine(QString::fromUtf8(input.readLine()));
+        if (promise.isCanceled())
+            return;
+        promise.setProgressValue(i + 1);
+    }
+    // Inlined code of the standard library refers to files that are not
+    // installed, only those that exist are interleaved.
+    for (const FilePath &file : std::as_const(module.files)) {
+        if (const expected_str<QByteArray> contents = file.fileContents())
+            module.sourceLines.insert(file, QString::fromUtf8(*contents).split('\n'));
+    }
+    promise.addResult(std::move(module));
+}
+
+} // Rusty::Internal
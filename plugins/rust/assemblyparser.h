@@ -0,0 +1,93 @@
+#ifndef ASSEMBLYPARSER_H
+#define ASSEMBLYPARSER_H
+
+#include "crateemit.h"
+
+#include <utils/filepath.h>
+
+#include <QDateTime>
+#include <QHash>
+#include <QPromise>
+#include <QSet>
+
+namespace Rusty::Internal {
+
+class AssemblyLine
+{
+public:
+    QString text;
+    int file = -1;      // Index into AssemblyModule::files, of the last .loc.
+    int line = 0;       // 0 for code without a source location.
+};
+
+class AssemblyFunction
+{
+public:
+    QString symbol;     // As emitted, mangled.
+    QString name;       // Demangled.
+    int file = -1;      // Of the first .loc, the function's own definition.
+    int line = 0;
+    int lastLine = 0;   // Last line of the definition's file the code refers to.
+    QList<AssemblyLine> lines;
+};
+
+class AssemblyModule
+{
+public:
+    Utils::FilePaths files;
+    QList<AssemblyFunction> functions;
+    QHash<Utils::FilePath, QStringList> sourceLines;   // Of the files that exist.
+    QString commentPrefix = "#";
+
+    // The crate's sources as listed by rustc's dep-info, and when the build
+    // started. A source modified since makes the module outdated.
+    Utils::FilePaths sources;
+    QDateTime builtAt;
+
+    bool isOutdated() const;
+
+    // The functions defined at line of file, generic functions have one per
+    // instance. If none was emitted, e.g. because it was inlined everywhere,
+    // the functions with code for that line.
+    QList<int> functionsAt(const Utils::FilePath &file, int line, bool *inlined) const;
+};
+
+/**
+ * @brief Parses the GNU assembler output of rustc
+ *
+ * A function starts at its label, either declared by ".type name,@function"
+ * or followed by ".cfi_startproc" as on macOS, and ends at its ".size" or
+ * ".cfi_endproc". Of the directives, only ".file" and ".loc" matter: they
+ * tell the source line each instruction was generated from. Every codegen
+ * unit's file has its own ".file" numbers, a parser reads one of them.
+ */
+class AssemblyParser
+{
+public:
+    AssemblyParser(AssemblyModule &module, const Utils::FilePath &workingDirectory);
+
+    void addLine(const QString &line);
+
+private:
+    int fileIndex(const Utils::FilePath &file);
+    void startFunction(const QString &symbol);
+    void finishFunction();
+
+    AssemblyModule &m_module;
+    const Utils::FilePath m_workingDirectory;
+    QHash<int, int> m_files;            // ".file" number to module file index.
+    QSet<QString> m_functionSymbols;
+    QString m_label;                    // Last global label outside of a function.
+    AssemblyFunction m_function;
+    bool m_inFunction = false;
+    int m_file = -1;
+    int m_line = 0;
+};
+
+// Meant to run on a worker thread. Runs the build, which emits assembly, and
+// parses that of the crate containing build.sourceFile.
+void buildAssembly(QPromise<AssemblyModule> &promise, const CrateEmitBuild &build);
+
+} // Rusty::Internal
+
+#endif // ASSEMBLYPARSER_H
@@ -0,0 +1,162 @@
+#include "assemblyview.h"
+
+#include "assemblyparser.h"
+#include "rusttr.h"
+
+#include <coreplugin/coreconstants.h>
+#include <coreplugin/editormanager/editormanager.h>
+#include <coreplugin/icore.h>
+#include <coreplugin/messagemanager.h>
+#include <coreplugin/progressmanager/progressmanager.h>
+
+#include <extensionsystem/pluginmanager.h>
+
+#include <texteditor/texteditor.h>
+
+#include <utils/async.h>
+#include <utils/futuresynchronizer.h>
+
+#include <memory>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const char assemblyTaskId[] = "Rusty.Assembly";
+const char assemblyEditorId[] = "Rusty.AssemblyListing";
+
+// The assembly of a crate easily has several megabytes.
+const int maxCachedCrates = 4;
+
+class CachedAssembly
+{
+public:
+    QString key;
+    std::shared_ptr<const AssemblyModule> module;
+};
+
+static QList<CachedAssembly> &assemblyCache()
+{
+    static QList<CachedAssembly> cache;
+    return cache;
+}
+
+static QString sourceComment(const AssemblyModule &module, int file, int line)
+{
+    const FilePath &path = module.files.at(file);
+    const QString source = module.sourceLines.value(path).value(line - 1).trimmed();
+    return QString("%1 %2:%3  %4\n").arg(module.commentPrefix, path.fileName()).arg(line)
+        .arg(source);
+}
+
+static QString listing(const AssemblyModule &module, const QList<int> &functions)
+{
+    QString result;
+    for (int index : functions) {
+        const AssemblyFunction &function = module.functions.at(index);
+        result += QString("%1 %2\n%3:\n").arg(module.commentPrefix, function.name,
+                                              function.symbol);
+        int file = -1;
+        int line = 0;
+        for (const AssemblyLine &assemblyLine : function.lines) {
+            // Like objdump -S, a line shows up again whenever code of
+            // another line was scheduled in between.
+            if (assemblyLine.line > 0 && assemblyLine.file >= 0
+                && (assemblyLine.file != file || assemblyLine.line != line)) {
+                file = assemblyLine.file;
+                line = assemblyLine.line;
+                result += sourceComment(module, file, line);
+            }
+            result += assemblyLine.text + '\n';
+        }
+        result += '\n';
+    }
+    return result;
+}
+
+static void showFunctionsAt(const AssemblyModule &module, const FilePath &file, int line)
+{
+    bool inlined = false;
+    const QList<int> functions = module.functionsAt(file, line, &inlined);
+    if (functions.isEmpty()) {
+        Core::MessageManager::writeFlashing(
+            Tr::tr("No code was generated for %1:%2. Unused functions and generic functions "
+                   "without instances in the crate are not compiled.")
+                .arg(file.toUserOutput()).arg(line));
+        return;
+    }
+
+    QString text;
+    QString title;
+    if (inlined) {
+        text = Tr::tr("%1 Line %2 was inlined into the following functions.\n\n")
+                   .arg(module.commentPrefix).arg(line);
+        title = Tr::tr("Assembly of %1:%2").arg(file.fileName()).arg(line);
+    } else {
+        title = Tr::tr("Assembly of %1").arg(module.functions.at(functions.first()).name);
+    }
+    text += listing(module, functions);
+
+    // Opened in the other split, the source stays visible and active.
+    Core::IEditor *sourceEditor = Core::EditorManager::currentEditor();
+    Core::EditorManager::gotoOtherSplit();
+    Core::IEditor *editor = Core::EditorManager::openEditorWithContents(
+        Core::Constants::K_DEFAULT_TEXT_EDITOR_ID, &title, text.toUtf8(), assemblyEditorId);
+    if (!editor)
+        return;
+    editor->document()->setTemporary(true);
+    if (auto textEditor = qobject_cast<TextEditor::BaseTextEditor *>(editor))
+        textEditor->editorWidget()->setReadOnly(true);
+    if (sourceEditor)
+        Core::EditorManager::activateEditor(sourceEditor);
+}
+
+void showAssemblyAt(const FilePath &file, int line)
+{
+    // Line tables only add the .loc directives, the generated code is the
+    // same as that of the configuration's regular build.
+    QString error;
+    const std::optional<CrateEmitBuild> build
+        = crateEmitBuild(file, {"--emit", "asm", "-C", "debuginfo=line-tables-only"}, &error);
+    if (!build) {
+        Core::MessageManager::writeFlashing(Tr::tr("Cannot show the assembly: %1").arg(error));
+        return;
+    }
+    const QString key = build->key;
+
+    QList<CachedAssembly> &cache = assemblyCache();
+    for (int i = 0; i < cache.size(); ++i) {
+        if (cache.at(i).key != key)
+            continue;
+        const CachedAssembly cached = cache.takeAt(i);
+        if (!cached.module->isOutdated()) {
+            cache.prepend(cached);
+            showFunctionsAt(*cached.module, file, line);
+            return;
+        }
+        break;
+    }
+
+    const QFuture<AssemblyModule> future = Utils::asyncRun(buildAssembly, *build);
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(future);
+    Core::ProgressManager::addTask(future, Tr::tr("Building Assembly"), assemblyTaskId);
+    Utils::onFinished(future, Core::ICore::instance(),
+                      [key, file, line](const QFuture<AssemblyModule> &future) {
+        if (future.isCanceled())
+            return;
+        try {
+            const auto module = std::make_shared<const AssemblyModule>(future.result());
+            QList<CachedAssembly> &cache = assemblyCache();
+            cache.removeIf([&key](const CachedAssembly &cached) { return cached.key == key; });
+            cache.prepend({key, module});
+            while (cache.size() > maxCachedCrates)
+                cache.removeLast();
+            showFunctionsAt(*module, file, line);
+        } catch (const std::exception &error) {
+            Core::MessageManager::writeFlashing(Tr::tr("Cannot show the assembly: %1")
+                                                    .arg(QString::fromStdString(error.what())));
+        }
+    });
+}
+
+} // Rusty::Internal
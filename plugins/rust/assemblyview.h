@@ -0,0 +1,16 @@
+#ifndef ASSEMBLYVIEW_H
+#define ASSEMBLYVIEW_H
+
+#include <utils/filepath.h>
+
+namespace Rusty::Internal {
+
+// Builds the crate containing file with the profile and flags of the active
+// build configuration and shows the assembly of the function at line, with
+// its source lines interleaved, next to the editor. The assembly of the last
+// few crates is kept until one of their sources changes.
+void showAssemblyAt(const Utils::FilePath &file, int line);
+
+} // Rusty::Internal
+
+#endif // ASSEMBLYVIEW_H
@@ -0,0 +1,416 @@
+#include "benchmark.h"
+
+#include "resultutils.h"
+#include "rusttr.h"
+#include "rustutils.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+// Welch's t above which a difference between two benchmarks is reported as
+// real, about 95 % confidence for the run counts used here.
+const double significantT = 2.0;
+
+static FilePath resultsFile(const FilePath &projectDirectory)
+{
+    return rustyDataDirectory(projectDirectory).pathAppended("benchmarks.jsonl");
+}
+
+static FilePath baselinesFile(const FilePath &projectDirectory)
+{
+    return rustyDataDirectory(projectDirectory).pathAppended("benchmark-baselines.json");
+}
+
+BenchmarkStatistics computeStatistics(QList<double> values)
+{
+    BenchmarkStatistics statistics;
+    statistics.count = values.size();
+    if (values.isEmpty())
+        return statistics;
+
+    std::sort(values.begin(), values.end());
+    statistics.min = values.first();
+    statistics.max = values.last();
+    const int middle = values.size() / 2;
+    statistics.median = values.size() % 2 ? values.at(middle)
+                                          : (values.at(middle - 1) + values.at(middle)) / 2;
+    double sum = 0;
+    for (double value : std::as_const(values))
+        sum += value;
+    statistics.mean = sum / values.size();
+    if (values.size() > 1) {
+        double squares = 0;
+        for (double value : std::as_const(values))
+            squares += (value - statistics.mean) * (value - statistics.mean);
+        statistics.stddev = std::sqrt(squares / (values.size() - 1));
+    }
+    return statistics;
+}
+
+template<typename Member>
+static BenchmarkStatistics statisticsOf(const QList<BenchmarkSample> &samples, Member member,
+                                        double scale)
+{
+    QList<double> values;
+    values.reserve(samples.size());
+    for (const BenchmarkSample &sample : samples)
+        values.append(sample.*member * scale);
+    return computeStatistics(values);
+}
+
+BenchmarkStatistics BenchmarkResult::wallTime() const
+{
+    return statisticsOf(samples, &BenchmarkSample::wallTimeNs, 1e-9);
+}
+
+BenchmarkStatistics BenchmarkResult::userTime() const
+{
+    return statisticsOf(samples, &BenchmarkSample::userTimeUs, 1e-6);
+}
+
+BenchmarkStatistics BenchmarkResult::systemTime() const
+{
+    return statisticsOf(samples, &BenchmarkSample::systemTimeUs, 1e-6);
+}
+
+BenchmarkStatistics BenchmarkResult::maxRss() const
+{
+    return statisticsOf(samples, &BenchmarkSample::maxRssKiB, 1);
+}
+
+#ifdef Q_OS_UNIX
+
+static qint64 nanoseconds(const timespec &time)
+{
+    return qint64(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+static qint64 microseconds(const timeval &time)
+{
+    return qint64(time.tv_sec) * 1000000 + time.tv_usec;
+}
+
+// Forks and execs one run and waits for it with wait4(), which reports the
+// resource usage of exactly this child. QProcess cannot provide that, and
+// its event loop round trips would end up in the wall time.
+static BenchmarkSample runOnce(char *const *argv, char *const *envp,
+                               const QByteArray &workingDirectory, const QByteArray &inputFile,
+                               std::atomic<qint64> &runningPid, QString *errorMessage)
+{
+    BenchmarkSample sample;
+    const int input = open(inputFile.constData(), O_RDONLY | O_CLOEXEC);
+    const int output = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (input < 0 || output < 0) {
+        const QByteArray failed = input < 0 ? inputFile : QByteArray("/dev/null");
+        *errorMessage = Tr::tr("Cannot open \"%1\": %2")
+                            .arg(QString::fromLocal8Bit(failed),
+                                 QString::fromLocal8Bit(strerror(errno)));
+        if (input >= 0)
+            close(input);
+        if (output >= 0)
+            close(output);
+        return sample;
+    }
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        // Only async-signal-safe calls from here on.
+        dup2(input, STDIN_FILENO);
+        dup2(output, STDOUT_FILENO);
+        dup2(output, STDERR_FILENO);
+        if (!workingDirectory.isEmpty() && chdir(workingDirectory.constData()) != 0)
+            _exit(127);
+        execve(argv[0], argv, envp);
+        _exit(127);
+    }
+    close(input);
+    close(output);
+    if (pid < 0) {
+        *errorMessage = Tr::tr("Cannot start the program: %1")
+                            .arg(QString::fromLocal8Bit(strerror(errno)));
+        return sample;
+    }
+    runningPid = pid;
+
+    int status = 0;
+    rusage usage{};
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {}
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    runningPid = 0;
+
+    sample.wallTimeNs = nanoseconds(end) - nanoseconds(start);
+    sample.userTimeUs = microseconds(usage.ru_utime);
+    sample.systemTimeUs = microseconds(usage.ru_stime);
+#ifdef Q_OS_MACOS
+    sample.maxRssKiB = usage.ru_maxrss / 1024; // Bytes on macOS.
+#else
+    sample.maxRssKiB = usage.ru_maxrss;
+#endif
+    sample.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return sample;
+}
+
+void runBenchmark(QPromise<BenchmarkSample> &promise,
+                  const BenchmarkOptions &options,
+                  const std::shared_ptr<std::atomic<qint64>> &runningPid)
+{
+    // Everything execve() needs is prepared up front, nothing may allocate
+    // between fork() and exec().
+    QList<QByteArray> arguments{options.command.executable().toFSPathString().toLocal8Bit()};
+    for (const QString &argument : options.command.splitArguments())
+        arguments.append(argument.toLocal8Bit());
+    QList<QByteArray> environment;
+    for (const QString &variable : options.environment.toStringList())
+        environment.append(variable.toLocal8Bit());
+    std::vector<char *> argv;
+    for (QByteArray &argument : arguments)
+        argv.push_back(argument.data());
+    argv.push_back(nullptr);
+    std::vector<char *> envp;
+    for (QByteArray &variable : environment)
+        envp.push_back(variable.data());
+    envp.push_back(nullptr);
+
+    const QByteArray workingDirectory = options.workingDirectory.toFSPathString().toLocal8Bit();
+    const QByteArray inputFile = options.inputFile.isEmpty()
+                                     ? QByteArray("/dev/null")
+                                     : options.inputFile.toFSPathString().toLocal8Bit();
+
+    for (int i = 0; i < options.warmups + options.runs; ++i) {
+        if (promise.isCanceled())
+            return;
+        QString errorMessage;
+        BenchmarkSample sample = runOnce(argv.data(), envp.data(), workingDirectory, inputFile,
+                                         *runningPid, &errorMessage);
+        if (!errorMessage.isEmpty()) {
+            reportWorkerFailure(promise, errorMessage);
+            return;
+        }
+        if (promise.isCanceled())
+            return;
+        sample.warmup = i < options.warmups;
+        promise.addResult(sample);
+        // A failing program is not benchmarked, its timings mean nothing.
+        if (sample.exitCode != 0)
+            return;
+    }
+}
+
+void killBenchmarkRun(const std::shared_ptr<std::atomic<qint64>> &runningPid)
+{
+    const qint64 pid = runningPid->load();
+    if (pid > 0)
+        kill(pid_t(pid), SIGKILL);
+}
+
+#else
+
+void runBenchmark(QPromise<BenchmarkSample> &promise,
+                  const BenchmarkOptions &,
+                  const std::shared_ptr<std::atomic<qint64>> &)
+{
+    reportWorkerFailure(promise, Tr::tr("Benchmarking is only supported on Unix hosts."));
+}
+
+void killBenchmarkRun(const std::shared_ptr<std::atomic<qint64>> &) {}
+
+#endif // Q_OS_UNIX
+
+QString formatDuration(double seconds)
+{
+    if (seconds < 1e-3)
+        return Tr::tr("%1 µs").arg(seconds * 1e6, 0, 'f', 1);
+    if (seconds < 1)
+        return Tr::tr("%1 ms").arg(seconds * 1e3, 0, 'f', seconds < 0.1 ? 2 : 1);
+    return Tr::tr("%1 s").arg(seconds, 0, 'f', 3);
+}
+
+QString formatMemory(qint64 kib)
+{
+    if (kib < 1024)
+        return Tr::tr("%1 KiB").arg(kib);
+    return Tr::tr("%1 MiB").arg(kib / 1024.0, 0, 'f', 1);
+}
+
+QString formatBytes(qint64 bytes)
+{
+    if (bytes < 1024)
+        return Tr::tr("%n bytes", nullptr, int(bytes));
+    return formatMemory(bytes / 1024);
+}
+
+QString formatCount(double value)
+{
+    const double magnitude = std::abs(value);
+    if (magnitude >= 1e9)
+        return Tr::tr("%1 G").arg(value / 1e9, 0, 'f', 2);
+    if (magnitude >= 1e6)
+        return Tr::tr("%1 M").arg(value / 1e6, 0, 'f', 2);
+    if (magnitude >= 1e4)
+        return Tr::tr("%1 K").arg(value / 1e3, 0, 'f', 1);
+    return QString::number(qRound64(value));
+}
+
+QStringList describeBenchmark(const BenchmarkResult &result)
+{
+    const BenchmarkStatistics wall = result.wallTime();
+    const BenchmarkStatistics rss = result.maxRss();
+    return {
+        Tr::tr("Time (mean ± σ): %1 ± %2").arg(formatDuration(wall.mean),
+                                               formatDuration(wall.stddev)),
+        Tr::tr("Range (min … max): %1 … %2, median %3, %n runs", nullptr, wall.count)
+            .arg(formatDuration(wall.min), formatDuration(wall.max), formatDuration(wall.median)),
+        Tr::tr("CPU: user %1, system %2").arg(formatDuration(result.userTime().mean),
+                                              formatDuration(result.systemTime().mean)),
+        Tr::tr("Max RSS: %1 (max %2)").arg(formatMemory(qRound64(rss.mean)),
+                                           formatMemory(qRound64(rss.max)))
+    };
+}
+
+QString compareWithBaseline(const BenchmarkResult &result, const BenchmarkResult &baseline)
+{
+    const BenchmarkStatistics current = result.wallTime();
+    const BenchmarkStatistics base = baseline.wallTime();
+    if (current.count == 0 || base.count == 0 || base.mean <= 0)
+        return {};
+
+    const double change = 100 * (current.mean - base.mean) / base.mean;
+    const double standardError = std::sqrt(current.stddev * current.stddev / current.count
+                                           + base.stddev * base.stddev / base.count);
+    const bool significant = standardError > 0
+                                 ? std::abs(current.mean - base.mean) / standardError > significantT
+                                 : current.mean != base.mean;
+
+    const QString baselineText = Tr::tr("%1 ± %2 in the baseline of %3")
+                                     .arg(formatDuration(base.mean), formatDuration(base.stddev),
+                                          baseline.timestamp.toString(Qt::ISODate));
+    if (!significant)
+        return Tr::tr("No significant change to %1.").arg(baselineText);
+    if (change < 0)
+        return Tr::tr("%1 % faster than %2.").arg(-change, 0, 'f', 1).arg(baselineText);
+    return Tr::tr("%1 % slower than %2.").arg(change, 0, 'f', 1).arg(baselineText);
+}
+
+static QJsonObject toJson(const BenchmarkResult &result)
+{
+    QJsonArray samples;
+    for (const BenchmarkSample &sample : result.samples) {
+        samples.append(QJsonArray{sample.wallTimeNs, sample.userTimeUs, sample.systemTimeUs,
+                                  sample.maxRssKiB});
+    }
+    return {{"timestamp", result.timestamp.toString(Qt::ISODate)},
+            {"key", result.key},
+            {"name", result.name},
+            {"configuration", result.configuration},
+            {"command", result.command},
+            {"warmups", result.warmups},
+            {"samples", samples}};
+}
+
+static BenchmarkResult fromJson(const QJsonObject &object)
+{
+    BenchmarkResult result;
+    result.timestamp = QDateTime::fromString(object.value("timestamp").toString(), Qt::ISODate);
+    result.key = object.value("key").toString();
+    result.name = object.value("name").toString();
+    result.configuration = object.value("configuration").toString();
+    result.command = object.value("command").toString();
+    result.warmups = object.value("warmups").toInt();
+    for (const QJsonValue &value : object.value("samples").toArray()) {
+        const QJsonArray array = value.toArray();
+        BenchmarkSample sample;
+        sample.wallTimeNs = array.at(0).toInteger();
+        sample.userTimeUs = array.at(1).toInteger();
+        sample.systemTimeUs = array.at(2).toInteger();
+        sample.maxRssKiB = array.at(3).toInteger();
+        result.samples.append(sample);
+    }
+    return result;
+}
+
+void appendBenchmarkResult(const FilePath &projectDirectory, const BenchmarkResult &result)
+{
+    const FilePath file = resultsFile(projectDirectory);
+    if (!file.parentDir().ensureWritableDir())
+        return;
+    QFile out(file.toFSPathString());
+    if (out.open(QIODevice::WriteOnly | QIODevice::Append))
+        out.write(QJsonDocument(toJson(result)).toJson(QJsonDocument::Compact) + '\n');
+}
+
+QList<BenchmarkResult> loadBenchmarkResults(const FilePath &projectDirectory)
+{
+    QList<BenchmarkResult> results;
+    const expected_str<QByteArray> contents = resultsFile(projectDirectory).fileContents();
+    if (!contents)
+        return results;
+
+    for (const QByteArray &line : contents->split('\n')) {
+        const QJsonObject object = QJsonDocument::fromJson(line).object();
+        if (!object.isEmpty())
+            results.append(fromJson(object));
+    }
+    return results;
+}
+
+static QJsonObject loadBaselines(const FilePath &projectDirectory)
+{
+    const expected_str<QByteArray> contents = baselinesFile(projectDirectory).fileContents();
+    return contents ? QJsonDocument::fromJson(*contents).object() : QJsonObject();
+}
+
+static bool saveBaselines(const FilePath &projectDirectory, const QJsonObject &baselines)
+{
+    const FilePath file = baselinesFile(projectDirectory);
+    return file.parentDir().ensureWritableDir()
+           && file.writeFileContents(QJsonDocument(baselines).toJson()).has_value();
+}
+
+std::optional<BenchmarkResult> benchmarkBaseline(const FilePath &projectDirectory,
+                                                 const QString &key)
+{
+    const QJsonObject baselines = loadBaselines(projectDirectory);
+    if (!baselines.contains(key))
+        return {};
+    return fromJson(baselines.value(key).toObject());
+}
+
+bool pinBenchmarkBaseline(const FilePath &projectDirectory, const BenchmarkResult &result)
+{
+    QJsonObject baselines = loadBaselines(projectDirectory);
+    baselines.insert(result.key, toJson(result));
+    return saveBaselines(projectDirectory, baselines);
+}
+
+bool unpinBenchmarkBaseline(const FilePath &projectDirectory, const QString &key)
+{
+    QJsonObject baselines = loadBaselines(projectDirectory);
+    baselines.remove(key);
+    return saveBaselines(projectDirectory, baselines);
+}
+
+} // Rusty::Internal
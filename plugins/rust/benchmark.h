@@ -0,0 +1,99 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <utils/commandline.h>
+#include <utils/environment.h>
+
+#include <QDateTime>
+#include <QPromise>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+namespace Rusty::Internal {
+
+class BenchmarkSample
+{
+public:
+    qint64 wallTimeNs = 0;
+    qint64 userTimeUs = 0;
+    qint64 systemTimeUs = 0;
+    qint64 maxRssKiB = 0;
+    int exitCode = 0;     // -1 if the program was killed by a signal.
+    bool warmup = false;
+};
+
+class BenchmarkStatistics
+{
+public:
+    double mean = 0;
+    double median = 0;
+    double stddev = 0;   // Sample standard deviation.
+    double min = 0;
+    double max = 0;
+    int count = 0;
+};
+
+BenchmarkStatistics computeStatistics(QList<double> values);
+
+class BenchmarkResult
+{
+public:
+    QDateTime timestamp;
+    QString key;            // Build key of the run configuration, baselines are per key.
+    QString name;
+    QString configuration;
+    QString command;
+    int warmups = 0;
+    QList<BenchmarkSample> samples; // Without the warmups.
+
+    BenchmarkStatistics wallTime() const;     // Seconds.
+    BenchmarkStatistics userTime() const;     // Seconds.
+    BenchmarkStatistics systemTime() const;   // Seconds.
+    BenchmarkStatistics maxRss() const;       // KiB.
+};
+
+class BenchmarkOptions
+{
+public:
+    Utils::CommandLine command;
+    Utils::FilePath workingDirectory;
+    Utils::Environment environment;
+    Utils::FilePath inputFile;  // Fed to stdin of every run, /dev/null if empty.
+    int runs = 10;
+    int warmups = 3;
+};
+
+// Runs the program options.warmups + options.runs times, one after the
+// other, and reports a sample per run. The program's output is discarded.
+// Meant to run on a worker thread, the pid of the current run is published
+// in runningPid so that a cancelled benchmark does not wait for it.
+void runBenchmark(QPromise<BenchmarkSample> &promise,
+                  const BenchmarkOptions &options,
+                  const std::shared_ptr<std::atomic<qint64>> &runningPid);
+
+// Kills the run started by runBenchmark, if any.
+void killBenchmarkRun(const std::shared_ptr<std::atomic<qint64>> &runningPid);
+
+QString formatDuration(double seconds);
+QString formatMemory(qint64 kib);
+QString formatBytes(qint64 bytes);
+QString formatCount(double value);
+
+// "12.3 ms ± 0.4 ms" style summary of the wall time, followed by CPU times and memory.
+QStringList describeBenchmark(const BenchmarkResult &result);
+QString compareWithBaseline(const BenchmarkResult &result, const BenchmarkResult &baseline);
+
+// Results are appended to a file with one JSON object per line below the
+// project's .qtcreator directory, pinned baselines are kept in a second file.
+void appendBenchmarkResult(const Utils::FilePath &projectDirectory, const BenchmarkResult &result);
+QList<BenchmarkResult> loadBenchmarkResults(const Utils::FilePath &projectDirectory);
+std::optional<BenchmarkResult> benchmarkBaseline(const Utils::FilePath &projectDirectory,
+                                                 const QString &key);
+bool pinBenchmarkBaseline(const Utils::FilePath &projectDirectory, const BenchmarkResult &result);
+bool unpinBenchmarkBaseline(const Utils::FilePath &projectDirectory, const QString &key);
+
+} // Rusty::Internal
+
+#endif // BENCHMARK_H
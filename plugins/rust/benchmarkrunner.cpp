@@ -0,0 +1,185 @@
+#include "benchmarkrunner.h"
+
+#include "benchmark.h"
+#include "rustyconstants.h"
+#include "rustrunconfiguration.h"
+#include "rusttr.h"
+
+#include <extensionsystem/pluginmanager.h>
+
+#include <projectexplorer/buildconfiguration.h>
+#include <projectexplorer/project.h>
+#include <projectexplorer/target.h>
+
+#include <utils/aspects.h>
+#include <utils/async.h>
+#include <utils/futuresynchronizer.h>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+class BenchmarkRunWorker final : public RunWorker
+{
+public:
+    explicit BenchmarkRunWorker(RunControl *runControl)
+        : RunWorker(runControl)
+    {
+        setId("BenchmarkRunWorker");
+    }
+
+    ~BenchmarkRunWorker() final
+    {
+        if (m_future.isRunning()) {
+            m_future.cancel();
+            killBenchmarkRun(m_runningPid);
+        }
+    }
+
+private:
+    void start() final;
+    void stop() final;
+    void addSample(const BenchmarkSample &sample);
+    void finish();
+    int setting(const char id[]) const;
+
+    QFuture<BenchmarkSample> m_future;
+    std::shared_ptr<std::atomic<qint64>> m_runningPid = std::make_shared<std::atomic<qint64>>(0);
+    BenchmarkResult m_result;
+    BenchmarkOptions m_options;
+    int m_warmupsDone = 0;
+};
+
+int BenchmarkRunWorker::setting(const char id[]) const
+{
+    const auto data = static_cast<const IntegerAspect::Data *>(runControl()->aspect(Id(id)));
+    return data ? int(data->value) : 0;
+}
+
+void BenchmarkRunWorker::start()
+{
+    // Benchmarking "cargo run" would measure cargo's up-to-date check as
+    // well, only the executable of a finished build is accepted.
+    const CommandLine command = runControl()->commandLine();
+    const FilePath executable = freshArtifact(runControl()->target(), runControl()->buildKey());
+    if (executable.isEmpty() || command.executable() != executable) {
+        reportFailure(Tr::tr("The executable of \"%1\" is out of date or was not built by the "
+                             "active build configuration. Build the project before "
+                             "benchmarking it.").arg(runControl()->displayName()));
+        return;
+    }
+    if (!executable.isLocal()) {
+        reportFailure(Tr::tr("Benchmarks can only be run on the local machine."));
+        return;
+    }
+
+    m_options.command = command;
+    m_options.workingDirectory = runControl()->workingDirectory();
+    m_options.environment = runControl()->environment();
+    m_options.runs = qMax(1, setting(Constants::BENCHMARK_RUNS_ID));
+    m_options.warmups = setting(Constants::BENCHMARK_WARMUPS_ID);
+    if (const auto input = static_cast<const FilePathAspect::Data *>(
+            runControl()->aspect(Id(Constants::BENCHMARK_INPUT_ID)))) {
+        if (!input->value.isEmpty())
+            m_options.inputFile = m_options.workingDirectory.resolvePath(input->value);
+    }
+
+    m_result = {};
+    m_result.timestamp = QDateTime::currentDateTime();
+    m_result.key = runControl()->buildKey();
+    m_result.name = runControl()->displayName();
+    if (BuildConfiguration *bc = runControl()->target()->activeBuildConfiguration())
+        m_result.configuration = bc->displayName();
+    m_result.command = command.toUserOutput();
+    m_result.warmups = m_options.warmups;
+    m_warmupsDone = 0;
+
+    appendMessage(Tr::tr("Benchmarking %1: %n runs after %2 warmup runs.", nullptr,
+                         m_options.runs).arg(m_result.command).arg(m_options.warmups),
+                  NormalMessageFormat);
+    if (!m_options.inputFile.isEmpty()) {
+        appendMessage(Tr::tr("Reading standard input from %1.")
+                          .arg(m_options.inputFile.toUserOutput()),
+                      NormalMessageFormat);
+    }
+
+    m_future = Utils::asyncRun(runBenchmark, m_options, m_runningPid);
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(m_future);
+    Utils::onResultReady(m_future, this, [this](const BenchmarkSample &sample) {
+        addSample(sample);
+    });
+    Utils::onFinished(m_future, this, [this](const QFuture<BenchmarkSample> &) { finish(); });
+    reportStarted();
+}
+
+void BenchmarkRunWorker::stop()
+{
+    if (!m_future.isRunning()) {
+        reportStopped();
+        return;
+    }
+    // finish() reports the stop once the worker thread returned.
+    m_future.cancel();
+    killBenchmarkRun(m_runningPid);
+}
+
+void BenchmarkRunWorker::addSample(const BenchmarkSample &sample)
+{
+    QString line = sample.warmup
+        ? Tr::tr("Warmup %1/%2: %3").arg(++m_warmupsDone).arg(m_options.warmups)
+              .arg(formatDuration(sample.wallTimeNs * 1e-9))
+        : Tr::tr("Run %1/%2: %3, max RSS %4").arg(m_result.samples.size() + 1)
+              .arg(m_options.runs)
+              .arg(formatDuration(sample.wallTimeNs * 1e-9), formatMemory(sample.maxRssKiB));
+    if (sample.exitCode != 0) {
+        line += ' ' + (sample.exitCode < 0 ? Tr::tr("(killed by a signal)")
+                                           : Tr::tr("(exit code %1)").arg(sample.exitCode));
+    }
+    appendMessage(line, sample.exitCode == 0 ? StdOutFormat : StdErrFormat);
+    if (!sample.warmup && sample.exitCode == 0)
+        m_result.samples.append(sample);
+}
+
+void BenchmarkRunWorker::finish()
+{
+    if (m_future.isCanceled()) {
+        appendMessage(Tr::tr("Benchmark canceled."), ErrorMessageFormat);
+        reportStopped();
+        return;
+    }
+    try {
+        m_future.waitForFinished();
+    } catch (const std::exception &error) {
+        reportFailure(QString::fromStdString(error.what()));
+        return;
+    }
+    if (m_result.samples.size() < m_options.runs) {
+        reportFailure(Tr::tr("The program failed, no benchmark results recorded."));
+        return;
+    }
+
+    appendMessage(describeBenchmark(m_result).join('\n'), NormalMessageFormat);
+
+    const FilePath projectDirectory = runControl()->project()->projectDirectory();
+    if (const std::optional<BenchmarkResult> baseline
+        = benchmarkBaseline(projectDirectory, m_result.key)) {
+        appendMessage(compareWithBaseline(m_result, *baseline), NormalMessageFormat);
+    } else {
+        appendMessage(Tr::tr("No baseline pinned for \"%1\", pin one in Tools > Rusty > "
+                             "Benchmark Results.").arg(m_result.name),
+                      NormalMessageFormat);
+    }
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(
+        Utils::asyncRun(appendBenchmarkResult, projectDirectory, m_result));
+    reportStopped();
+}
+
+BenchmarkRunWorkerFactory::BenchmarkRunWorkerFactory()
+{
+    setProduct<BenchmarkRunWorker>();
+    addSupportedRunMode(Constants::BENCHMARK_RUN_MODE);
+    addSupportedRunConfig(Constants::C_RUSTRUNCONFIGURATION_ID);
+}
+
+} // Rusty::Internal
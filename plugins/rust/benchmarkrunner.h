@@ -0,0 +1,25 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <projectexplorer/runcontrol.h>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Runs the built executable of a Rust run configuration repeatedly
+ *
+ * Used for the benchmark run mode: the program is started a configurable
+ * number of times after some warmup runs, wall time, CPU times and peak
+ * memory of each run are measured, and the statistics are printed to the
+ * application output, stored in the project and compared against the
+ * pinned baseline of the run configuration.
+ */
+class BenchmarkRunWorkerFactory final : public ProjectExplorer::RunWorkerFactory
+{
+public:
+    BenchmarkRunWorkerFactory();
+};
+
+} // Rusty::Internal
+
+#endif // BENCHMARKRUNNER_H
@@ -0,0 +1,217 @@
+#include "benchmarkview.h"
+
+#include "benchmark.h"
+#include "resultutils.h"
+#include "rusttr.h"
+
+#include <projectexplorer/project.h>
+
+#include <utils/layoutbuilder.h>
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QTreeView>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const int ResultIndexRole = Qt::UserRole + 1;
+
+enum ResultColumn {
+    NameColumn,
+    DateColumn,
+    ConfigurationColumn,
+    RunsColumn,
+    MeanColumn,
+    StddevColumn,
+    MedianColumn,
+    MinColumn,
+    MaxColumn,
+    UserColumn,
+    SystemColumn,
+    RssColumn,
+    BaselineColumn
+};
+
+static QStandardItem *durationItem(double seconds)
+{
+    return sortedItem(formatDuration(seconds), seconds);
+}
+
+class BenchmarkResultsView : public QWidget
+{
+public:
+    explicit BenchmarkResultsView(const FilePath &projectDirectory)
+        : m_projectDirectory(projectDirectory)
+    {
+        setWindowTitle(Tr::tr("Benchmark Results"));
+        resize(1100, 600);
+
+        m_proxy.setSourceModel(&m_model);
+        m_proxy.setSortRole(Qt::UserRole);
+        m_view = new QTreeView;
+        m_view->setModel(&m_proxy);
+        m_view->setRootIsDecorated(false);
+        m_view->setSortingEnabled(true);
+        m_view->setUniformRowHeights(true);
+        m_view->setSelectionMode(QAbstractItemView::SingleSelection);
+        m_view->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+        m_summary = new QLabel;
+        m_pin = new QPushButton(Tr::tr("Pin as Baseline"));
+        m_pin->setToolTip(Tr::tr("Later benchmarks of the same run configuration are "
+                                 "compared against the selected result."));
+        m_unpin = new QPushButton(Tr::tr("Unpin Baseline"));
+
+        using namespace Layouting;
+        Column {
+            m_summary,
+            m_view,
+            Row { st, m_pin, m_unpin }
+        }.attachTo(this);
+
+        connect(m_pin, &QPushButton::clicked, this, &BenchmarkResultsView::pinSelected);
+        connect(m_unpin, &QPushButton::clicked, this, &BenchmarkResultsView::unpinSelected);
+        connect(m_view->selectionModel(), &QItemSelectionModel::selectionChanged,
+                this, &BenchmarkResultsView::updateButtons);
+
+        reload();
+        m_view->sortByColumn(DateColumn, Qt::DescendingOrder);
+    }
+
+private:
+    void reload()
+    {
+        m_results = loadBenchmarkResults(m_projectDirectory);
+        m_baselines.clear();
+
+        m_model.clear();
+        m_model.setHorizontalHeaderLabels({Tr::tr("Run Configuration"), Tr::tr("Date"),
+                                           Tr::tr("Build Configuration"), Tr::tr("Runs"),
+                                           Tr::tr("Mean"), Tr::tr("Std. Dev."), Tr::tr("Median"),
+                                           Tr::tr("Min"), Tr::tr("Max"), Tr::tr("User"),
+                                           Tr::tr("System"), Tr::tr("Max RSS"),
+                                           Tr::tr("vs. Baseline")});
+        for (int i = 0; i < m_results.size(); ++i) {
+            const BenchmarkResult &result = m_results.at(i);
+            if (!m_baselines.contains(result.key))
+                m_baselines.insert(result.key, benchmarkBaseline(m_projectDirectory, result.key));
+            const std::optional<BenchmarkResult> &baseline = m_baselines.value(result.key);
+            const bool isBaseline = baseline && baseline->timestamp == result.timestamp;
+
+            const BenchmarkStatistics wall = result.wallTime();
+            QList<QStandardItem *> row{
+                textItem(result.name),
+                sortedItem(result.timestamp.toString(Qt::ISODate), result.timestamp),
+                textItem(result.configuration),
+                sortedItem(QString::number(wall.count), wall.count),
+                durationItem(wall.mean),
+                durationItem(wall.stddev),
+                durationItem(wall.median),
+                durationItem(wall.min),
+                durationItem(wall.max),
+                durationItem(result.userTime().mean),
+                durationItem(result.systemTime().mean),
+                sortedItem(formatMemory(qRound64(result.maxRss().mean)), result.maxRss().mean)};
+
+            const BenchmarkStatistics base = baseline ? baseline->wallTime()
+                                                      : BenchmarkStatistics();
+            if (isBaseline) {
+                row.append(sortedItem(Tr::tr("Baseline"), 0.0));
+            } else if (base.mean > 0) {
+                const double change = 100 * (wall.mean - base.mean) / base.mean;
+                QStandardItem *changeItem = sortedItem(QString("%1%2 %")
+                                                           .arg(change > 0 ? "+" : "")
+                                                           .arg(change, 0, 'f', 1),
+                                                       change);
+                changeItem->setToolTip(compareWithBaseline(result, *baseline));
+                row.append(changeItem);
+            } else {
+                row.append(sortedItem({}, 0.0));
+            }
+
+            row.first()->setData(i, ResultIndexRole);
+            row.first()->setToolTip(result.command);
+            if (isBaseline) {
+                QFont font = row.first()->font();
+                font.setBold(true);
+                for (QStandardItem *rowItem : std::as_const(row))
+                    rowItem->setFont(font);
+            }
+            m_model.appendRow(row);
+        }
+
+        m_summary->setText(m_results.isEmpty()
+            ? Tr::tr("No benchmarks recorded yet. Run a Rust run configuration with "
+                     "Tools > Rusty > Benchmark Startup Project.")
+            : Tr::tr("%n benchmarks recorded. Pinned baselines are shown in bold.", nullptr,
+                     m_results.size()));
+        updateButtons();
+    }
+
+    const BenchmarkResult *selectedResult() const
+    {
+        const QModelIndexList rows = m_view->selectionModel()->selectedRows(NameColumn);
+        if (rows.isEmpty())
+            return nullptr;
+        const int index = rows.first().data(ResultIndexRole).toInt();
+        return index >= 0 && index < m_results.size() ? &m_results.at(index) : nullptr;
+    }
+
+    void updateButtons()
+    {
+        const BenchmarkResult *result = selectedResult();
+        m_pin->setEnabled(result);
+        m_unpin->setEnabled(result && m_baselines.value(result->key).has_value());
+    }
+
+    void pinSelected()
+    {
+        if (const BenchmarkResult *result = selectedResult()) {
+            if (!pinBenchmarkBaseline(m_projectDirectory, *result))
+                showWriteError();
+            reload();
+        }
+    }
+
+    void unpinSelected()
+    {
+        if (const BenchmarkResult *result = selectedResult()) {
+            if (!unpinBenchmarkBaseline(m_projectDirectory, result->key))
+                showWriteError();
+            reload();
+        }
+    }
+
+    void showWriteError()
+    {
+        QMessageBox::warning(this, Tr::tr("Benchmark Results"),
+                             Tr::tr("Cannot write the baselines below %1.")
+                                 .arg(m_projectDirectory.toUserOutput()));
+    }
+
+    const FilePath m_projectDirectory;
+    QList<BenchmarkResult> m_results;
+    QHash<QString, std::optional<BenchmarkResult>> m_baselines;
+    QStandardItemModel m_model;
+    QSortFilterProxyModel m_proxy;
+    QTreeView *m_view = nullptr;
+    QLabel *m_summary = nullptr;
+    QPushButton *m_pin = nullptr;
+    QPushButton *m_unpin = nullptr;
+};
+
+void showBenchmarkResults(ProjectExplorer::Project *project)
+{
+    if (!project)
+        return;
+    auto view = new BenchmarkResultsView(project->projectDirectory());
+    showResultWindow(view);
+}
+
+} // Rusty::Internal
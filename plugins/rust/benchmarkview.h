@@ -0,0 +1,12 @@
+#ifndef BENCHMARKVIEW_H
+#define BENCHMARKVIEW_H
+
+namespace ProjectExplorer { class Project; }
+
+namespace Rusty::Internal {
+
+void showBenchmarkResults(ProjectExplorer::Project *project);
+
+} // Rusty::Internal
+
+#endif // BENCHMARKVIEW_H
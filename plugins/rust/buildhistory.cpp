@@ -0,0 +1,151 @@
+#include "buildhistory.h"
+
+#include "rustutils.h"
+
+#include <extensionsystem/pluginmanager.h>
+
+#include <utils/async.h>
+#include <utils/futuresynchronizer.h>
+#include <utils/process.h>
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const double regressionFactor = 1.5;
+const qint64 regressionMinimumMs = 1000;
+const int regressionWindow = 5;
+
+static FilePath historyFile(const FilePath &projectDirectory)
+{
+    return rustyDataDirectory(projectDirectory).pathAppended("build-history.jsonl");
+}
+
+static QString git(const FilePath &workingDirectory, const QStringList &arguments)
+{
+    Process process;
+    process.setWorkingDirectory(workingDirectory);
+    process.setCommand({FilePath("git").searchInPath(), arguments});
+    process.setTimeoutS(5);
+    process.runBlocking();
+    if (process.result() != ProcessResult::FinishedWithSuccess)
+        return {};
+    return process.cleanedStdOut().trimmed();
+}
+
+static void appendEntry(const FilePath &projectDirectory, BuildHistoryEntry entry)
+{
+    entry.revision = git(projectDirectory, {"rev-parse", "HEAD"});
+    if (!entry.revision.isEmpty())
+        entry.subject = git(projectDirectory, {"log", "-1", "--format=%s"});
+
+    QJsonObject crates;
+    for (auto it = entry.crateDurations.cbegin(), end = entry.crateDurations.cend(); it != end; ++it)
+        crates.insert(it.key(), it.value());
+    const QJsonObject object{{"timestamp", entry.timestamp.toString(Qt::ISODate)},
+                             {"revision", entry.revision},
+                             {"subject", entry.subject},
+                             {"configuration", entry.configuration},
+                             {"wall", entry.wallTimeMs},
+                             {"link", entry.linkTimeMs},
+                             {"rebuilt", entry.rebuiltUnits},
+                             {"crates", crates}};
+
+    const FilePath file = historyFile(projectDirectory);
+    if (!file.parentDir().ensureWritableDir())
+        return;
+    QFile out(file.toFSPathString());
+    if (out.open(QIODevice::WriteOnly | QIODevice::Append))
+        out.write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void appendBuildHistory(const FilePath &projectDirectory, const BuildHistoryEntry &entry)
+{
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(
+        Utils::asyncRun(appendEntry, projectDirectory, entry));
+}
+
+QList<BuildHistoryEntry> loadBuildHistory(const FilePath &projectDirectory)
+{
+    QList<BuildHistoryEntry> history;
+    const expected_str<QByteArray> contents = historyFile(projectDirectory).fileContents();
+    if (!contents)
+        return history;
+
+    for (const QByteArray &line : contents->split('\n')) {
+        const QJsonObject object = QJsonDocument::fromJson(line).object();
+        if (object.isEmpty())
+            continue;
+        BuildHistoryEntry entry;
+        entry.timestamp = QDateTime::fromString(object.value("timestamp").toString(), Qt::ISODate);
+        entry.revision = object.value("revision").toString();
+        entry.subject = object.value("subject").toString();
+        entry.configuration = object.value("configuration").toString();
+        entry.wallTimeMs = object.value("wall").toInteger();
+        entry.linkTimeMs = object.value("link").toInteger();
+        entry.rebuiltUnits = object.value("rebuilt").toInt();
+        const QJsonObject crates = object.value("crates").toObject();
+        for (auto it = crates.constBegin(), end = crates.constEnd(); it != end; ++it)
+            entry.crateDurations.insert(it.key(), it.value().toInteger());
+        history.append(entry);
+    }
+    return history;
+}
+
+static qint64 median(QList<qint64> values)
+{
+    std::sort(values.begin(), values.end());
+    return values.at(values.size() / 2);
+}
+
+QList<CompileTimeRegression> findCompileTimeRegressions(const QList<BuildHistoryEntry> &history)
+{
+    QList<CompileTimeRegression> result;
+    // Durations of each crate at earlier revisions, newest last. A release
+    // build compiles slower than a debug build, only builds of the same
+    // configuration are compared.
+    using ConfigurationCrate = std::pair<QString, QString>;
+    QHash<ConfigurationCrate, QList<qint64>> earlier;
+    QString currentRevision;
+    QHash<ConfigurationCrate, qint64> atRevision;
+    QString currentSubject;
+
+    const auto finishRevision = [&] {
+        for (auto it = atRevision.cbegin(), end = atRevision.cend(); it != end; ++it) {
+            QList<qint64> &previous = earlier[it.key()];
+            if (!previous.isEmpty()) {
+                const qint64 before = median(previous.mid(qMax(0, previous.size()
+                                                                     - regressionWindow)));
+                if (it.value() > before * regressionFactor
+                    && it.value() - before > regressionMinimumMs) {
+                    result.append({it.key().second, it.key().first, currentRevision,
+                                   currentSubject, before, it.value()});
+                }
+            }
+            previous.append(it.value());
+        }
+        atRevision.clear();
+    };
+
+    for (const BuildHistoryEntry &entry : history) {
+        if (entry.revision != currentRevision) {
+            finishRevision();
+            currentRevision = entry.revision;
+            currentSubject = entry.subject;
+        }
+        // Several builds at one revision, the slowest one counts.
+        for (auto it = entry.crateDurations.cbegin(), end = entry.crateDurations.cend();
+             it != end; ++it) {
+            qint64 &duration = atRevision[{entry.configuration, it.key()}];
+            duration = qMax(duration, it.value());
+        }
+    }
+    finishRevision();
+    return result;
+}
+
+} // Rusty::Internal
@@ -0,0 +1,48 @@
+#ifndef BUILDHISTORY_H
+#define BUILDHISTORY_H
+
+#include <utils/filepath.h>
+
+#include <QDateTime>
+#include <QHash>
+
+namespace Rusty::Internal {
+
+class BuildHistoryEntry
+{
+public:
+    QDateTime timestamp;
+    QString revision;
+    QString subject;
+    QString configuration;
+    qint64 wallTimeMs = 0;
+    qint64 linkTimeMs = 0;
+    int rebuiltUnits = 0;
+    QHash<QString, qint64> crateDurations; // Milliseconds, crates compiled in this build only.
+};
+
+class CompileTimeRegression
+{
+public:
+    QString crate;
+    QString configuration;
+    QString revision;
+    QString subject;
+    qint64 beforeMs = 0;
+    qint64 afterMs = 0;
+};
+
+// The history is an append-only file with one JSON object per line, below
+// the project's .qtcreator directory. Appending happens on a worker thread
+// because it also asks git for the current revision.
+void appendBuildHistory(const Utils::FilePath &projectDirectory, const BuildHistoryEntry &entry);
+QList<BuildHistoryEntry> loadBuildHistory(const Utils::FilePath &projectDirectory);
+
+// Crates whose compile time at a revision exceeds the median of their earlier
+// builds with the same configuration by a factor of 1.5 and by more than a
+// second.
+QList<CompileTimeRegression> findCompileTimeRegressions(const QList<BuildHistoryEntry> &history);
+
+} // Rusty::Internal
+
+#endif // BUILDHISTORY_H
@@ -0,0 +1,197 @@
+#include "buildhistoryview.h"
+
+#include "buildhistory.h"
+#include "resultutils.h"
+#include "rusttr.h"
+
+#include <projectexplorer/project.h>
+
+#include <utils/layoutbuilder.h>
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QToolTip>
+#include <QTreeView>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+static double seconds(qint64 ms)
+{
+    return qRound(ms / 10.0) / 100.0;
+}
+
+static QString shortRevision(const QString &revision)
+{
+    return revision.isEmpty() ? Tr::tr("(no git)") : revision.left(8);
+}
+
+class CompileTimeChart : public QWidget
+{
+public:
+    explicit CompileTimeChart(const QList<BuildHistoryEntry> &history)
+        : m_history(history)
+    {
+        setMinimumHeight(200);
+        setMouseTracking(true);
+    }
+
+private:
+    QRectF plotArea() const { return QRectF(rect()).adjusted(8, 8, -8, -24); }
+
+    QPointF pointFor(int index) const
+    {
+        const QRectF area = plotArea();
+        const double x = m_history.size() > 1
+                             ? area.left() + area.width() * index / (m_history.size() - 1)
+                             : area.center().x();
+        return {x, area.bottom() - area.height() * m_history.at(index).wallTimeMs / m_maxWallTime};
+    }
+
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), palette().base());
+        if (m_history.isEmpty())
+            return;
+
+        m_maxWallTime = 1;
+        for (const BuildHistoryEntry &entry : m_history)
+            m_maxWallTime = qMax(m_maxWallTime, entry.wallTimeMs);
+
+        // Commit boundaries, labelled with the abbreviated revision.
+        const QRectF area = plotArea();
+        painter.setPen(QPen(palette().color(QPalette::Mid), 1, Qt::DotLine));
+        QString revision;
+        double lastLabelRight = -1;
+        for (int i = 0; i < m_history.size(); ++i) {
+            if (i > 0 && m_history.at(i).revision == revision)
+                continue;
+            revision = m_history.at(i).revision;
+            const double x = pointFor(i).x();
+            painter.drawLine(QPointF(x, area.top()), QPointF(x, area.bottom()));
+            const QString label = shortRevision(revision);
+            const double width = painter.fontMetrics().horizontalAdvance(label);
+            if (x > lastLabelRight) {
+                painter.drawText(QPointF(x, rect().bottom() - 6), label);
+                lastLabelRight = x + width + 4;
+            }
+        }
+
+        // Full rebuilds and incremental builds are not comparable, only the
+        // builds that actually compiled something are connected.
+        painter.setPen(QPen(palette().color(QPalette::Highlight), 1.5));
+        painter.setBrush(palette().color(QPalette::Highlight));
+        QPolygonF line;
+        for (int i = 0; i < m_history.size(); ++i) {
+            const QPointF point = pointFor(i);
+            painter.drawEllipse(point, 2.5, 2.5);
+            if (m_history.at(i).rebuiltUnits > 0)
+                line << point;
+        }
+        painter.setBrush(Qt::NoBrush);
+        painter.drawPolyline(line);
+    }
+
+    void mouseMoveEvent(QMouseEvent *event) override
+    {
+        if (m_history.isEmpty())
+            return;
+        int closest = 0;
+        for (int i = 1; i < m_history.size(); ++i) {
+            if (qAbs(pointFor(i).x() - event->position().x())
+                < qAbs(pointFor(closest).x() - event->position().x())) {
+                closest = i;
+            }
+        }
+        const BuildHistoryEntry &entry = m_history.at(closest);
+        QToolTip::showText(event->globalPosition().toPoint(),
+                           Tr::tr("%1 %2\n%3, %4\n%5 s (link %6 s), %n units rebuilt", nullptr,
+                                  entry.rebuiltUnits)
+                               .arg(shortRevision(entry.revision), entry.subject,
+                                    entry.timestamp.toString(Qt::ISODate), entry.configuration)
+                               .arg(seconds(entry.wallTimeMs))
+                               .arg(seconds(entry.linkTimeMs)),
+                           this);
+    }
+
+    const QList<BuildHistoryEntry> m_history;
+    qint64 m_maxWallTime = 1;
+};
+
+class BuildHistoryView : public QWidget
+{
+public:
+    explicit BuildHistoryView(const FilePath &projectDirectory)
+    {
+        setWindowTitle(Tr::tr("Compile Time History"));
+        resize(900, 650);
+
+        const QList<BuildHistoryEntry> history = loadBuildHistory(projectDirectory);
+        const QList<CompileTimeRegression> regressions = findCompileTimeRegressions(history);
+
+        m_model.setHorizontalHeaderLabels({Tr::tr("Crate"), Tr::tr("Configuration"),
+                                           Tr::tr("Revision"), Tr::tr("Subject"),
+                                           Tr::tr("Before (s)"), Tr::tr("After (s)"),
+                                           Tr::tr("Factor")});
+        for (const CompileTimeRegression &regression : regressions) {
+            const auto number = [](double value) {
+                auto item = new QStandardItem;
+                item->setData(value, Qt::DisplayRole);
+                return item;
+            };
+            QList<QStandardItem *> row{
+                new QStandardItem(regression.crate),
+                new QStandardItem(regression.configuration),
+                new QStandardItem(shortRevision(regression.revision)),
+                new QStandardItem(regression.subject),
+                number(seconds(regression.beforeMs)),
+                number(seconds(regression.afterMs)),
+                number(qRound(100.0 * regression.afterMs / qMax<qint64>(1, regression.beforeMs))
+                       / 100.0)};
+            for (QStandardItem *item : row)
+                item->setEditable(false);
+            m_model.appendRow(row);
+        }
+        m_proxy.setSourceModel(&m_model);
+
+        auto view = new QTreeView;
+        view->setModel(&m_proxy);
+        view->setRootIsDecorated(false);
+        view->setSortingEnabled(true);
+        view->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+        view->sortByColumn(6, Qt::DescendingOrder);
+
+        const QString summary = history.isEmpty()
+            ? Tr::tr("No builds recorded yet.")
+            : Tr::tr("%n builds recorded, %1 crates with compile time jumps.", nullptr,
+                     history.size()).arg(regressions.size());
+
+        using namespace Layouting;
+        Column {
+            new QLabel(summary),
+            new CompileTimeChart(history),
+            new QLabel(Tr::tr("Crates whose compile time jumped:")),
+            view
+        }.attachTo(this);
+    }
+
+private:
+    QStandardItemModel m_model;
+    QSortFilterProxyModel m_proxy;
+};
+
+void showBuildHistory(ProjectExplorer::Project *project)
+{
+    if (!project)
+        return;
+    auto view = new BuildHistoryView(project->projectDirectory());
+    showResultWindow(view);
+}
+
+} // Rusty::Internal
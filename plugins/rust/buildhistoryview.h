@@ -0,0 +1,12 @@
+#ifndef BUILDHISTORYVIEW_H
+#define BUILDHISTORYVIEW_H
+
+namespace ProjectExplorer { class Project; }
+
+namespace Rusty::Internal {
+
+void showBuildHistory(ProjectExplorer::Project *project);
+
+} // Rusty::Internal
+
+#endif // BUILDHISTORYVIEW_H
@@ -0,0 +1,244 @@
+#include "buildtimingsview.h"
+
+#include "cargotimings.h"
+#include "resultutils.h"
+#include "rusttr.h"
+
+#include <projectexplorer/project.h>
+
+#include <utils/layoutbuilder.h>
+
+#include <QComboBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPainter>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QTreeView>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const int maxLoadedReports = 50;
+
+static double roundedSeconds(double seconds)
+{
+    return qRound(seconds * 100) / 100.0;
+}
+
+static QString unitKey(const CargoUnitTiming &unit)
+{
+    return unit.name + unit.target;
+}
+
+class ConcurrencyChart : public QWidget
+{
+public:
+    ConcurrencyChart()
+    {
+        setMinimumHeight(120);
+        setToolTip(Tr::tr("Units compiling in parallel over time. The dashed line marks "
+                          "the number of jobs cargo was allowed to run."));
+    }
+
+    void setReports(const CargoTimingReport *current, const CargoTimingReport *baseline)
+    {
+        m_current = current;
+        m_baseline = baseline;
+        update();
+    }
+
+private:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), palette().base());
+        if (!m_current)
+            return;
+
+        const double totalTime = qMax(m_current->totalTime,
+                                      m_baseline ? m_baseline->totalTime : 0.0);
+        int maxActive = qMax(1, m_current->jobs);
+        for (const CargoConcurrencySample &sample : m_current->concurrency)
+            maxActive = qMax(maxActive, sample.active);
+        if (totalTime <= 0)
+            return;
+
+        const QRectF area = QRectF(rect()).adjusted(4, 4, -4, -4);
+        const auto toPoint = [&](double time, int active) {
+            return QPointF(area.left() + area.width() * time / totalTime,
+                           area.bottom() - area.height() * active / maxActive);
+        };
+        const auto drawSeries = [&](const CargoTimingReport *report, const QColor &color) {
+            QPolygonF polygon;
+            for (const CargoConcurrencySample &sample : report->concurrency) {
+                // Step function, the count holds until the next sample.
+                if (!polygon.isEmpty())
+                    polygon << QPointF(toPoint(sample.time, 0).x(), polygon.last().y());
+                polygon << toPoint(sample.time, sample.active);
+            }
+            painter.setPen(QPen(color, 1.5));
+            painter.drawPolyline(polygon);
+        };
+
+        painter.setPen(QPen(palette().color(QPalette::Mid), 1, Qt::DashLine));
+        painter.drawLine(toPoint(0, m_current->jobs), toPoint(totalTime, m_current->jobs));
+        if (m_baseline)
+            drawSeries(m_baseline, palette().color(QPalette::Mid));
+        drawSeries(m_current, palette().color(QPalette::Highlight));
+    }
+
+    const CargoTimingReport *m_current = nullptr;
+    const CargoTimingReport *m_baseline = nullptr;
+};
+
+class BuildTimingsView : public QWidget
+{
+public:
+    explicit BuildTimingsView(const FilePath &projectDirectory)
+    {
+        setWindowTitle(Tr::tr("Build Timings"));
+        resize(900, 650);
+
+        const FilePaths reports = storedTimingReports(projectDirectory).mid(0, maxLoadedReports);
+        for (const FilePath &file : reports) {
+            QString errorMessage;
+            const CargoTimingReport report = CargoTimingReport::load(file, &errorMessage);
+            if (errorMessage.isEmpty())
+                m_reports.append(report);
+        }
+
+        m_current = new QComboBox;
+        m_baseline = new QComboBox;
+        m_baseline->addItem(Tr::tr("None"));
+        for (const CargoTimingReport &report : std::as_const(m_reports)) {
+            const QString name = QString("%1 (%2, %3 s)")
+                                     .arg(report.timestamp.toString(Qt::ISODate),
+                                          report.configuration)
+                                     .arg(roundedSeconds(report.totalTime));
+            m_current->addItem(name);
+            m_baseline->addItem(name);
+        }
+
+        m_summary = new QLabel;
+        m_summary->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        m_chart = new ConcurrencyChart;
+
+        m_proxy.setSourceModel(&m_model);
+        m_proxy.setSortRole(Qt::DisplayRole);
+        m_view = new QTreeView;
+        m_view->setModel(&m_proxy);
+        m_view->setRootIsDecorated(false);
+        m_view->setSortingEnabled(true);
+        m_view->setUniformRowHeights(true);
+        m_view->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+        using namespace Layouting;
+        Column {
+            Form {
+                Tr::tr("Build:"), m_current, br,
+                Tr::tr("Compare with:"), m_baseline, br,
+            },
+            m_summary,
+            m_chart,
+            m_view
+        }.attachTo(this);
+
+        connect(m_current, &QComboBox::currentIndexChanged, this, &BuildTimingsView::updateView);
+        connect(m_baseline, &QComboBox::currentIndexChanged, this, &BuildTimingsView::updateView);
+        if (m_reports.size() > 1)
+            m_baseline->setCurrentIndex(2);
+        updateView();
+    }
+
+private:
+    void updateView()
+    {
+        m_model.clear();
+        const CargoTimingReport *current = m_reports.isEmpty()
+                                               ? nullptr : &m_reports.at(m_current->currentIndex());
+        const int baselineIndex = m_baseline->currentIndex() - 1;
+        const CargoTimingReport *baseline = baselineIndex >= 0 ? &m_reports.at(baselineIndex)
+                                                               : nullptr;
+        m_chart->setReports(current, baseline);
+        if (!current) {
+            m_summary->setText(Tr::tr("No build timings recorded yet. Enable \"Collect build "
+                                      "timings\" in the Cargo build step and build the project."));
+            return;
+        }
+
+        QStringList headers{Tr::tr("Crate"), Tr::tr("Version"), Tr::tr("Target"),
+                            Tr::tr("Start (s)"), Tr::tr("Total (s)"), Tr::tr("Frontend (s)"),
+                            Tr::tr("Codegen (s)"), Tr::tr("Critical Path")};
+        QHash<QString, const CargoUnitTiming *> baselineUnits;
+        if (baseline) {
+            headers << Tr::tr("Baseline (s)") << Tr::tr("Delta (s)");
+            for (const CargoUnitTiming &unit : baseline->units)
+                baselineUnits.insert(unitKey(unit), &unit);
+        }
+        m_model.setHorizontalHeaderLabels(headers);
+
+        for (const CargoUnitTiming &unit : current->units) {
+            const auto number = [](double value) {
+                auto item = new QStandardItem;
+                item->setData(roundedSeconds(value), Qt::DisplayRole);
+                return item;
+            };
+            QList<QStandardItem *> row{new QStandardItem(unit.name),
+                                       new QStandardItem(unit.version),
+                                       new QStandardItem(unit.target.trimmed()),
+                                       number(unit.start),
+                                       number(unit.duration),
+                                       number(unit.frontend()),
+                                       number(unit.codegen()),
+                                       new QStandardItem(unit.onCriticalPath ? Tr::tr("yes")
+                                                                             : QString())};
+            if (baseline) {
+                if (const CargoUnitTiming *other = baselineUnits.value(unitKey(unit))) {
+                    row << number(other->duration) << number(unit.duration - other->duration);
+                } else {
+                    row << new QStandardItem << new QStandardItem;
+                }
+            }
+            for (QStandardItem *item : row)
+                item->setEditable(false);
+            m_model.appendRow(row);
+        }
+        m_view->sortByColumn(4, Qt::DescendingOrder);
+
+        QString summary = Tr::tr("Total: %1 s, critical path: %2 s, %3 units, "
+                                 "concurrency utilization: %4 % of %5 jobs.")
+                              .arg(roundedSeconds(current->totalTime))
+                              .arg(roundedSeconds(current->criticalPathTime()))
+                              .arg(current->units.size())
+                              .arg(qRound(current->utilization() * 100))
+                              .arg(current->jobs);
+        if (baseline) {
+            summary += '\n' + Tr::tr("Baseline: %1 s, critical path: %2 s, %3 units.")
+                                  .arg(roundedSeconds(baseline->totalTime))
+                                  .arg(roundedSeconds(baseline->criticalPathTime()))
+                                  .arg(baseline->units.size());
+        }
+        m_summary->setText(summary);
+    }
+
+    QList<CargoTimingReport> m_reports;
+    QComboBox *m_current = nullptr;
+    QComboBox *m_baseline = nullptr;
+    QLabel *m_summary = nullptr;
+    ConcurrencyChart *m_chart = nullptr;
+    QTreeView *m_view = nullptr;
+    QStandardItemModel m_model;
+    QSortFilterProxyModel m_proxy;
+};
+
+void showBuildTimings(ProjectExplorer::Project *project)
+{
+    if (!project)
+        return;
+    auto view = new BuildTimingsView(project->projectDirectory());
+    showResultWindow(view);
+}
+
+} // Rusty::Internal
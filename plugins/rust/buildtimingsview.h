@@ -0,0 +1,12 @@
+#ifndef BUILDTIMINGSVIEW_H
+#define BUILDTIMINGSVIEW_H
+
+namespace ProjectExplorer { class Project; }
+
+namespace Rusty::Internal {
+
+void showBuildTimings(ProjectExplorer::Project *project);
+
+} // Rusty::Internal
+
+#endif // BUILDTIMINGSVIEW_H
@@ -0,0 +1,182 @@
+#include "cachegrindparser.h"
+
+#include "resultutils.h"
+#include "rustdemangle.h"
+#include "rusttr.h"
+
+#include <QFile>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+bool CacheProfile::hasCacheSimulation() const
+{
+    return events.contains("D1mr");
+}
+
+qint64 CacheProfile::count(const EventCounts &counts, const QString &event) const
+{
+    return counts.value(events.indexOf(event));
+}
+
+qint64 CacheProfile::instructions(const EventCounts &counts) const
+{
+    return count(counts, "Ir");
+}
+
+qint64 CacheProfile::l1Misses(const EventCounts &counts) const
+{
+    return count(counts, "I1mr") + count(counts, "D1mr") + count(counts, "D1mw");
+}
+
+qint64 CacheProfile::llMisses(const EventCounts &counts) const
+{
+    return count(counts, "ILmr") + count(counts, "DLmr") + count(counts, "DLmw");
+}
+
+CachegrindParser::CachegrindParser(const FilePath &projectDirectory)
+    : m_projectDirectory(projectDirectory)
+{}
+
+int CachegrindParser::currentFunction()
+{
+    if (m_functionIndex >= 0)
+        return m_functionIndex;
+    const QPair<FilePath, QString> key{m_functionFile, m_function};
+    m_functionIndex = m_functionIndexes.value(key, -1);
+    if (m_functionIndex < 0) {
+        CacheFunction function;
+        function.name = m_function;
+        function.file = m_functionFile;
+        function.counts.fill(0, m_profile.events.size());
+        m_functionIndex = m_profile.functions.size();
+        m_profile.functions.append(function);
+        m_functionLineWeights.append({});
+        m_functionIndexes.insert(key, m_functionIndex);
+    }
+    return m_functionIndex;
+}
+
+bool CachegrindParser::addLine(const QByteArray &rawLine)
+{
+    const QByteArray line = rawLine.trimmed();
+    if (line.isEmpty() || line.startsWith('#'))
+        return true;
+
+    if (line.at(0) >= '0' && line.at(0) <= '9') {
+        // "12 1500 0 0 400 25 3 200 0 0"
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        bool ok = false;
+        const int lineNumber = fields.at(0).toInt(&ok);
+        if (!ok || m_profile.events.isEmpty())
+            return false;
+        const int function = currentFunction();
+        EventCounts &functionCounts = m_profile.functions[function].counts;
+        EventCounts *lineCounts = nullptr;
+        if (!m_file.isEmpty()) {
+            lineCounts = &m_profile.lines[m_file][lineNumber];
+            if (lineCounts->isEmpty())
+                lineCounts->fill(0, m_profile.events.size());
+        }
+        qint64 weight = 0;
+        const int events = qMin(int(fields.size()) - 1, int(m_profile.events.size()));
+        for (int i = 0; i < events; ++i) {
+            const qint64 value = fields.at(i + 1).toLongLong(&ok);
+            if (!ok)
+                return false;
+            functionCounts[i] += value;
+            m_profile.totals[i] += value;
+            if (lineCounts)
+                (*lineCounts)[i] += value;
+            if (i == m_weightEvents[0] || i == m_weightEvents[1] || i == m_weightEvents[2])
+                weight += value;
+        }
+        // Only lines of the function's own file can be opened for it.
+        if (m_file == m_functionFile)
+            m_functionLineWeights[function][lineNumber] += weight;
+        return true;
+    }
+
+    const qsizetype separator = line.indexOf(line.startsWith("f") ? '=' : ':');
+    if (separator < 0)
+        return true;
+    const QByteArray key = line.left(separator);
+    const QString value = QString::fromUtf8(line.mid(separator + 1)).trimmed();
+    if (key == "fl" || key == "fi" || key == "fe") {
+        m_file = value == "???" ? FilePath() : m_projectDirectory.resolvePath(value);
+        if (key == "fl") {
+            m_functionFile = m_file;
+            m_functionIndex = -1;
+        }
+    } else if (key == "fn") {
+        m_function = mayContainRustSymbol(value) ? demangleRustSymbols(value) : value;
+        m_functionIndex = -1;
+    } else if (key == "events") {
+        m_profile.events = value.split(' ', Qt::SkipEmptyParts);
+        m_profile.totals.fill(0, m_profile.events.size());
+        // Without the cache simulation, the hottest line is the one that
+        // executed most instructions.
+        const QStringList weightEvents = m_profile.hasCacheSimulation()
+                                             ? QStringList{"I1mr", "D1mr", "D1mw"}
+                                             : QStringList{"Ir"};
+        for (int i = 0; i < weightEvents.size(); ++i)
+            m_weightEvents[i] = int(m_profile.events.indexOf(weightEvents.at(i)));
+    } else if (key == "cmd") {
+        m_profile.command = value;
+    }
+    // "desc:", "summary:" and alike carry nothing the views need.
+    return true;
+}
+
+CacheProfile CachegrindParser::takeProfile()
+{
+    for (int i = 0; i < m_profile.functions.size(); ++i) {
+        const QHash<int, qint64> &weights = m_functionLineWeights.at(i);
+        qint64 hottest = -1;
+        for (auto it = weights.cbegin(), end = weights.cend(); it != end; ++it) {
+            if (it.value() > hottest) {
+                hottest = it.value();
+                m_profile.functions[i].line = it.key();
+            }
+        }
+    }
+    return std::move(m_profile);
+}
+
+void loadCachegrindProfile(QPromise<CacheProfile> &promise, const FilePath &file,
+                           const FilePath &projectDirectory)
+{
+    QFile input(file.toFSPathString());
+    if (!input.open(QIODevice::ReadOnly)) {
+        reportWorkerFailure(promise, Tr::tr("Cannot open %1.").arg(file.toUserOutput()));
+        return;
+    }
+
+    // A long run writes a count line per executed source line and function,
+    // the file is read line by line with the progress reported on the way.
+    promise.setProgressRange(0, 1000);
+    const qint64 size = qMax<qint64>(1, input.size());
+    CachegrindParser parser(projectDirectory);
+    for (int lineNumber = 1; !input.atEnd(); ++lineNumber) {
+        if (!parser.addLine(input.readLine())) {
+            reportWorkerFailure(promise, Tr::tr("%1:%2 is not valid cachegrind output.")
+                                             .arg(file.toUserOutput()).arg(lineNumber));
+            return;
+        }
+        if (lineNumber % 10000 == 0) {
+            if (promise.isCanceled())
+                return;
+            promise.setProgressValue(int(1000 * input.pos() / size));
+        }
+    }
+
+    CacheProfile profile = parser.takeProfile();
+    if (profile.events.isEmpty() || profile.functions.isEmpty()) {
+        reportWorkerFailure(promise, Tr::tr("%1 contains no counts.").arg(file.toUserOutput()));
+        return;
+    }
+    promise.addResult(std::move(profile));
+}
+
+} // Rusty::Internal
@@ -0,0 +1,75 @@
+#ifndef CACHEGRINDPARSER_H
+#define CACHEGRINDPARSER_H
+
+#include <utils/filepath.h>
+
+#include <QHash>
+#include <QPromise>
+
+namespace Rusty::Internal {
+
+// Counts are in the order of CacheProfile::events.
+using EventCounts = QList<qint64>;
+
+class CacheFunction
+{
+public:
+    QString name;
+    Utils::FilePath file;
+    int line = -1;          // The line with the most L1 misses, or instructions.
+    EventCounts counts;
+};
+
+class CacheProfile
+{
+public:
+    QString command;
+    QStringList events;     // "Ir", "I1mr", "ILmr", "Dr", "D1mr", ...
+    EventCounts totals;
+    QList<CacheFunction> functions;
+    QHash<Utils::FilePath, QHash<int, EventCounts>> lines;
+
+    bool hasCacheSimulation() const;
+    qint64 count(const EventCounts &counts, const QString &event) const;
+    qint64 instructions(const EventCounts &counts) const;
+    qint64 l1Misses(const EventCounts &counts) const;   // Instruction and data.
+    qint64 llMisses(const EventCounts &counts) const;
+};
+
+/**
+ * @brief Parses a cachegrind.out file line by line
+ *
+ * Lines are "fl=" and "fn=" switching the current file and function, and
+ * a line number followed by one count per event, trailing zeros left out.
+ * Relative file names are resolved against the project directory, function
+ * names are demangled on the way.
+ */
+class CachegrindParser
+{
+public:
+    explicit CachegrindParser(const Utils::FilePath &projectDirectory);
+
+    bool addLine(const QByteArray &line); // false on a malformed line.
+    CacheProfile takeProfile();
+
+private:
+    int currentFunction();
+
+    const Utils::FilePath m_projectDirectory;
+    CacheProfile m_profile;
+    Utils::FilePath m_file;         // Of the following lines, "fl=", "fi=" or "fe=".
+    Utils::FilePath m_functionFile; // Of the current function, "fl=" only.
+    QString m_function;
+    int m_functionIndex = -1;
+    QHash<QPair<Utils::FilePath, QString>, int> m_functionIndexes;
+    QList<QHash<int, qint64>> m_functionLineWeights;
+    int m_weightEvents[3] = {-1, -1, -1}; // Added up for the hottest line of a function.
+};
+
+// Meant to run on a worker thread.
+void loadCachegrindProfile(QPromise<CacheProfile> &promise, const Utils::FilePath &file,
+                           const Utils::FilePath &projectDirectory);
+
+} // Rusty::Internal
+
+#endif // CACHEGRINDPARSER_H
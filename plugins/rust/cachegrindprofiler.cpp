@@ -0,0 +1,161 @@
+#include "cachegrindprofiler.h"
+
+#include "benchmark.h"
+#include "cachegrindparser.h"
+#include "cachegrindview.h"
+#include "profiledprogram.h"
+#include "rustyconstants.h"
+#include "rusttr.h"
+#include "rustutils.h"
+#include "sourceannotations.h"
+
+#include <coreplugin/icore.h>
+#include <coreplugin/messagemanager.h>
+#include <coreplugin/progressmanager/progressmanager.h>
+
+#include <extensionsystem/pluginmanager.h>
+
+#include <projectexplorer/project.h>
+
+#include <utils/async.h>
+#include <utils/futuresynchronizer.h>
+
+#include <QDateTime>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const char cachegrindTaskId[] = "Rusty.Cachegrind";
+const char cacheAnnotationsId[] = "Rusty.CacheMisses";
+
+// Lines below all of these shares of the totals are not annotated.
+const double minimumInstructionShare = 0.001;
+const double minimumMissShare = 0.005;
+
+static SourceAnnotationMap lineAnnotations(const CacheProfile &profile)
+{
+    const bool simulated = profile.hasCacheSimulation();
+    const qint64 instructions = profile.instructions(profile.totals);
+    const qint64 l1Misses = profile.l1Misses(profile.totals);
+    const qint64 llMisses = profile.llMisses(profile.totals);
+    // Misses make a line hot, without the simulation instructions do.
+    const auto heatOf = [&profile, simulated](const EventCounts &counts) {
+        return simulated ? profile.l1Misses(counts) + profile.llMisses(counts)
+                         : profile.instructions(counts);
+    };
+
+    qint64 hottest = 1;
+    for (const QHash<int, EventCounts> &lines : profile.lines) {
+        for (const EventCounts &counts : lines)
+            hottest = qMax(hottest, heatOf(counts));
+    }
+
+    SourceAnnotationMap result;
+    for (auto file = profile.lines.cbegin(), end = profile.lines.cend(); file != end; ++file) {
+        for (auto line = file.value().cbegin(), lineEnd = file.value().cend(); line != lineEnd;
+             ++line) {
+            const EventCounts &counts = line.value();
+            const qint64 lineInstructions = profile.instructions(counts);
+            const qint64 lineL1Misses = profile.l1Misses(counts);
+            const qint64 lineLlMisses = profile.llMisses(counts);
+            if (lineInstructions < minimumInstructionShare * instructions
+                && (!simulated || (lineL1Misses < minimumMissShare * l1Misses
+                                   && lineLlMisses < minimumMissShare * llMisses))) {
+                continue;
+            }
+            SourceAnnotation annotation;
+            annotation.line = line.key();
+            annotation.heat = double(heatOf(counts)) / hottest;
+            annotation.text = simulated
+                ? Tr::tr("Ir %1, L1 misses %2, LL misses %3")
+                      .arg(formatCount(lineInstructions), formatCount(lineL1Misses),
+                           formatCount(lineLlMisses))
+                : Tr::tr("Ir %1").arg(formatCount(lineInstructions));
+            QStringList toolTip;
+            for (int i = 0; i < profile.events.size(); ++i) {
+                if (counts.value(i) > 0)
+                    toolTip.append(QString("%1: %2").arg(profile.events.at(i)).arg(counts.at(i)));
+            }
+            annotation.toolTip = Tr::tr("cachegrind: %1").arg(toolTip.join(", "));
+            result[file.key()].append(annotation);
+        }
+    }
+    return result;
+}
+
+static void analyzeCacheProfile(const FilePath &outputFile, const FilePath &projectDirectory,
+                                const QString &title)
+{
+    const QFuture<CacheProfile> future
+        = Utils::asyncRun(loadCachegrindProfile, outputFile, projectDirectory);
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(future);
+    Core::ProgressManager::addTask(future, Tr::tr("Reading cachegrind Output"), cachegrindTaskId);
+    Utils::onFinished(future, Core::ICore::instance(),
+                      [outputFile, title](const QFuture<CacheProfile> &future) {
+        if (future.isCanceled())
+            return;
+        try {
+            const auto profile = std::make_shared<const CacheProfile>(future.result());
+            // Only removed once read, one that cannot be read is left to look at.
+            outputFile.removeFile();
+            SourceAnnotations::instance()->setAnnotations(cacheAnnotationsId,
+                                                          Tr::tr("Cache Misses"),
+                                                          lineAnnotations(*profile),
+                                                          QColor(0, 150, 140));
+            showCacheProfile(profile, title);
+        } catch (const std::exception &error) {
+            Core::MessageManager::writeFlashing(Tr::tr("Cannot read the cachegrind output: %1")
+                                                    .arg(QString::fromStdString(error.what())));
+        }
+    });
+}
+
+class CachegrindRunWorker final : public SimpleTargetRunner
+{
+public:
+    explicit CachegrindRunWorker(RunControl *runControl)
+        : SimpleTargetRunner(runControl)
+    {
+        setId("CachegrindRunWorker");
+        m_valgrind = new ProfiledProgram(runControl, "valgrind");
+        addStartDependency(m_valgrind);
+
+        setStartModifier([this, runControl] {
+            // One file per run, the output of an earlier run may still be read.
+            const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz");
+            m_outputFile = rustyDataDirectory(runControl->project()->projectDirectory())
+                               .pathAppended("cachegrind-" + stamp + ".out");
+            m_outputFile.parentDir().ensureWritableDir();
+            // The cache simulation is off by default since valgrind 3.21.
+            CommandLine command{m_valgrind->tool(),
+                                {"--tool=cachegrind", "--cache-sim=yes",
+                                 "--cachegrind-out-file=" + m_outputFile.path()}};
+            command.addCommandLineAsArgs(m_valgrind->commandLine());
+            setCommandLine(command);
+            appendMessage(Tr::tr("The program runs many times slower under cachegrind."),
+                          NormalMessageFormat);
+        });
+
+        connect(this, &RunWorker::stopped, this, [this, runControl] {
+            if (!m_outputFile.exists())
+                return;
+            analyzeCacheProfile(m_outputFile, runControl->project()->projectDirectory(),
+                                Tr::tr("Cache Profile of %1").arg(runControl->displayName()));
+        });
+    }
+
+private:
+    ProfiledProgram *m_valgrind = nullptr;
+    FilePath m_outputFile;
+};
+
+CachegrindRunWorkerFactory::CachegrindRunWorkerFactory()
+{
+    setProduct<CachegrindRunWorker>();
+    addSupportedRunMode(Constants::CACHEGRIND_RUN_MODE);
+    addSupportedRunConfig(Constants::C_RUSTRUNCONFIGURATION_ID);
+}
+
+} // Rusty::Internal
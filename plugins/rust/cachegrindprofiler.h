@@ -0,0 +1,24 @@
+#ifndef CACHEGRINDPROFILER_H
+#define CACHEGRINDPROFILER_H
+
+#include <projectexplorer/runcontrol.h>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Runs a Rust run configuration under valgrind's cachegrind
+ *
+ * Used for the cache simulation run mode. Once the program exits, the
+ * cachegrind output is read on a worker thread, instruction counts and
+ * L1 and last level cache misses are annotated on the source lines and
+ * listed per function.
+ */
+class CachegrindRunWorkerFactory final : public ProjectExplorer::RunWorkerFactory
+{
+public:
+    CachegrindRunWorkerFactory();
+};
+
+} // Rusty::Internal
+
+#endif // CACHEGRINDPROFILER_H
@@ -0,0 +1,131 @@
+#include "cachegrindview.h"
+
+#include "benchmark.h"
+#include "resultutils.h"
+#include "rusttr.h"
+
+#include <coreplugin/editormanager/editormanager.h>
+
+#include <utils/layoutbuilder.h>
+#include <utils/link.h>
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QTreeView>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const int FunctionRole = Qt::UserRole + 1;
+
+enum FunctionColumn {
+    NameColumn,
+    LocationColumn,
+    InstructionsColumn,
+    L1MissesColumn,
+    LlMissesColumn,
+    FirstEventColumn
+};
+
+static QString percentage(qint64 part, qint64 total)
+{
+    return QString("%1 %").arg(total > 0 ? 100.0 * part / total : 0.0, 0, 'f', 2);
+}
+
+class CacheProfileView : public QWidget
+{
+public:
+    CacheProfileView(const std::shared_ptr<const CacheProfile> &profile, const QString &title)
+        : m_profile(profile)
+    {
+        setWindowTitle(title);
+        resize(1200, 700);
+
+        m_model.setHorizontalHeaderLabels(QStringList{Tr::tr("Function"), Tr::tr("Location"),
+                                                      Tr::tr("Instructions"),
+                                                      Tr::tr("L1 Misses"), Tr::tr("LL Misses")}
+                                          + profile->events);
+        for (int i = 0; i < profile->functions.size(); ++i) {
+            const CacheFunction &function = profile->functions.at(i);
+            const qint64 instructions = profile->instructions(function.counts);
+            if (instructions == 0)
+                continue;
+            const QString location = function.file.isEmpty()
+                ? QString()
+                : QString("%1:%2").arg(function.file.fileName()).arg(function.line);
+            QList<QStandardItem *> row{textItem(function.name), textItem(location),
+                                       countItem(instructions),
+                                       countItem(profile->l1Misses(function.counts)),
+                                       countItem(profile->llMisses(function.counts))};
+            for (qint64 count : function.counts)
+                row.append(countItem(count));
+            row.at(NameColumn)->setData(i, FunctionRole);
+            row.at(NameColumn)->setToolTip(function.name);
+            row.at(LocationColumn)->setToolTip(function.file.toUserOutput());
+            m_model.appendRow(row);
+        }
+
+        m_proxy.setSourceModel(&m_model);
+        m_proxy.setSortRole(Qt::UserRole);
+        auto view = new QTreeView;
+        view->setModel(&m_proxy);
+        view->setRootIsDecorated(false);
+        view->setSortingEnabled(true);
+        view->setUniformRowHeights(true);
+        view->sortByColumn(profile->hasCacheSimulation() ? L1MissesColumn : InstructionsColumn,
+                           Qt::DescendingOrder);
+        view->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+        view->header()->setSectionResizeMode(NameColumn, QHeaderView::Interactive);
+        view->header()->resizeSection(NameColumn, 450);
+        for (int column = FirstEventColumn; column < m_model.columnCount(); ++column)
+            view->header()->setSectionHidden(column, !profile->hasCacheSimulation());
+        connect(view, &QTreeView::activated, this, [this](const QModelIndex &index) {
+            const QVariant function = index.siblingAtColumn(NameColumn).data(FunctionRole);
+            if (!function.isValid())
+                return;
+            const CacheFunction &cacheFunction = m_profile->functions.at(function.toInt());
+            if (!cacheFunction.file.isEmpty() && cacheFunction.file.exists())
+                Core::EditorManager::openEditorAt(Link(cacheFunction.file, cacheFunction.line));
+        });
+
+        const EventCounts &totals = profile->totals;
+        const qint64 accesses = profile->instructions(totals) + profile->count(totals, "Dr")
+                                + profile->count(totals, "Dw");
+        auto summary = new QLabel(
+            profile->hasCacheSimulation()
+                ? Tr::tr("%1 instructions. %2 L1 misses, %3 of all accesses, %4 last level "
+                         "misses, %5. Activate a function to open its line with the most "
+                         "misses.")
+                      .arg(formatCount(profile->instructions(totals)),
+                           formatCount(profile->l1Misses(totals)),
+                           percentage(profile->l1Misses(totals), accesses),
+                           formatCount(profile->llMisses(totals)),
+                           percentage(profile->llMisses(totals), accesses))
+                : Tr::tr("%1 instructions, cachegrind ran without cache simulation.")
+                      .arg(formatCount(profile->instructions(totals))));
+        summary->setWordWrap(true);
+        summary->setToolTip(profile->command);
+
+        using namespace Layouting;
+        Column {
+            summary,
+            view
+        }.attachTo(this);
+    }
+
+private:
+    const std::shared_ptr<const CacheProfile> m_profile;
+    QStandardItemModel m_model;
+    QSortFilterProxyModel m_proxy;
+};
+
+void showCacheProfile(const std::shared_ptr<const CacheProfile> &profile, const QString &title)
+{
+    auto view = new CacheProfileView(profile, title);
+    showResultWindow(view);
+}
+
+} // Rusty::Internal
@@ -0,0 +1,16 @@
+#ifndef CACHEGRINDVIEW_H
+#define CACHEGRINDVIEW_H
+
+#include "cachegrindparser.h"
+
+#include <memory>
+
+namespace Rusty::Internal {
+
+// Shows the counts of a cachegrind run per function, activating a function
+// opens the line with the most misses.
+void showCacheProfile(const std::shared_ptr<const CacheProfile> &profile, const QString &title);
+
+} // Rusty::Internal
+
+#endif // CACHEGRINDVIEW_H
@@ -0,0 +1,218 @@
+#include "cargobuildscheduler.h"
+
+#include "rssidebuildconfiguration.h"
+#include "rustproject.h"
+#include "rusttr.h"
+
+#include <coreplugin/editormanager/editormanager.h>
+#include <coreplugin/idocument.h>
+
+#include <projectexplorer/buildmanager.h>
+#include <projectexplorer/buildsteplist.h>
+#include <projectexplorer/deployconfiguration.h>
+#include <projectexplorer/projectmanager.h>
+#include <projectexplorer/target.h>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+// "Save All" and editors saving on focus change save several files in a row.
+const int saveBurstMs = 500;
+
+static CargoBuildScheduler *theScheduler = nullptr;
+
+CargoBuildScheduler::CargoBuildScheduler()
+{
+    theScheduler = this;
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(saveBurstMs);
+    connect(&m_debounce, &QTimer::timeout, this, &CargoBuildScheduler::startPendingCheck);
+    connect(Core::EditorManager::instance(), &Core::EditorManager::saved,
+            this, &CargoBuildScheduler::documentSaved);
+    connect(BuildManager::instance(), &BuildManager::buildQueueFinished,
+            this, &CargoBuildScheduler::buildQueueFinished);
+    connect(BuildManager::instance(), &BuildManager::buildStateChanged,
+            this, &CargoBuildScheduler::cargoRunningChanged);
+    // Builds of other projects, CMake ones for example, have no Rust build step
+    // reporting to buildQueued().
+    connect(BuildManager::instance(), &BuildManager::buildStateChanged,
+            this, [this](Project *project) {
+        if (m_checking && project != m_checking && BuildManager::isBuilding(project))
+            m_otherBuildQueued = true;
+    });
+    connect(BuildManager::instance(), &BuildManager::buildQueueFinished,
+            this, &CargoBuildScheduler::cargoRunningChanged);
+}
+
+CargoBuildScheduler::~CargoBuildScheduler()
+{
+    theScheduler = nullptr;
+}
+
+CargoBuildScheduler *CargoBuildScheduler::instance()
+{
+    return theScheduler;
+}
+
+void CargoBuildScheduler::documentSaved(Core::IDocument *document)
+{
+    // Any save invalidates the builds done so far, not only those of Rust files.
+    ++m_saveGeneration;
+
+    const FilePath file = document->filePath();
+    if (file.suffix() != "rs" && file.fileName() != "Cargo.toml")
+        return;
+    auto project = qobject_cast<RustProject *>(ProjectManager::projectForFile(file));
+    Target *target = project ? project->activeTarget() : nullptr;
+    auto bc = qobject_cast<RsSideBuildConfiguration *>(
+        target ? target->activeBuildConfiguration() : nullptr);
+    if (!bc || !bc->checkOnSave())
+        return;
+
+    // A single pending request, later saves only push it back.
+    m_pending = project;
+    m_debounce.start();
+}
+
+void CargoBuildScheduler::startPendingCheck()
+{
+    // Started by pruneFinished() otherwise.
+    if (!m_pending || m_pruning)
+        return;
+
+    if (BuildManager::isBuilding()) {
+        // The running check is outdated. Cancelling stops the whole queue, so
+        // it only happens when nothing but the check is in it, otherwise the
+        // pending check waits for the queue to finish.
+        if (m_checking && !m_otherBuildQueued && !queuesOtherSteps())
+            BuildManager::cancel();
+        return;
+    }
+
+    // Only the cargo step runs, the other steps of the configuration, like the
+    // feature matrix, are far too slow to run on every save.
+    Target *target = m_pending->activeTarget();
+    auto bc = qobject_cast<RsSideBuildConfiguration *>(
+        target ? target->activeBuildConfiguration() : nullptr);
+    RsSideBuildStep *step = bc && bc->checkOnSave()
+                                ? bc->buildSteps()->firstOfType<RsSideBuildStep>() : nullptr;
+    m_pending.clear();
+    if (!step)
+        return;
+
+    m_checking = bc->project();
+    m_checkStep = step;
+    m_otherBuildQueued = false;
+    // The build steps are initialized synchronously while queuing.
+    m_startingCheck = true;
+    BuildManager::appendStep(step, Tr::tr("Check"));
+    m_startingCheck = false;
+}
+
+// Steps of the checked project other than the check, its deploy steps for
+// example, are queued without a Rust build step as well.
+bool CargoBuildScheduler::queuesOtherSteps() const
+{
+    Target *target = m_checking ? m_checking->activeTarget() : nullptr;
+    if (!target)
+        return false;
+    QList<BuildStepList *> lists;
+    if (BuildConfiguration *bc = target->activeBuildConfiguration())
+        lists << bc->buildSteps() << bc->cleanSteps();
+    if (DeployConfiguration *dc = target->activeDeployConfiguration())
+        lists << dc->stepList();
+    for (BuildStepList *list : std::as_const(lists)) {
+        for (BuildStep *step : list->steps()) {
+            if (step != m_checkStep && BuildManager::isBuilding(step))
+                return true;
+        }
+    }
+    return false;
+}
+
+void CargoBuildScheduler::buildQueueFinished()
+{
+    ++m_queue;
+    m_checking.clear();
+    m_checkStep.clear();
+    m_otherBuildQueued = false;
+    if (m_pending)
+        m_debounce.start();
+}
+
+void CargoBuildScheduler::buildQueued(const BuildConfiguration *bc, bool check)
+{
+    Q_UNUSED(bc)
+    if (!check && BuildManager::isBuilding())
+        m_otherBuildQueued = true;
+}
+
+bool CargoBuildScheduler::isRedundant(const BuildConfiguration *bc, bool check) const
+{
+    const auto run = m_runs.constFind(bc);
+    return run != m_runs.constEnd() && run->queue == m_queue && run->check == check
+           && run->saveGeneration == m_saveGeneration && run->success;
+}
+
+void CargoBuildScheduler::buildStarted(const BuildConfiguration *bc, bool check)
+{
+    m_runs.insert(bc, {m_queue, m_saveGeneration, check, false});
+}
+
+void CargoBuildScheduler::buildFinished(const BuildConfiguration *bc, bool success)
+{
+    const auto run = m_runs.find(bc);
+    if (run != m_runs.end())
+        run->success = success;
+}
+
+bool CargoBuildScheduler::backgroundCargoStarted()
+{
+    // Counted first, startPrune() sets the flag first and checks the count.
+    ++m_backgroundCargos;
+    if (m_pruning) {
+        --m_backgroundCargos;
+        return false;
+    }
+    emit cargoRunningChanged();
+    return true;
+}
+
+void CargoBuildScheduler::backgroundCargoFinished()
+{
+    --m_backgroundCargos;
+    emit cargoRunningChanged();
+}
+
+bool CargoBuildScheduler::isCargoRunning()
+{
+    return BuildManager::isBuilding() || (theScheduler && theScheduler->m_backgroundCargos > 0);
+}
+
+bool CargoBuildScheduler::startPrune()
+{
+    m_pruning = true;
+    if (isCargoRunning()) {
+        m_pruning = false;
+        return false;
+    }
+    emit cargoRunningChanged();
+    return true;
+}
+
+void CargoBuildScheduler::pruneFinished()
+{
+    m_pruning = false;
+    emit cargoRunningChanged();
+    if (m_pending)
+        m_debounce.start();
+}
+
+bool CargoBuildScheduler::isPruning()
+{
+    return theScheduler && theScheduler->m_pruning;
+}
+
+} // Rusty::Internal
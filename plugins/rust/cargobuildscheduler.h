@@ -0,0 +1,104 @@
+#ifndef CARGOBUILDSCHEDULER_H
+#define CARGOBUILDSCHEDULER_H
+
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
+
+#include <atomic>
+
+namespace Core { class IDocument; }
+namespace ProjectExplorer {
+class BuildConfiguration;
+class BuildStep;
+class Project;
+}
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Keeps cargo from running builds nobody waits for
+ *
+ * Saving Rust sources of a project whose active build configuration has
+ * "Check on save" enabled runs cargo check. A burst of saves results in at
+ * most one pending check, and a newer save cancels a check that is still
+ * running instead of queuing behind it.
+ *
+ * A build that is requested again before anything was saved, e.g. by hitting
+ * Build twice, is skipped when the identical build already succeeded in the
+ * same build queue: it would only wait for cargo's lock to find nothing to do.
+ *
+ * The scheduler also counts the cargo processes started outside of the
+ * BuildManager, like dependency pre-builds and the emit builds of the IR and
+ * assembly views, for whatever must not interfere with a running cargo, and
+ * holds back all of them while the target directories are pruned.
+ */
+class CargoBuildScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    CargoBuildScheduler();
+    ~CargoBuildScheduler() override;
+
+    static CargoBuildScheduler *instance();
+
+    // Whether the build being queued right now was started for saved files.
+    bool isStartingCheck() const { return m_startingCheck; }
+
+    // Changes whenever a build queue finished or a document was saved, the
+    // only times built artifacts go stale short of changes outside Qt Creator.
+    QPair<int, int> generation() const { return {m_queue, m_saveGeneration}; }
+
+    void buildQueued(const ProjectExplorer::BuildConfiguration *bc, bool check);
+    bool isRedundant(const ProjectExplorer::BuildConfiguration *bc, bool check) const;
+    void buildStarted(const ProjectExplorer::BuildConfiguration *bc, bool check);
+    void buildFinished(const ProjectExplorer::BuildConfiguration *bc, bool success);
+
+    // May be called from any thread. Refused while the target directories
+    // are pruned.
+    bool backgroundCargoStarted();
+    void backgroundCargoFinished();
+    // In a build or in the background.
+    static bool isCargoRunning();
+
+    // Cargo must not run while stale artifacts are removed from the target
+    // directories. Fails when it already runs.
+    bool startPrune();
+    void pruneFinished();
+    static bool isPruning();
+
+signals:
+    void cargoRunningChanged();
+
+private:
+    void documentSaved(Core::IDocument *document);
+    void startPendingCheck();
+    bool queuesOtherSteps() const;
+    void buildQueueFinished();
+
+    class Run
+    {
+    public:
+        int queue = 0;
+        int saveGeneration = 0;
+        bool check = false;
+        bool success = false;
+    };
+
+    QTimer m_debounce;
+    QPointer<ProjectExplorer::Project> m_pending;
+    QPointer<ProjectExplorer::Project> m_checking;
+    QPointer<ProjectExplorer::BuildStep> m_checkStep;
+    bool m_startingCheck = false;
+    bool m_otherBuildQueued = false;
+    int m_queue = 0;
+    int m_saveGeneration = 0;
+    std::atomic_int m_backgroundCargos = 0;
+    std::atomic_bool m_pruning = false;
+    QHash<const ProjectExplorer::BuildConfiguration *, Run> m_runs;
+};
+
+} // Rusty::Internal
+
+#endif // CARGOBUILDSCHEDULER_H
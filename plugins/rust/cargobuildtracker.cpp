@@ -0,0 +1,120 @@
+#include "cargobuildtracker.h"
+
+#include "cargooutputparser.h"
+#include "rusttr.h"
+
+#include <cmath>
+
+namespace Rusty::Internal {
+
+static QString crateKey(const QString &packageName, const QString &packageVersion)
+{
+    return packageName + " v" + packageVersion;
+}
+
+void CargoBuildTracker::start(int expectedUnits, const QHash<QString, qint64> &crateDurations)
+{
+    m_timer.start();
+    m_expectedUnits = expectedUnits;
+    m_finishedUnits = 0;
+    m_compiledUnits = 0;
+    m_lastPercent = -1;
+    m_lastDurations = crateDurations;
+    m_started.clear();
+    m_durations.clear();
+    m_seen.clear();
+}
+
+void CargoBuildTracker::unitStarted(const QString &packageName, const QString &packageVersion)
+{
+    m_started.insert(crateKey(packageName, packageVersion), m_timer.elapsed());
+}
+
+void CargoBuildTracker::artifactFinished(const CargoArtifact &artifact)
+{
+    ++m_finishedUnits;
+    const QString crate = crateKey(artifact.packageName, artifact.packageVersion);
+    m_seen.insert(crate);
+    if (!artifact.fresh) {
+        ++m_compiledUnits;
+        // A package may produce several units (build script, lib, bin), its
+        // duration spans from "Compiling" up to its last artifact.
+        const auto started = m_started.constFind(crate);
+        if (started != m_started.constEnd())
+            m_durations.insert(crate, m_timer.elapsed() - *started);
+    }
+    updateProgress();
+}
+
+QHash<QString, qint64> CargoBuildTracker::crateDurations() const
+{
+    QHash<QString, qint64> result;
+    for (auto it = m_lastDurations.cbegin(), end = m_lastDurations.cend(); it != end; ++it) {
+        // Crates that did not show up at all are no longer part of the build.
+        if (m_seen.contains(it.key()))
+            result.insert(it.key(), it.value());
+    }
+    for (auto it = m_durations.cbegin(), end = m_durations.cend(); it != end; ++it)
+        result.insert(it.key(), it.value());
+    return result;
+}
+
+QList<QPair<QString, qint64>> CargoBuildTracker::outliers(int maxCount) const
+{
+    const QHash<QString, qint64> durations = crateDurations();
+    if (durations.size() < 4)
+        return {};
+
+    double sum = 0;
+    for (const qint64 duration : durations)
+        sum += duration;
+    const double mean = sum / durations.size();
+    double variance = 0;
+    for (const qint64 duration : durations)
+        variance += (duration - mean) * (duration - mean);
+    const double threshold = mean + 2 * std::sqrt(variance / durations.size());
+
+    QList<QPair<QString, qint64>> result;
+    for (auto it = durations.cbegin(), end = durations.cend(); it != end; ++it) {
+        if (it.value() > threshold)
+            result.append({it.key(), it.value()});
+    }
+    std::sort(result.begin(), result.end(), [](const auto &a, const auto &b) {
+        return a.second > b.second;
+    });
+    return result.mid(0, maxCount);
+}
+
+void CargoBuildTracker::updateProgress()
+{
+    if (m_expectedUnits <= 0) {
+        emit progressChanged(0, Tr::tr("%n units built", nullptr, m_finishedUnits));
+        return;
+    }
+
+    // The unit count may change between builds, never claim to be done early.
+    const int percent = qMin(99, m_finishedUnits * 100 / m_expectedUnits);
+    if (percent == m_lastPercent)
+        return;
+    m_lastPercent = percent;
+
+    // Work still ahead according to earlier builds, spread over the
+    // parallelism cargo achieved so far in this one.
+    qint64 remaining = 0;
+    for (auto it = m_lastDurations.cbegin(), end = m_lastDurations.cend(); it != end; ++it) {
+        if (!m_seen.contains(it.key()))
+            remaining += it.value();
+    }
+    qint64 busy = 0;
+    for (const qint64 duration : std::as_const(m_durations))
+        busy += duration;
+    const double parallelism = qMax(1.0, double(busy) / qMax<qint64>(1, m_timer.elapsed()));
+    const qint64 etaSeconds = qRound64(remaining / parallelism / 1000);
+
+    QString message = Tr::tr("%1/%2 units").arg(m_finishedUnits).arg(m_expectedUnits);
+    if (etaSeconds > 0)
+        message += ", " + Tr::tr("about %n s left", nullptr, int(etaSeconds));
+    emit progressChanged(percent, message);
+}
+
+} // Rusty::Internal
@@ -0,0 +1,61 @@
+#ifndef CARGOBUILDTRACKER_H
+#define CARGOBUILDTRACKER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+namespace Rusty::Internal {
+
+class CargoArtifact;
+
+/**
+ * @brief Follows a running cargo build and estimates its progress
+ *
+ * Every unit cargo builds (or finds fresh) ends with a compiler-artifact
+ * message. Counting them against the unit count of the previous build of the
+ * same configuration gives the progress percentage. The remaining time is
+ * estimated from the per-crate durations of earlier builds that did not show
+ * up yet in the current one.
+ */
+class CargoBuildTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    void start(int expectedUnits, const QHash<QString, qint64> &crateDurations);
+
+    void unitStarted(const QString &packageName, const QString &packageVersion);
+    void artifactFinished(const CargoArtifact &artifact);
+
+    int finishedUnits() const { return m_finishedUnits; }
+    int compiledUnits() const { return m_compiledUnits; }
+    qint64 elapsedMs() const { return m_timer.elapsed(); }
+
+    // Durations of earlier builds updated with the crates compiled in this one,
+    // keyed by "name vversion": two versions of a crate are two crates.
+    QHash<QString, qint64> crateDurations() const;
+    QHash<QString, qint64> compiledCrateDurations() const { return m_durations; }
+    QList<QPair<QString, qint64>> outliers(int maxCount = 5) const;
+
+signals:
+    void progressChanged(int percent, const QString &message);
+
+private:
+    void updateProgress();
+
+    QElapsedTimer m_timer;
+    int m_expectedUnits = 0;
+    int m_finishedUnits = 0;
+    int m_compiledUnits = 0;
+    int m_lastPercent = -1;
+    QHash<QString, qint64> m_lastDurations;
+    QHash<QString, qint64> m_started;
+    QHash<QString, qint64> m_durations;
+    QSet<QString> m_seen;
+};
+
+} // Rusty::Internal
+
+#endif // CARGOBUILDTRACKER_H
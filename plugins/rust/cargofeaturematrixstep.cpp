@@ -0,0 +1,303 @@
+#include "cargofeaturematrixstep.h"
+
+#include "cargooutputparser.h"
+#include "rustproject.h"
+#include "rusttr.h"
+
+#include <projectexplorer/buildsteplist.h>
+#include <projectexplorer/project.h>
+#include <projectexplorer/task.h>
+
+#include <solutions/tasking/tasktree.h>
+
+#include <utils/outputformatter.h>
+#include <utils/process.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QThread>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const char CargoFeatureMatrixStepId[] = "Rust.CargoFeatureMatrixStep";
+
+CargoFeatureMatrixStepFactory::CargoFeatureMatrixStepFactory()
+{
+    registerStep<CargoFeatureMatrixStep>(CargoFeatureMatrixStepId);
+    setSupportedProjectType(RustProjectId);
+    setDisplayName(Tr::tr("Cargo feature matrix"));
+}
+
+// Cargo.toml is TOML, but feature names are always the keys of the
+// [features] table, one per line.
+static QStringList manifestFeatures(const FilePath &manifest)
+{
+    QStringList features;
+    const expected_str<QByteArray> contents = manifest.fileContents();
+    if (!contents)
+        return features;
+
+    bool inFeatures = false;
+    for (const QByteArray &rawLine : contents->split('\n')) {
+        const QString line = QString::fromUtf8(rawLine).trimmed();
+        if (line.startsWith('[')) {
+            inFeatures = line == "[features]";
+            continue;
+        }
+        const int equals = line.indexOf('=');
+        if (!inFeatures || equals <= 0 || line.startsWith('#'))
+            continue;
+        QString name = line.left(equals).trimmed();
+        if (name.startsWith('"'))
+            name = name.mid(1, name.size() - 2);
+        if (name != "default")
+            features.append(name);
+    }
+    return features;
+}
+
+static void appendSubsets(const QStringList &features, int maxSize, int start,
+                          QStringList &current, QList<QStringList> &result)
+{
+    result.append(current);
+    if (current.size() == maxSize)
+        return;
+    for (int i = start; i < features.size(); ++i) {
+        current.append(features.at(i));
+        appendSubsets(features, maxSize, i + 1, current, result);
+        current.removeLast();
+    }
+}
+
+CargoFeatureMatrixStep::CargoFeatureMatrixStep(BuildStepList *bsl, Id id)
+    : BuildStep(bsl, id)
+{
+    m_command.setSettingsKey("Rust.FeatureMatrix.Command");
+    m_command.setLabelText(Tr::tr("Command:"));
+    m_command.setDisplayStyle(SelectionAspect::DisplayStyle::ComboBox);
+    m_command.addOption("check");
+    m_command.addOption("build");
+    m_command.addOption("clippy");
+
+    m_matrix.setSettingsKey("Rust.FeatureMatrix.Matrix");
+    m_matrix.setLabelText(Tr::tr("Feature combinations:"));
+    m_matrix.setDisplayStyle(StringAspect::TextEditDisplay);
+    m_matrix.setPlaceHolderText(Tr::tr("One combination per line, for example \"std, serde\". "
+                                       "Leave empty to check the powerset of the features "
+                                       "in Cargo.toml."));
+
+    m_maxFeatures.setSettingsKey("Rust.FeatureMatrix.MaxFeatures");
+    m_maxFeatures.setLabelText(Tr::tr("Features per combination:"));
+    m_maxFeatures.setToolTip(Tr::tr("Largest subset of the features in Cargo.toml combined "
+                                    "when no combinations are given."));
+    m_maxFeatures.setRange(1, 10);
+    m_maxFeatures.setDefaultValue(2);
+
+    m_jobs.setSettingsKey("Rust.FeatureMatrix.Jobs");
+    m_jobs.setLabelText(Tr::tr("Parallel jobs:"));
+    m_jobs.setToolTip(Tr::tr("Number of cargo processes running at the same time. Each gets "
+                             "a target directory of its own and its share of the cores."));
+    m_jobs.setRange(1, 64);
+    m_jobs.setDefaultValue(qMax(1, QThread::idealThreadCount() / 2));
+
+    m_failFast.setSettingsKey("Rust.FeatureMatrix.FailFast");
+    m_failFast.setLabel(Tr::tr("Stop at the first failing combination"),
+                        BoolAspect::LabelPlacement::AtCheckBox);
+
+    setSummaryUpdater([this] {
+        return Tr::tr("<b>Feature matrix:</b> cargo %1, %n combinations", nullptr,
+                      featureCombinations().size())
+            .arg(m_command.stringValue());
+    });
+}
+
+QList<QStringList> CargoFeatureMatrixStep::featureCombinations() const
+{
+    QList<QStringList> result;
+    const QString matrix = m_matrix().trimmed();
+    if (!matrix.isEmpty()) {
+        static const QRegularExpression separator("[,\\s]+");
+        for (const QString &line : matrix.split('\n')) {
+            const QString trimmed = line.trimmed();
+            if (!trimmed.isEmpty() && !trimmed.startsWith('#'))
+                result.append(trimmed.split(separator, Qt::SkipEmptyParts));
+        }
+        return result;
+    }
+
+    const QStringList features = manifestFeatures(
+        project()->projectDirectory().pathAppended("Cargo.toml"));
+    QStringList current;
+    appendSubsets(features, m_maxFeatures(), 0, current, result);
+    std::stable_sort(result.begin(), result.end(), [](const QStringList &a, const QStringList &b) {
+        return a.size() < b.size();
+    });
+    result.prepend({"default"});
+    return result;
+}
+
+bool CargoFeatureMatrixStep::init()
+{
+    m_cargo = buildEnvironment().searchInPath("cargo");
+    if (!m_cargo.isExecutableFile()) {
+        emit addTask(BuildSystemTask(Task::Error, Tr::tr("Cargo could not be found.")));
+        emitFaultyConfigurationMessage();
+        return false;
+    }
+    return true;
+}
+
+void CargoFeatureMatrixStep::setupOutputFormatter(OutputFormatter *formatter)
+{
+    formatter->addLineParser(new CargoOutputParser);
+    BuildStep::setupOutputFormatter(formatter);
+}
+
+FilePath CargoFeatureMatrixStep::slotDirectory(int slot) const
+{
+    const QString targetDir = buildEnvironment().value("CARGO_TARGET_DIR");
+    const FilePath target = targetDir.isEmpty()
+        ? project()->projectDirectory().pathAppended("target")
+        : project()->projectDirectory().resolvePath(targetDir);
+    return target.pathAppended(QString("feature-matrix/slot-%1").arg(slot));
+}
+
+Tasking::GroupItem CargoFeatureMatrixStep::runRecipe()
+{
+    using namespace Tasking;
+
+    const QList<QStringList> combinations = featureCombinations();
+    const int jobs = qMax(1, qMin<int>(m_jobs(), combinations.size()));
+    // Every cargo would otherwise start a job per core on its own.
+    const int cargoJobs = qMax(1, QThread::idealThreadCount() / jobs);
+
+    const auto onSetup = [this, combinations, jobs] {
+        m_results.clear();
+        for (const QStringList &features : combinations)
+            m_results.append({features});
+        m_freeSlots.clear();
+        for (int slot = 0; slot < jobs; ++slot)
+            m_freeSlots.append(slot);
+        m_reported = 0;
+        emit addOutput(Tr::tr("Checking %n feature combinations, %1 at a time.", nullptr,
+                              combinations.size()).arg(jobs),
+                       OutputFormat::NormalMessage);
+    };
+
+    // Combination index -> slot and start time of the running processes.
+    const auto running = std::make_shared<QHash<int, QPair<int, QElapsedTimer>>>();
+
+    QList<GroupItem> items{parallelLimit(jobs),
+                           workflowPolicy(m_failFast() ? WorkflowPolicy::StopOnError
+                                                       : WorkflowPolicy::ContinueOnError),
+                           onGroupSetup(onSetup)};
+    for (int index = 0; index < combinations.size(); ++index) {
+        const auto onProcessSetup = [this, index, cargoJobs, running](Process &process) {
+            // parallelLimit guarantees a free slot.
+            const int slot = m_freeSlots.takeFirst();
+            QElapsedTimer timer;
+            timer.start();
+            running->insert(index, {slot, timer});
+
+            Environment env = buildEnvironment();
+            env.set("CARGO_TARGET_DIR", slotDirectory(slot).path());
+            QStringList arguments{m_command.stringValue(), "--message-format=json",
+                                  "--no-default-features", "-j", QString::number(cargoJobs)};
+            const QStringList &features = m_results.at(index).features;
+            if (!features.isEmpty())
+                arguments << "--features" << features.join(',');
+            process.setEnvironment(env);
+            process.setWorkingDirectory(project()->projectDirectory());
+            process.setCommand({m_cargo, arguments});
+        };
+        const auto onProcessDone = [this, index, running](const Process &process) {
+            const auto [slot, timer] = running->take(index);
+            m_freeSlots.append(slot);
+            FeatureCombinationResult &result = m_results[index];
+            result.finished = true;
+            result.passed = process.result() == ProcessResult::FinishedWithSuccess;
+            result.durationMs = timer.elapsed();
+            result.output = process.cleanedStdOut();
+            if (!result.passed)
+                result.errorOutput = process.cleanedStdErr();
+            reportCombination(index);
+        };
+        items.append(ProcessTask(onProcessSetup, onProcessDone, onProcessDone));
+    }
+    items.append(onGroupDone([this] { reportSummary(); }));
+    items.append(onGroupError([this] { reportSummary(); }));
+    return Group(items);
+}
+
+static bool hasCompilerError(const QString &output)
+{
+    for (const QStringView line : QStringTokenizer(output, u'\n')) {
+        if (!line.startsWith('{'))
+            continue;
+        const QJsonObject object = QJsonDocument::fromJson(line.toUtf8()).object();
+        if (object.value("reason").toString() == "compiler-message"
+            && object.value("message").toObject().value("level").toString().startsWith("error")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CargoFeatureMatrixStep::reportCombination(int index)
+{
+    const FeatureCombinationResult &result = m_results.at(index);
+    const QString features = result.features.isEmpty() ? Tr::tr("(no features)")
+                                                       : result.features.join(',');
+    ++m_reported;
+    emit progress(100 * m_reported / m_results.size(),
+                  Tr::tr("%1 of %2 feature combinations").arg(m_reported).arg(m_results.size()));
+    if (result.passed) {
+        emit addOutput(Tr::tr("[%1/%2] %3: passed (%4 s)")
+                           .arg(m_reported).arg(m_results.size()).arg(features)
+                           .arg(result.durationMs / 1000.0, 0, 'f', 1),
+                       OutputFormat::NormalMessage);
+        // Warnings specific to the combination.
+        emit addOutput(result.output, OutputFormat::Stdout, DontAppendNewline);
+        return;
+    }
+
+    emit addOutput(Tr::tr("[%1/%2] %3: failed (%4 s)")
+                       .arg(m_reported).arg(m_results.size()).arg(features)
+                       .arg(result.durationMs / 1000.0, 0, 'f', 1),
+                   OutputFormat::ErrorMessage);
+    // The CargoOutputParser turns the messages into tasks.
+    emit addOutput(result.output, OutputFormat::Stdout, DontAppendNewline);
+
+    // Unknown features and the like fail before anything is compiled.
+    if (!hasCompilerError(result.output)) {
+        emit addOutput(result.errorOutput, OutputFormat::Stderr, DontAppendNewline);
+        Task task = CompileTask(Task::Error,
+                                Tr::tr("Feature combination \"%1\" fails.").arg(features));
+        task.details = result.errorOutput.split('\n', Qt::SkipEmptyParts);
+        emit addTask(task);
+    }
+}
+
+void CargoFeatureMatrixStep::reportSummary()
+{
+    int passed = 0;
+    int failed = 0;
+    for (const FeatureCombinationResult &result : std::as_const(m_results)) {
+        if (result.finished && result.passed)
+            ++passed;
+        else if (result.finished)
+            ++failed;
+    }
+    const int skipped = m_results.size() - passed - failed;
+    emit addOutput(Tr::tr("Feature matrix: %1 passed, %2 failed, %3 not checked.")
+                       .arg(passed).arg(failed).arg(skipped),
+                   failed > 0 ? OutputFormat::ErrorMessage : OutputFormat::NormalMessage);
+}
+
+} // Rusty::Internal
@@ -0,0 +1,69 @@
+#ifndef CARGOFEATUREMATRIXSTEP_H
+#define CARGOFEATUREMATRIXSTEP_H
+
+#include <projectexplorer/buildstep.h>
+
+namespace Rusty::Internal {
+
+class FeatureCombinationResult
+{
+public:
+    QStringList features;
+    bool finished = false;
+    bool passed = false;
+    qint64 durationMs = 0;
+    QString output;       // Cargo's JSON messages.
+    QString errorOutput;
+};
+
+/**
+ * @brief Checks a crate with every combination of a feature matrix
+ *
+ * The combinations are either declared one per line, or the powerset of the
+ * features in Cargo.toml up to a given size. Up to "jobs" cargo processes run
+ * in parallel, each in a target directory of its own slot: sharing one target
+ * directory would serialize them on cargo's directory lock, and reusing a
+ * slot keeps the dependencies built by the previous combination.
+ *
+ * The output of a combination is passed on as a whole once it finished, so
+ * the diagnostics of parallel processes do not interleave.
+ */
+class CargoFeatureMatrixStep : public ProjectExplorer::BuildStep
+{
+    Q_OBJECT
+
+public:
+    CargoFeatureMatrixStep(ProjectExplorer::BuildStepList *bsl, Utils::Id id);
+
+    QList<QStringList> featureCombinations() const;
+
+private:
+    bool init() final;
+    void setupOutputFormatter(Utils::OutputFormatter *formatter) final;
+    Tasking::GroupItem runRecipe() final;
+
+    Utils::FilePath slotDirectory(int slot) const;
+    void reportCombination(int index);
+    void reportSummary();
+
+    Utils::SelectionAspect m_command{this};
+    Utils::StringAspect m_matrix{this};
+    Utils::IntegerAspect m_maxFeatures{this};
+    Utils::IntegerAspect m_jobs{this};
+    Utils::BoolAspect m_failFast{this};
+
+    Utils::FilePath m_cargo;
+    QList<FeatureCombinationResult> m_results;
+    QList<int> m_freeSlots;
+    int m_reported = 0;
+};
+
+class CargoFeatureMatrixStepFactory : public ProjectExplorer::BuildStepFactory
+{
+public:
+    CargoFeatureMatrixStepFactory();
+};
+
+} // Rusty::Internal
+
+#endif // CARGOFEATUREMATRIXSTEP_H
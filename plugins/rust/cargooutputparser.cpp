@@ -0,0 +1,260 @@
+#include "cargooutputparser.h"
+
+#include "optimizationremarks.h"
+#include "rusttaskqueue.h"
+
+#include <coreplugin/outputwindow.h>
+
+#include <projectexplorer/projectexplorerconstants.h>
+
+#include <utils/filepath.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+CargoOutputParser::CargoOutputParser() = default;
+
+void parsePackageId(const QString &packageId, QString *name, QString *version)
+{
+    // Cargo < 1.77: "foo 0.1.0 (path+file:///src/foo)"
+    // Cargo >= 1.77: "path+file:///src/foo#0.1.0" or
+    //                "registry+https://github.com/rust-lang/crates.io-index#foo@0.1.0"
+    const int hash = packageId.lastIndexOf('#');
+    if (hash < 0) {
+        *name = packageId.section(' ', 0, 0);
+        *version = packageId.section(' ', 1, 1);
+        return;
+    }
+    const QString fragment = packageId.mid(hash + 1);
+    const int at = fragment.indexOf('@');
+    if (at >= 0) {
+        *name = fragment.left(at);
+        *version = fragment.mid(at + 1);
+    } else {
+        *name = packageId.left(hash).section('/', -1);
+        *version = fragment;
+    }
+}
+
+OutputLineParser::Result CargoOutputParser::handleLine(const QString &line, OutputFormat format)
+{
+    // Cargo writes its JSON messages to stdout only, everything on stderr
+    // ("Compiling ...", "Finished ...") stays plain text.
+    if (format == StdErrFormat) {
+        const QString trimmed = line.trimmed();
+        // "Blocking waiting for file lock on package cache", possibly followed
+        // by the same for the build directory. Updating the index or
+        // downloading prints more lines while cargo still waits, the wait only
+        // ends with the first unit it reports on stdout.
+        if (trimmed.startsWith("Blocking waiting for file lock")) {
+            if (!m_lockWait.isValid())
+                m_lockWait.start();
+        } else if (trimmed.startsWith("Compiling ")) {
+            emit unitStarted(trimmed.section(' ', 1, 1), trimmed.section(' ', 2, 2).mid(1));
+        }
+        return Status::NotHandled;
+    }
+    if (format != StdOutFormat)
+        return Status::NotHandled;
+
+    const QString trimmed = rightTrimmed(line);
+    if (!trimmed.startsWith('{'))
+        return Status::NotHandled;
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(trimmed.toUtf8(), &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject())
+        return Status::NotHandled;
+
+    const QJsonObject object = doc.object();
+    const QString reason = object.value("reason").toString();
+    if ((reason == "compiler-message" || reason == "compiler-artifact") && m_lockWait.isValid()) {
+        emit lockWaitFinished(m_lockWait.elapsed());
+        m_lockWait.invalidate();
+    }
+    if (reason == "compiler-message")
+        return handleCompilerMessage(object.value("message").toObject());
+    if (reason == "compiler-artifact")
+        handleCompilerArtifact(object);
+
+    // Artifact, build script and build-finished notifications carry nothing
+    // the user wants to read in the compile output, drop them.
+    return {Status::Done, {}, QString()};
+}
+
+OutputLineParser::Result CargoOutputParser::handleCompilerMessage(const QJsonObject &message)
+{
+    QString rendered = message.value("rendered").toString();
+    if (!rendered.isEmpty() && !rendered.endsWith('\n'))
+        rendered += '\n';
+
+    const QString level = message.value("level").toString();
+    Task::TaskType type = Task::Unknown;
+    if (level.startsWith("error"))
+        type = Task::Error;
+    else if (level == "warning")
+        type = Task::Warning;
+    else if (level == "note" && handleOptimizationRemark(message.value("message").toString()))
+        return {Status::Done, {}, QString()};
+    else
+        return {Status::Done, {}, rendered};
+
+    QString summary = message.value("message").toString();
+    const QString code = message.value("code").toObject().value("code").toString();
+    if (!code.isEmpty())
+        summary = QString("[%1] %2").arg(code, summary);
+
+    const QJsonArray spans = message.value("spans").toArray();
+    if (spans.isEmpty()) {
+        // "aborting due to ..." and "N warnings emitted" summaries.
+        if (type != Task::Error || summary.startsWith("aborting due to"))
+            return {Status::Done, {}, rendered};
+        Task task(type, summary, {}, -1, ProjectExplorer::Constants::TASK_CATEGORY_COMPILE);
+        task.details = rendered.trimmed().split('\n');
+        if (!RustTaskQueue::instance()->filterGroup({task}).isEmpty())
+            linkTask(task, 1);
+        return {Status::Done, {}, rendered};
+    }
+
+    Tasks primary;
+    Tasks secondary;
+    for (const QJsonValue &value : spans) {
+        const QJsonObject span = value.toObject();
+        if (span.value("is_primary").toBool()) {
+            primary.append(createTask(type, summary, span));
+        } else {
+            const QString label = span.value("label").toString();
+            if (!label.isEmpty())
+                secondary.append(createTask(Task::Unknown, label, span));
+        }
+    }
+
+    for (const QJsonValue &value : message.value("children").toArray()) {
+        const QJsonObject child = value.toObject();
+        const QString childSummary = QString("%1: %2").arg(child.value("level").toString(),
+                                                           child.value("message").toString());
+        for (const QJsonValue &childSpan : child.value("spans").toArray()) {
+            const QJsonObject span = childSpan.toObject();
+            if (span.value("is_primary").toBool())
+                secondary.append(createTask(Task::Unknown, childSummary, span));
+        }
+    }
+
+    if (primary.isEmpty())
+        primary.append(createTask(type, summary, spans.first().toObject()));
+
+    const QStringList details = rendered.trimmed().split('\n');
+    for (Task &task : primary)
+        task.details = details;
+
+    // All tasks of one compiler message form a group, so a diagnostic that is
+    // reported again for another target of the same crate is dropped as a whole.
+    const Tasks tasks = RustTaskQueue::instance()->filterGroup(primary + secondary);
+    for (qsizetype i = 0; i < tasks.size(); ++i)
+        linkTask(tasks.at(i), i < primary.size() ? 1 : 0);
+
+    return {Status::Done, {}, rendered};
+}
+
+// scheduleTask() would add every task to the TaskHub right after its line is
+// printed. The position in the output is registered the same way, by task id,
+// the tasks themselves go through the queue.
+void CargoOutputParser::linkTask(const Task &task, int outputLines)
+{
+    Task linked = task;
+    if (linked.type == Task::Error && demoteErrorsToWarnings())
+        linked.type = Task::Warning;
+    m_linkedTasks.append({linked, outputLines});
+}
+
+void CargoOutputParser::runPostPrintActions(QPlainTextEdit *edit)
+{
+    if (m_linkedTasks.isEmpty())
+        return;
+    if (const auto window = qobject_cast<Core::OutputWindow *>(edit)) {
+        int offset = 0;
+        for (auto it = m_linkedTasks.crbegin(); it != m_linkedTasks.crend(); ++it) {
+            window->registerPositionOf(it->first.taskId, it->second, 0, offset);
+            offset += it->second;
+        }
+    }
+    Tasks tasks;
+    for (const auto &[task, outputLines] : std::as_const(m_linkedTasks))
+        tasks.append(task);
+    m_linkedTasks.clear();
+    RustTaskQueue::instance()->addFiltered(tasks);
+}
+
+void CargoOutputParser::flush()
+{
+    RustTaskQueue::instance()->flush();
+}
+
+bool CargoOutputParser::handleOptimizationRemark(const QString &message)
+{
+    OptimizationRemark remark;
+    if (!parseOptimizationRemark(message, &remark))
+        return false;
+    // Remarks are never written to the compile output, there are far too
+    // many. Successful inlining and vectorization is not worth a note.
+    if (remark.kind == OptimizationRemark::Passed || !OptimizationRemarks::instance())
+        return true;
+
+    // Code inlined from the standard library refers to sources that are not
+    // installed. Existence is checked once per file, not per remark.
+    remark.file = absoluteFilePath(remark.file);
+    auto exists = m_existingFiles.find(remark.file);
+    if (exists == m_existingFiles.end())
+        exists = m_existingFiles.insert(remark.file, remark.file.exists());
+    if (exists.value())
+        OptimizationRemarks::instance()->addRemark(remark);
+    return true;
+}
+
+void CargoOutputParser::handleCompilerArtifact(const QJsonObject &object)
+{
+    CargoArtifact artifact;
+    parsePackageId(object.value("package_id").toString(),
+                   &artifact.packageName, &artifact.packageVersion);
+    const QJsonObject target = object.value("target").toObject();
+    artifact.targetName = target.value("name").toString();
+    for (const QJsonValue &kind : target.value("kind").toArray())
+        artifact.targetKinds.append(kind.toString());
+    artifact.sourcePath = FilePath::fromUserInput(target.value("src_path").toString());
+    const QString executable = object.value("executable").toString();
+    if (!executable.isEmpty())
+        artifact.executable = FilePath::fromUserInput(executable);
+    for (const QJsonValue &fileName : object.value("filenames").toArray())
+        artifact.fileNames.append(FilePath::fromUserInput(fileName.toString()));
+    artifact.fresh = object.value("fresh").toBool();
+    emit artifactFinished(artifact);
+}
+
+Task CargoOutputParser::createTask(Task::TaskType type,
+                                   const QString &summary,
+                                   const QJsonObject &span) const
+{
+    // Spans inside a macro expansion point into the macro definition
+    // ("<::std::macros::panic macros>"), walk up to the invocation site.
+    QJsonObject location = span;
+    while (location.value("file_name").toString().startsWith('<')) {
+        const QJsonObject expansion = location.value("expansion").toObject();
+        if (expansion.isEmpty())
+            break;
+        location = expansion.value("span").toObject();
+    }
+
+    const FilePath file = absoluteFilePath(
+        FilePath::fromUserInput(location.value("file_name").toString()));
+    Task task(type, summary, file, location.value("line_start").toInt(-1),
+              ProjectExplorer::Constants::TASK_CATEGORY_COMPILE);
+    task.column = location.value("column_start").toInt();
+    return task;
+}
+
+} // Rusty::Internal
@@ -0,0 +1,73 @@
+#ifndef CARGOOUTPUTPARSER_H
+#define CARGOOUTPUTPARSER_H
+
+#include <projectexplorer/ioutputparser.h>
+#include <projectexplorer/task.h>
+
+#include <utils/filepath.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+
+namespace Rusty::Internal {
+
+class CargoArtifact
+{
+public:
+    QString packageName;
+    QString packageVersion;
+    QString targetName;
+    QStringList targetKinds;
+    Utils::FilePath sourcePath;
+    Utils::FilePath executable;
+    Utils::FilePaths fileNames;
+    bool fresh = false;
+};
+
+void parsePackageId(const QString &packageId, QString *name, QString *version);
+
+/**
+ * @brief Parses the output of cargo invoked with --message-format=json
+ *
+ * Every line cargo prints on stdout is a self-contained JSON object, so the
+ * parser works incrementally on each line as it arrives from the process.
+ * Compiler diagnostics are turned into tasks which are deduplicated and
+ * handed to the TaskHub in batches by the RustTaskQueue, the JSON line itself
+ * is replaced by the human readable rendering rustc provides.
+ */
+class CargoOutputParser : public ProjectExplorer::OutputTaskParser
+{
+    Q_OBJECT
+
+public:
+    CargoOutputParser();
+
+signals:
+    // "Compiling foo v0.1.0 (...)" gives "foo" and "0.1.0".
+    void unitStarted(const QString &packageName, const QString &packageVersion);
+    void artifactFinished(const Rusty::Internal::CargoArtifact &artifact);
+    void lockWaitFinished(qint64 milliseconds);
+
+private:
+    Result handleLine(const QString &line, Utils::OutputFormat format) final;
+    void runPostPrintActions(QPlainTextEdit *edit) final;
+    void flush() final;
+
+    Result handleCompilerMessage(const QJsonObject &message);
+    bool handleOptimizationRemark(const QString &message);
+    void handleCompilerArtifact(const QJsonObject &artifact);
+    ProjectExplorer::Task createTask(ProjectExplorer::Task::TaskType type,
+                                     const QString &summary,
+                                     const QJsonObject &span) const;
+    void linkTask(const ProjectExplorer::Task &task, int outputLines);
+
+    QElapsedTimer m_lockWait;
+    // The tasks of the line being printed and the output lines they link to.
+    QList<QPair<ProjectExplorer::Task, int>> m_linkedTasks;
+    QHash<Utils::FilePath, bool> m_existingFiles;
+};
+
+} // Rusty::Internal
+
+#endif // CARGOOUTPUTPARSER_H
@@ -0,0 +1,260 @@
+#include "cargotimings.h"
+
+#include "rusttr.h"
+#include "rustutils.h"
+
+#include <utils/algorithm.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QThread>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+static QJsonArray embeddedArray(const QByteArray &html, const QByteArray &name)
+{
+    // cargo writes the data as "const UNIT_DATA = [ ... ];" into a script block.
+    const QByteArray marker = "const " + name + " = ";
+    const int start = html.indexOf(marker);
+    if (start < 0)
+        return {};
+    const int begin = start + marker.size();
+    const int end = html.indexOf("];", begin);
+    if (end < 0)
+        return {};
+    return QJsonDocument::fromJson(html.mid(begin, end - begin + 1)).array();
+}
+
+static QList<int> toIntList(const QJsonValue &value)
+{
+    QList<int> result;
+    for (const QJsonValue &entry : value.toArray())
+        result.append(entry.toInt());
+    return result;
+}
+
+static QJsonArray toJsonArray(const QList<int> &list)
+{
+    QJsonArray result;
+    for (const int entry : list)
+        result.append(entry);
+    return result;
+}
+
+double CargoTimingReport::criticalPathTime() const
+{
+    double result = 0;
+    for (const CargoUnitTiming &unit : units) {
+        if (unit.onCriticalPath)
+            result = qMax(result, unit.start + unit.duration);
+    }
+    return result;
+}
+
+double CargoTimingReport::utilization() const
+{
+    if (jobs <= 0 || concurrency.size() < 2 || totalTime <= 0)
+        return 0;
+    double busy = 0;
+    for (int i = 1; i < concurrency.size(); ++i) {
+        const CargoConcurrencySample &previous = concurrency.at(i - 1);
+        busy += previous.active * (concurrency.at(i).time - previous.time);
+    }
+    return busy / (jobs * totalTime);
+}
+
+void CargoTimingReport::computeCriticalPath()
+{
+    // A unit starts as soon as the last of its dependencies unlocked it. Walking
+    // back from the unit finishing last along those unlocks gives the chain of
+    // units that determined the wall time of the build.
+    QList<int> predecessor(units.size(), -1);
+    QList<double> unlockTime(units.size(), -1);
+    for (int i = 0; i < units.size(); ++i) {
+        const CargoUnitTiming &unit = units.at(i);
+        const auto unlock = [&](int index, double time) {
+            if (index < 0 || index >= units.size() || time <= unlockTime.at(index))
+                return;
+            unlockTime[index] = time;
+            predecessor[index] = i;
+        };
+        for (const int index : unit.unlocked)
+            unlock(index, unit.start + unit.duration);
+        for (const int index : unit.unlockedByRmeta)
+            unlock(index, unit.start + unit.frontend());
+    }
+
+    int current = -1;
+    double end = -1;
+    for (int i = 0; i < units.size(); ++i) {
+        const double unitEnd = units.at(i).start + units.at(i).duration;
+        if (unitEnd > end) {
+            end = unitEnd;
+            current = i;
+        }
+    }
+    while (current >= 0 && !units.at(current).onCriticalPath) {
+        units[current].onCriticalPath = true;
+        current = predecessor.at(current);
+    }
+}
+
+CargoTimingReport CargoTimingReport::fromCargoHtml(const FilePath &file, QString *errorMessage)
+{
+    CargoTimingReport report;
+    const expected_str<QByteArray> contents = file.fileContents();
+    if (!contents) {
+        *errorMessage = contents.error();
+        return report;
+    }
+
+    // Units refer to each other by their "i" field, map those to list positions.
+    QHash<int, int> positions;
+    const QJsonArray unitData = embeddedArray(*contents, "UNIT_DATA");
+    for (const QJsonValue &value : unitData) {
+        const QJsonObject object = value.toObject();
+        CargoUnitTiming unit;
+        unit.name = object.value("name").toString();
+        unit.version = object.value("version").toString();
+        unit.target = object.value("target").toString();
+        unit.start = object.value("start").toDouble();
+        unit.duration = object.value("duration").toDouble();
+        unit.rmetaTime = object.value("rmeta_time").toDouble(-1);
+        unit.unlocked = toIntList(object.value("unlocked_units"));
+        unit.unlockedByRmeta = toIntList(object.value("unlocked_rmeta_units"));
+        positions.insert(object.value("i").toInt(), report.units.size());
+        report.units.append(unit);
+        report.totalTime = qMax(report.totalTime, unit.start + unit.duration);
+    }
+    if (report.units.isEmpty()) {
+        *errorMessage = Tr::tr("No unit timings found in \"%1\".").arg(file.toUserOutput());
+        return report;
+    }
+    for (CargoUnitTiming &unit : report.units) {
+        const auto toPosition = [&positions](int index) { return positions.value(index, -1); };
+        unit.unlocked = Utils::transform(unit.unlocked, toPosition);
+        unit.unlockedByRmeta = Utils::transform(unit.unlockedByRmeta, toPosition);
+    }
+
+    for (const QJsonValue &value : embeddedArray(*contents, "CONCURRENCY_DATA")) {
+        const QJsonObject object = value.toObject();
+        report.concurrency.append({object.value("t").toDouble(),
+                                   object.value("active").toInt(),
+                                   object.value("waiting").toInt(),
+                                   object.value("inactive").toInt()});
+    }
+
+    static const QRegularExpression jobsPattern("jobs=(\\d+)");
+    const QRegularExpressionMatch match = jobsPattern.match(QString::fromUtf8(*contents));
+    report.jobs = match.hasMatch() ? match.captured(1).toInt() : QThread::idealThreadCount();
+    report.timestamp = file.lastModified();
+    report.computeCriticalPath();
+    return report;
+}
+
+QJsonObject CargoTimingReport::toJson() const
+{
+    QJsonArray unitArray;
+    for (const CargoUnitTiming &unit : units) {
+        unitArray.append(QJsonObject{{"name", unit.name},
+                                     {"version", unit.version},
+                                     {"target", unit.target},
+                                     {"start", unit.start},
+                                     {"duration", unit.duration},
+                                     {"rmeta_time", unit.rmetaTime},
+                                     {"unlocked", toJsonArray(unit.unlocked)},
+                                     {"unlocked_rmeta", toJsonArray(unit.unlockedByRmeta)},
+                                     {"critical", unit.onCriticalPath}});
+    }
+    QJsonArray concurrencyArray;
+    for (const CargoConcurrencySample &sample : concurrency) {
+        concurrencyArray.append(QJsonArray{sample.time, sample.active,
+                                           sample.waiting, sample.inactive});
+    }
+    return {{"timestamp", timestamp.toString(Qt::ISODate)},
+            {"configuration", configuration},
+            {"jobs", jobs},
+            {"total", totalTime},
+            {"units", unitArray},
+            {"concurrency", concurrencyArray}};
+}
+
+CargoTimingReport CargoTimingReport::fromJson(const QJsonObject &object)
+{
+    CargoTimingReport report;
+    report.timestamp = QDateTime::fromString(object.value("timestamp").toString(), Qt::ISODate);
+    report.configuration = object.value("configuration").toString();
+    report.jobs = object.value("jobs").toInt();
+    report.totalTime = object.value("total").toDouble();
+    for (const QJsonValue &value : object.value("units").toArray()) {
+        const QJsonObject unitObject = value.toObject();
+        CargoUnitTiming unit;
+        unit.name = unitObject.value("name").toString();
+        unit.version = unitObject.value("version").toString();
+        unit.target = unitObject.value("target").toString();
+        unit.start = unitObject.value("start").toDouble();
+        unit.duration = unitObject.value("duration").toDouble();
+        unit.rmetaTime = unitObject.value("rmeta_time").toDouble(-1);
+        unit.unlocked = toIntList(unitObject.value("unlocked"));
+        unit.unlockedByRmeta = toIntList(unitObject.value("unlocked_rmeta"));
+        unit.onCriticalPath = unitObject.value("critical").toBool();
+        report.units.append(unit);
+    }
+    for (const QJsonValue &value : object.value("concurrency").toArray()) {
+        const QJsonArray sample = value.toArray();
+        report.concurrency.append({sample.at(0).toDouble(), sample.at(1).toInt(),
+                                   sample.at(2).toInt(), sample.at(3).toInt()});
+    }
+    return report;
+}
+
+bool CargoTimingReport::save(const FilePath &file, QString *errorMessage) const
+{
+    if (!file.parentDir().ensureWritableDir()) {
+        *errorMessage = Tr::tr("Cannot create directory \"%1\".")
+                            .arg(file.parentDir().toUserOutput());
+        return false;
+    }
+    const expected_str<qint64> result
+        = file.writeFileContents(QJsonDocument(toJson()).toJson(QJsonDocument::Compact));
+    if (!result) {
+        *errorMessage = result.error();
+        return false;
+    }
+    return true;
+}
+
+CargoTimingReport CargoTimingReport::load(const FilePath &file, QString *errorMessage)
+{
+    const expected_str<QByteArray> contents = file.fileContents();
+    if (!contents) {
+        *errorMessage = contents.error();
+        return {};
+    }
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(*contents, &error);
+    if (doc.isNull()) {
+        *errorMessage = Tr::tr("Unable to parse \"%1\": %2")
+                            .arg(file.toUserOutput(), error.errorString());
+        return {};
+    }
+    return fromJson(doc.object());
+}
+
+FilePath timingReportsDirectory(const FilePath &projectDirectory)
+{
+    return rustyDataDirectory(projectDirectory).pathAppended("timings");
+}
+
+FilePaths storedTimingReports(const FilePath &projectDirectory)
+{
+    // File names are timestamps, the newest report comes first.
+    FilePaths reports = timingReportsDirectory(projectDirectory)
+                            .dirEntries({{"*.json"}, QDir::Files}, QDir::Name | QDir::Reversed);
+    return reports;
+}
+
+} // Rusty::Internal
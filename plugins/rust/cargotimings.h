@@ -0,0 +1,73 @@
+#ifndef CARGOTIMINGS_H
+#define CARGOTIMINGS_H
+
+#include <utils/filepath.h>
+
+#include <QDateTime>
+#include <QJsonObject>
+
+namespace Rusty::Internal {
+
+class CargoUnitTiming
+{
+public:
+    QString name;
+    QString version;
+    QString target; // " lib", " build script", " bin \"foo\"", ...
+    double start = 0;
+    double duration = 0;
+    double rmetaTime = -1; // End of the frontend, -1 if the unit has no metadata step.
+    QList<int> unlocked;
+    QList<int> unlockedByRmeta;
+    bool onCriticalPath = false;
+
+    double frontend() const { return rmetaTime < 0 ? duration : rmetaTime; }
+    double codegen() const { return rmetaTime < 0 ? 0 : duration - rmetaTime; }
+};
+
+class CargoConcurrencySample
+{
+public:
+    double time = 0;
+    int active = 0;
+    int waiting = 0;
+    int inactive = 0;
+};
+
+/**
+ * @brief Per-unit timings of one cargo build
+ *
+ * Filled from the data cargo embeds into the report written by
+ * "cargo build --timings" and stored as JSON below the project's
+ * .qtcreator directory, so runs can be compared later on.
+ */
+class CargoTimingReport
+{
+public:
+    QDateTime timestamp;
+    QString configuration;
+    int jobs = 0;
+    double totalTime = 0;
+    QList<CargoUnitTiming> units;
+    QList<CargoConcurrencySample> concurrency;
+
+    double criticalPathTime() const;
+    double utilization() const;
+
+    bool save(const Utils::FilePath &file, QString *errorMessage) const;
+
+    static CargoTimingReport fromCargoHtml(const Utils::FilePath &file, QString *errorMessage);
+    static CargoTimingReport load(const Utils::FilePath &file, QString *errorMessage);
+
+private:
+    void computeCriticalPath();
+    QJsonObject toJson() const;
+    static CargoTimingReport fromJson(const QJsonObject &object);
+};
+
+Utils::FilePath timingReportsDirectory(const Utils::FilePath &projectDirectory);
+Utils::FilePaths storedTimingReports(const Utils::FilePath &projectDirectory);
+
+} // Rusty::Internal
+
+#endif // CARGOTIMINGS_H
@@ -0,0 +1,253 @@
+#include "crateemit.h"
+
+#include "cargobuildscheduler.h"
+#include "rssidebuildconfiguration.h"
+#include "rusttr.h"
+#include "rustutils.h"
+
+#include <projectexplorer/project.h>
+#include <projectexplorer/projectmanager.h>
+#include <projectexplorer/target.h>
+
+#include <utils/process.h>
+
+#include <QDateTime>
+#include <QSet>
+
+#include <algorithm>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+static QString packageName(const FilePath &manifest)
+{
+    const expected_str<QByteArray> contents = manifest.fileContents();
+    if (!contents)
+        return {};
+    bool inPackage = false;
+    for (const QByteArray &rawLine : contents->split('\n')) {
+        const QString line = QString::fromUtf8(rawLine).trimmed();
+        if (line.startsWith('[')) {
+            inPackage = line == "[package]";
+            continue;
+        }
+        const int equals = line.indexOf('=');
+        if (inPackage && equals > 0 && line.left(equals).trimmed() == "name")
+            return line.mid(equals + 1).trimmed().remove('"');
+    }
+    return {};
+}
+
+// The package of a workspace member has a manifest of its own, the
+// workspace's root manifest may have no [package] at all.
+static FilePath packageDirectory(const FilePath &file, const FilePath &projectDirectory)
+{
+    for (FilePath directory = file.parentDir(); !directory.isEmpty();
+         directory = directory.parentDir()) {
+        const FilePath manifest = directory.pathAppended("Cargo.toml");
+        if (manifest.exists() && !packageName(manifest).isEmpty())
+            return directory;
+        if (directory == projectDirectory || directory.isRootPath())
+            break;
+    }
+    return {};
+}
+
+static QStringList cargoTargetArguments(const FilePath &package, const FilePath &file)
+{
+    const QStringList parts = file.relativeChildPath(package).path().split('/');
+    const auto targetName = [&parts](int index) {
+        return index == parts.size() - 1 ? FilePath::fromString(parts.at(index)).completeBaseName()
+                                         : parts.at(index);
+    };
+    if (parts.size() >= 2 && parts.first() == "examples")
+        return {"--example", targetName(1)};
+    if (parts.size() >= 2 && parts.first() == "tests")
+        return {"--test", targetName(1)};
+    if (parts.size() >= 2 && parts.first() == "benches")
+        return {"--bench", targetName(1)};
+    if (parts.size() >= 3 && parts.first() == "src" && parts.at(1) == "bin")
+        return {"--bin", targetName(2)};
+    if (package.pathAppended("src/lib.rs").exists() && parts != QStringList{"src", "main.rs"})
+        return {"--lib"};
+    return {"--bin", packageName(package.pathAppended("Cargo.toml"))};
+}
+
+std::optional<CrateEmitBuild> crateEmitBuild(const FilePath &sourceFile,
+                                             const QStringList &rustcArguments,
+                                             QString *errorMessage)
+{
+    Project *project = ProjectManager::projectForFile(sourceFile);
+    Target *target = project ? project->activeTarget() : nullptr;
+    auto bc = qobject_cast<RsSideBuildConfiguration *>(
+        target ? target->activeBuildConfiguration() : nullptr);
+    if (!bc) {
+        *errorMessage = Tr::tr("%1 is not part of a Rust project with an active build "
+                               "configuration.").arg(sourceFile.toUserOutput());
+        return {};
+    }
+    const FilePath package = packageDirectory(sourceFile, project->projectDirectory());
+    if (package.isEmpty()) {
+        *errorMessage = Tr::tr("No Cargo.toml with a [package] was found for %1.")
+                            .arg(sourceFile.toUserOutput());
+        return {};
+    }
+    const QStringList targetArguments = cargoTargetArguments(package, sourceFile);
+
+    CrateEmitBuild build;
+    build.command = CommandLine{detectCargo(sourceFile),
+                                {"rustc", "--manifest-path",
+                                 package.pathAppended("Cargo.toml").path()}};
+    build.command.addArgs(bc->cargoArguments());
+    build.command.addArgs(targetArguments);
+    build.command.addArg("--");
+    build.command.addArgs(rustcArguments);
+    build.environment = bc->environment();
+    build.workingDirectory = project->projectDirectory();
+    build.targetDirectory = bc->cargoTargetDirectory().pathAppended("emit");
+    build.environment.set("CARGO_TARGET_DIR", build.targetDirectory.path());
+    build.sourceFile = sourceFile;
+
+    // The profile is what changes the generated code: the cargo arguments and
+    // the overrides the build configuration sets in the environment.
+    QStringList profile = bc->cargoArguments();
+    QStringList variables = build.environment.toStringList();
+    variables.sort();
+    for (const QString &variable : std::as_const(variables)) {
+        if (variable.startsWith("CARGO_") || variable.startsWith("RUSTFLAGS="))
+            profile << variable;
+    }
+    build.key = QStringList{package.path(), targetArguments.join(' '),
+                            profile.join(' ')}.join('\n');
+    return build;
+}
+
+// The first rule of rustc's dep-info lists the outputs, the emitted file
+// among them, and the sources they were built from.
+static bool readDepInfo(const FilePath &depInfo, const QString &suffix,
+                        const FilePath &workingDirectory, FilePaths *sources)
+{
+    const expected_str<QByteArray> contents = depInfo.fileContents();
+    if (!contents)
+        return false;
+    for (const QByteArray &rawLine : contents->split('\n')) {
+        QString line = QString::fromUtf8(rawLine);
+        // Spaces in file names are escaped.
+        line.replace("\\ ", QString(QChar(0x1f)));
+        const qsizetype colon = line.indexOf(": ");
+        if (colon < 0)
+            continue;
+        const QStringList outputs = line.left(colon).split(' ', Qt::SkipEmptyParts);
+        if (std::none_of(outputs.cbegin(), outputs.cend(), [&suffix](const QString &output) {
+                return output.endsWith('.' + suffix);
+            })) {
+            continue;
+        }
+        const QStringList prerequisites = line.mid(colon + 2).split(' ', Qt::SkipEmptyParts);
+        for (QString prerequisite : prerequisites) {
+            prerequisite.replace(QChar(0x1f), ' ');
+            sources->append(workingDirectory.resolvePath(prerequisite).cleanPath());
+        }
+        return true;
+    }
+    return false;
+}
+
+// cargo rustc leaves the output in the deps directory of the profile, one
+// file per codegen unit, named after the crate and its metadata hash.
+static FilePaths findEmittedFiles(const CrateEmitBuild &build, const QString &suffix,
+                                  FilePaths *sources)
+{
+    const QDir::Filters subdirectories = QDir::Dirs | QDir::NoDotAndDotDot;
+    FilePaths depsDirectories;
+    for (const FilePath &directory : build.targetDirectory.dirEntries(subdirectories)) {
+        depsDirectories << directory.pathAppended("deps");
+        // Cross builds have the target triple in between.
+        for (const FilePath &profile : directory.dirEntries(subdirectories))
+            depsDirectories << profile.pathAppended("deps");
+    }
+
+    FilePath newestDepInfo;
+    QDateTime newest;
+    for (const FilePath &deps : std::as_const(depsDirectories)) {
+        if (!deps.isDir())
+            continue;
+        QSet<QString> stems;
+        for (const FilePath &emitted : deps.dirEntries(FileFilter({"*." + suffix}, QDir::Files)))
+            stems.insert(emitted.fileName().section('.', 0, 0));
+        for (const QString &stem : std::as_const(stems)) {
+            const FilePath depInfo = deps.pathAppended(stem + ".d");
+            const QDateTime modified = depInfo.lastModified();
+            if (!depInfo.exists() || (newest.isValid() && modified <= newest))
+                continue;
+            FilePaths depInfoSources;
+            if (readDepInfo(depInfo, suffix, build.workingDirectory, &depInfoSources)
+                && depInfoSources.contains(build.sourceFile)) {
+                newestDepInfo = depInfo;
+                newest = modified;
+                *sources = depInfoSources;
+            }
+        }
+    }
+    if (newestDepInfo.isEmpty())
+        return {};
+
+    // Codegen units of earlier builds may be left over, rustc writes the
+    // dep-info before any of the codegen output.
+    const QString stem = newestDepInfo.completeBaseName();
+    FilePaths result;
+    const FilePaths candidates = newestDepInfo.parentDir().dirEntries(
+        FileFilter({stem + '.' + suffix, stem + ".*." + suffix}, QDir::Files));
+    for (const FilePath &emitted : candidates) {
+        if (emitted.lastModified() >= newest)
+            result.append(emitted);
+    }
+    return result;
+}
+
+FilePaths runCrateEmitBuild(const CrateEmitBuild &build, const QString &suffix,
+                            const std::function<bool()> &isCanceled, FilePaths *sources,
+                            QString *errorMessage)
+{
+    Process process;
+    process.setCommand(build.command);
+    process.setEnvironment(build.environment);
+    process.setWorkingDirectory(build.workingDirectory);
+    CargoBuildScheduler *scheduler = CargoBuildScheduler::instance();
+    if (scheduler && !scheduler->backgroundCargoStarted()) {
+        *errorMessage = Tr::tr("Stale artifacts are being removed from the target directories, "
+                               "try again when that is done.");
+        return {};
+    }
+    process.start();
+    while (process.state() != QProcess::NotRunning) {
+        if (isCanceled()) {
+            process.kill();
+            process.waitForFinished();
+            break;
+        }
+        process.waitForReadyRead(100);
+    }
+    if (scheduler)
+        scheduler->backgroundCargoFinished();
+    if (isCanceled())
+        return {};
+    if (process.result() != ProcessResult::FinishedWithSuccess) {
+        // The error is at the end, after the warnings.
+        const QString error = process.cleanedStdErr().trimmed().section('\n', -20);
+        *errorMessage = Tr::tr("%1 failed: %2").arg(build.command.toUserOutput(), error);
+        return {};
+    }
+
+    const FilePaths files = findEmittedFiles(build, suffix, sources);
+    if (files.isEmpty()) {
+        *errorMessage = Tr::tr("The build emitted no .%1 file for %2. It may belong to another "
+                               "target of the package.")
+                            .arg(suffix, build.sourceFile.toUserOutput());
+    }
+    return files;
+}
+
+} // Rusty::Internal
@@ -0,0 +1,50 @@
+#ifndef CRATEEMIT_H
+#define CRATEEMIT_H
+
+#include <utils/commandline.h>
+#include <utils/environment.h>
+#include <utils/filepath.h>
+
+#include <functional>
+#include <optional>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief A cargo rustc run emitting intermediate compiler output of a crate
+ *
+ * Builds the package target containing a source file with the profile and
+ * flags of the active build configuration, plus rustc arguments like
+ * "--emit asm". cargo rustc passes those to a single target, it is picked by
+ * where the file is in the package's conventional layout.
+ *
+ * The build goes to the "emit" subdirectory of the configuration's target
+ * directory. With extra rustc flags it would otherwise overwrite the
+ * regular build's outputs, executables included, with the same metadata
+ * hash, and make the next regular build recompile the crate.
+ */
+class CrateEmitBuild
+{
+public:
+    Utils::CommandLine command;
+    Utils::Environment environment;
+    Utils::FilePath workingDirectory;   // Relative paths in rustc's output are based on it.
+    Utils::FilePath targetDirectory;
+    Utils::FilePath sourceFile;
+    QString key;                        // Package, target and profile, for caching results.
+};
+
+std::optional<CrateEmitBuild> crateEmitBuild(const Utils::FilePath &sourceFile,
+                                             const QStringList &rustcArguments,
+                                             QString *errorMessage);
+
+// Meant to run on a worker thread. Runs the build and returns the files with
+// the suffix emitted for the crate, one per codegen unit, and the crate's
+// sources. Returns nothing if the build failed or was canceled.
+Utils::FilePaths runCrateEmitBuild(const CrateEmitBuild &build, const QString &suffix,
+                                   const std::function<bool()> &isCanceled,
+                                   Utils::FilePaths *sources, QString *errorMessage);
+
+} // Rusty::Internal
+
+#endif // CRATEEMIT_H
@@ -0,0 +1,221 @@
+#include "dependencyprebuilder.h"
+
+#include "cargobuildscheduler.h"
+#include "rssidebuildconfiguration.h"
+#include "rusttr.h"
+#include "rustutils.h"
+
+#include <coreplugin/messagemanager.h>
+
+#include <projectexplorer/buildmanager.h>
+#include <projectexplorer/project.h>
+#include <projectexplorer/projectmanager.h>
+#include <projectexplorer/target.h>
+
+#include <utils/hostosinfo.h>
+#include <utils/process.h>
+
+#include <QCryptographicHash>
+#include <QRegularExpression>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+// git rewrites Cargo.lock once per merged commit during a pull or rebase.
+const int settleTimeMs = 3000;
+
+// Cargo runs the wrapper as "wrapper /path/to/rustc <arguments>" for units of
+// workspace members only. Queries like "rustc -vV" are passed through, as are
+// build scripts, whose output the dependencies may need.
+const char workspaceWrapperSource[] = R"script(#!/bin/sh
+rustc="$1"
+shift
+case " $* " in
+*" --crate-name build_script_"*) ;;
+*" --emit"*) echo "Not compiled by the dependency pre-build." >&2; exit 1 ;;
+esac
+exec "$rustc" "$@"
+)script";
+
+static FilePath workspaceWrapper(const FilePath &projectDirectory)
+{
+    const FilePath script = rustyDataDirectory(projectDirectory)
+                                .pathAppended("prebuild-workspace-wrapper.sh");
+    // A wrapper of an older version is replaced.
+    const expected_str<QByteArray> contents = script.fileContents();
+    if (contents && *contents == QByteArray(workspaceWrapperSource))
+        return script;
+    if (!script.parentDir().ensureWritableDir()
+        || !script.writeFileContents(workspaceWrapperSource)) {
+        return {};
+    }
+    script.setPermissions(script.permissions() | QFile::ExeOwner | QFile::ExeGroup
+                          | QFile::ExeOther);
+    return script;
+}
+
+DependencyPrebuilder::DependencyPrebuilder()
+{
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(settleTimeMs);
+    connect(&m_debounce, &QTimer::timeout, this, &DependencyPrebuilder::start);
+    connect(&m_watcher, &FileSystemWatcher::fileChanged,
+            this, &DependencyPrebuilder::lockFileChanged);
+    connect(ProjectManager::instance(), &ProjectManager::startupProjectChanged,
+            this, &DependencyPrebuilder::setProject);
+    connect(BuildManager::instance(), &BuildManager::buildStateChanged,
+            this, [this](Project *project) {
+                if (m_process && project == m_project && BuildManager::isBuilding(project))
+                    cancel();
+            });
+}
+
+DependencyPrebuilder::~DependencyPrebuilder() = default;
+
+void DependencyPrebuilder::setProject(Project *project)
+{
+    cancel();
+    m_debounce.stop();
+    m_watcher.clear();
+    m_lockFileHash.clear();
+    m_project = project;
+    if (!m_project || !HostOsInfo::isAnyUnixHost())
+        return;
+
+    const FilePath lockFile = m_project->projectDirectory().pathAppended("Cargo.lock");
+    if (const expected_str<QByteArray> contents = lockFile.fileContents())
+        m_lockFileHash = QCryptographicHash::hash(*contents, QCryptographicHash::Sha1);
+    m_watcher.addFile(lockFile, FileSystemWatcher::WatchModifiedDate);
+}
+
+void DependencyPrebuilder::lockFileChanged()
+{
+    if (!m_project)
+        return;
+
+    // git replaces the file instead of writing to it, which ends the watch.
+    const FilePath lockFile = m_project->projectDirectory().pathAppended("Cargo.lock");
+    m_watcher.removeFile(lockFile);
+    m_watcher.addFile(lockFile, FileSystemWatcher::WatchModifiedDate);
+
+    // Saving or touching the file without changes needs no pre-build.
+    const expected_str<QByteArray> contents = lockFile.fileContents();
+    if (!contents)
+        return;
+    const QByteArray hash = QCryptographicHash::hash(*contents, QCryptographicHash::Sha1);
+    if (hash == m_lockFileHash)
+        return;
+    m_lockFileHash = hash;
+    cancel();
+    m_debounce.start();
+}
+
+void DependencyPrebuilder::start()
+{
+    if (!m_project)
+        return;
+    if (BuildManager::isBuilding(m_project)) {
+        // The user's build is compiling the dependencies anyway.
+        return;
+    }
+    Target *target = m_project->activeTarget();
+    auto bc = qobject_cast<RsSideBuildConfiguration *>(target ? target->activeBuildConfiguration()
+                                                              : nullptr);
+    if (!bc || !bc->prebuildDependencies())
+        return;
+
+    Environment env = bc->environment();
+    const FilePath cargo = env.searchInPath("cargo");
+    const FilePath wrapper = workspaceWrapper(m_project->projectDirectory());
+    if (!cargo.isExecutableFile() || wrapper.isEmpty())
+        return;
+    env.set("RUSTC_WORKSPACE_WRAPPER", wrapper.path());
+    bc->ensureLinkTimer();
+
+    m_compiledDependencies.clear();
+    m_workspaceCompiled = false;
+    m_errors.clear();
+    m_dependencyFailed = false;
+    m_process.reset(new Process);
+    m_process->setLowPriority();
+    m_process->setEnvironment(env);
+    m_process->setWorkingDirectory(m_project->projectDirectory());
+    // Not --offline, right after a pull the new versions still need to be
+    // downloaded.
+    m_process->setCommand({cargo, QStringList{"build", "--keep-going"}
+                                      + bc->cargoArguments()});
+    const QString projectPath = m_project->projectDirectory().path();
+    m_process->setStdErrLineCallback([this, projectPath](const QString &line) {
+        // "Compiling foo v1.0.0" for registry, "Compiling foo v1.0.0 (/path)"
+        // for path and git dependencies.
+        static const QRegularExpression couldNotCompile("could not compile `([^`]+)`");
+        const QString trimmed = line.trimmed();
+        if (trimmed.startsWith("Compiling ")) {
+            if (trimmed.contains(projectPath))
+                m_workspaceCompiled = true;
+            else
+                m_compiledDependencies.insert(trimmed.section(' ', 1, 1));
+        } else if (trimmed.startsWith("error")) {
+            m_errors.append(trimmed);
+            const QRegularExpressionMatch match = couldNotCompile.match(trimmed);
+            if (match.hasMatch() && m_compiledDependencies.contains(match.captured(1)))
+                m_dependencyFailed = true;
+        }
+    });
+    connect(m_process.get(), &Process::done, this, &DependencyPrebuilder::finish);
+    CargoBuildScheduler *scheduler = CargoBuildScheduler::instance();
+    if (scheduler && !scheduler->backgroundCargoStarted()) {
+        // The target directories are pruned, tried again once that is done.
+        m_process.reset();
+        m_debounce.start();
+        return;
+    }
+    Core::MessageManager::writeSilently(
+        Tr::tr("Cargo.lock changed, pre-building the dependencies of \"%1\" (%2).")
+            .arg(m_project->displayName(), bc->displayName()));
+    m_process->start();
+}
+
+void DependencyPrebuilder::cancel()
+{
+    if (!m_process)
+        return;
+    m_process->disconnect(this);
+    m_process.reset();
+    if (CargoBuildScheduler *scheduler = CargoBuildScheduler::instance())
+        scheduler->backgroundCargoFinished();
+    Core::MessageManager::writeSilently(Tr::tr("Dependency pre-build cancelled."));
+}
+
+void DependencyPrebuilder::finish()
+{
+    // Workspace members always "fail" in the wrapper. Cargo failing before it
+    // got to them, e.g. resolving or downloading, or a dependency failing to
+    // compile is a real failure.
+    const bool failed = m_process->result() != ProcessResult::FinishedWithSuccess
+                        && (!m_workspaceCompiled || m_dependencyFailed);
+    if (m_process->error() == QProcess::FailedToStart) {
+        Core::MessageManager::writeSilently(
+            Tr::tr("Dependency pre-build failed: %1").arg(m_process->errorString()));
+    } else if (failed) {
+        Core::MessageManager::writeSilently(
+            Tr::tr("Dependency pre-build failed:") + '\n' + m_errors.join('\n'));
+    } else {
+        Core::MessageManager::writeSilently(
+            Tr::tr("Dependency pre-build finished, %n dependencies compiled.", nullptr,
+                   int(m_compiledDependencies.size())));
+    }
+    m_process.release()->deleteLater();
+    if (CargoBuildScheduler *scheduler = CargoBuildScheduler::instance())
+        scheduler->backgroundCargoFinished();
+
+    // Links of build scripts and proc macros are not the user's build.
+    if (Target *target = m_project ? m_project->activeTarget() : nullptr) {
+        if (auto bc = qobject_cast<RsSideBuildConfiguration *>(target->activeBuildConfiguration()))
+            bc->takeLinkTimes();
+    }
+}
+
+} // Rusty::Internal
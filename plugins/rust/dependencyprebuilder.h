@@ -0,0 +1,56 @@
+#ifndef DEPENDENCYPREBUILDER_H
+#define DEPENDENCYPREBUILDER_H
+
+#include <utils/filesystemwatcher.h>
+
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+
+#include <memory>
+
+namespace ProjectExplorer { class Project; }
+namespace Utils { class Process; }
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Builds updated dependencies in the background after Cargo.lock changed
+ *
+ * Watches Cargo.lock of the startup project. Once it has settled, the active
+ * build configuration is built at low priority with cargo build
+ * --keep-going and a RUSTC_WORKSPACE_WRAPPER which refuses to compile the
+ * workspace members (their build scripts excepted). Dependencies therefore
+ * end up with exactly the features, flags and target directory of a real
+ * build, while the workspace crates are left for the user's build.
+ *
+ * The pre-build is cancelled as soon as a build of the project starts, it
+ * would only keep the user's build waiting for cargo's directory lock.
+ */
+class DependencyPrebuilder : public QObject
+{
+public:
+    DependencyPrebuilder();
+    ~DependencyPrebuilder() override;
+
+private:
+    void setProject(ProjectExplorer::Project *project);
+    void lockFileChanged();
+    void start();
+    void cancel();
+    void finish();
+
+    QPointer<ProjectExplorer::Project> m_project;
+    Utils::FileSystemWatcher m_watcher;
+    QTimer m_debounce;
+    QByteArray m_lockFileHash;
+    std::unique_ptr<Utils::Process> m_process;
+    QSet<QString> m_compiledDependencies;
+    bool m_workspaceCompiled = false;
+    QStringList m_errors;
+    bool m_dependencyFailed = false;
+};
+
+} // Rusty::Internal
+
+#endif // DEPENDENCYPREBUILDER_H
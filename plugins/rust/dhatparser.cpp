@@ -0,0 +1,409 @@
+#include "dhatparser.h"
+
+#include "resultutils.h"
+#include "rustdemangle.h"
+#include "rusttr.h"
+
+#include <QFile>
+#include <QRegularExpression>
+
+#include <cctype>
+#include <functional>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+/**
+ * Pull tokenizer over a JSON document, reads the device in chunks. DHAT
+ * writes a few hundred bytes per allocation point, the files of a long run
+ * easily exceed what QJsonDocument should be given at once.
+ */
+class JsonTokenizer
+{
+public:
+    enum Token {
+        BeginObject,
+        EndObject,
+        BeginArray,
+        EndArray,
+        Colon,
+        Comma,
+        String,
+        Number,
+        Literal,    // true, false, null
+        End,
+        Invalid
+    };
+
+    explicit JsonTokenizer(QIODevice *device)
+        : m_device(device)
+    {}
+
+    Token next();
+    // Consumes the rest of a value whose first token was first.
+    bool skipValue(Token first);
+
+    const QString &string() const { return m_string; }
+    double number() const { return m_number; }
+
+private:
+    int peek();
+    int get();
+    int getCodeUnit();  // The four hex digits of a \u escape, -1 if invalid.
+
+    QIODevice *m_device = nullptr;
+    QByteArray m_buffer;
+    qsizetype m_position = 0;
+    QString m_string;
+    QByteArray m_utf8;
+    double m_number = 0;
+};
+
+int JsonTokenizer::peek()
+{
+    if (m_position >= m_buffer.size()) {
+        m_buffer = m_device->read(1 << 16);
+        m_position = 0;
+        if (m_buffer.isEmpty())
+            return -1;
+    }
+    return static_cast<unsigned char>(m_buffer.at(m_position));
+}
+
+int JsonTokenizer::get()
+{
+    const int c = peek();
+    if (c >= 0)
+        ++m_position;
+    return c;
+}
+
+int JsonTokenizer::getCodeUnit()
+{
+    QByteArray hex;
+    for (int i = 0; i < 4; ++i)
+        hex.append(char(get()));
+    bool ok = false;
+    const ushort unit = hex.toUShort(&ok, 16);
+    return ok ? unit : -1;
+}
+
+JsonTokenizer::Token JsonTokenizer::next()
+{
+    int c = get();
+    while (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+        c = get();
+    switch (c) {
+    case -1: return End;
+    case '{': return BeginObject;
+    case '}': return EndObject;
+    case '[': return BeginArray;
+    case ']': return EndArray;
+    case ':': return Colon;
+    case ',': return Comma;
+    case '"': {
+        m_utf8.clear();
+        for (c = get(); c != '"'; c = get()) {
+            if (c < 0)
+                return Invalid;
+            if (c != '\\') {
+                m_utf8.append(char(c));
+                continue;
+            }
+            switch (c = get()) {
+            case 'b': m_utf8.append('\b'); break;
+            case 'f': m_utf8.append('\f'); break;
+            case 'n': m_utf8.append('\n'); break;
+            case 'r': m_utf8.append('\r'); break;
+            case 't': m_utf8.append('\t'); break;
+            case 'u': {
+                const int unit = getCodeUnit();
+                if (unit < 0 || QChar::isLowSurrogate(char32_t(unit)))
+                    return Invalid;
+                char32_t code = char32_t(unit);
+                // Characters beyond the BMP are escaped as a surrogate pair.
+                if (QChar::isHighSurrogate(code)) {
+                    if (get() != '\\' || get() != 'u')
+                        return Invalid;
+                    const int low = getCodeUnit();
+                    if (low < 0 || !QChar::isLowSurrogate(char32_t(low)))
+                        return Invalid;
+                    code = QChar::surrogateToUcs4(char16_t(unit), char16_t(low));
+                }
+                m_utf8.append(QString::fromUcs4(&code, 1).toUtf8());
+                break;
+            }
+            default:
+                if (c < 0)
+                    return Invalid;
+                m_utf8.append(char(c)); // '"', '\\', '/'
+            }
+        }
+        m_string = QString::fromUtf8(m_utf8);
+        return String;
+    }
+    default:
+        break;
+    }
+
+    QByteArray text(1, char(c));
+    for (c = peek(); c >= 0 && (std::isalnum(c) || c == '-' || c == '+' || c == '.'); c = peek())
+        text.append(char(get()));
+    if (text == "true" || text == "false" || text == "null") {
+        m_number = text == "true" ? 1 : 0;
+        return Literal;
+    }
+    bool ok = false;
+    m_number = text.toDouble(&ok);
+    return ok ? Number : Invalid;
+}
+
+bool JsonTokenizer::skipValue(Token first)
+{
+    if (first != BeginObject && first != BeginArray)
+        return first == String || first == Number || first == Literal;
+    int depth = 1;
+    while (depth > 0) {
+        switch (next()) {
+        case BeginObject:
+        case BeginArray:
+            ++depth;
+            break;
+        case EndObject:
+        case EndArray:
+            --depth;
+            break;
+        case End:
+        case Invalid:
+            return false;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+// One entry of "pps", the allocations made from one stack.
+class AllocationPoint
+{
+public:
+    QList<int> frames;      // Into "ftbl", innermost first.
+    qint64 blocks = 0;
+    qint64 bytes = 0;
+    qint64 maxBytes = 0;
+    qint64 bytesAtPeak = 0;
+    double lifetimes = 0;
+};
+
+class DhatFrame
+{
+public:
+    QString function;
+    FilePath file;
+    int line = -1;
+};
+
+static DhatFrame parseFrame(const QString &text, const FilePath &projectDirectory)
+{
+    // "0x10919B: app::parse (/home/me/app/src/main.rs:12)",
+    // "0x4C2B0F3: malloc (in /usr/libexec/valgrind/vgpreload_dhat-amd64-linux.so)"
+    static const QRegularExpression frame(
+        R"(^0x[0-9A-Fa-f]+: (.*?)(?: \((in )?(.*?)(?::(\d+))?\))?$)");
+    DhatFrame result;
+    const QRegularExpressionMatch match = frame.match(text);
+    if (!match.hasMatch()) {
+        result.function = text; // "[root]"
+        return result;
+    }
+    result.function = match.captured(1);
+    if (mayContainRustSymbol(result.function))
+        result.function = demangleRustSymbols(result.function);
+    if (match.capturedLength(2) == 0 && match.capturedLength(4) > 0) {
+        result.file = projectDirectory.resolvePath(match.captured(3));
+        result.line = match.captured(4).toInt();
+    }
+    return result;
+}
+
+static bool readObject(JsonTokenizer &json, const std::function<bool(const QString &)> &readValue)
+{
+    for (JsonTokenizer::Token token = json.next(); token != JsonTokenizer::EndObject;
+         token = json.next()) {
+        if (token == JsonTokenizer::Comma)
+            continue;
+        if (token != JsonTokenizer::String)
+            return false;
+        const QString key = json.string();
+        if (json.next() != JsonTokenizer::Colon || !readValue(key))
+            return false;
+    }
+    return true;
+}
+
+static bool readAllocationPoint(JsonTokenizer &json, JsonTokenizer::Token first,
+                                AllocationPoint *point)
+{
+    if (first != JsonTokenizer::BeginObject)
+        return false;
+    return readObject(json, [&json, point](const QString &key) {
+        const JsonTokenizer::Token token = json.next();
+        if (key == "fs" && token == JsonTokenizer::BeginArray) {
+            for (JsonTokenizer::Token frame = json.next(); frame != JsonTokenizer::EndArray;
+                 frame = json.next()) {
+                if (frame == JsonTokenizer::Number)
+                    point->frames.append(int(json.number()));
+                else if (frame != JsonTokenizer::Comma)
+                    return false;
+            }
+            return true;
+        }
+        if (token != JsonTokenizer::Number)
+            return json.skipValue(token); // "acc", the access histogram.
+        const double value = json.number();
+        if (key == "tbk")
+            point->blocks = qint64(value);
+        else if (key == "tb")
+            point->bytes = qint64(value);
+        else if (key == "mb")
+            point->maxBytes = qint64(value);
+        else if (key == "gb")
+            point->bytesAtPeak = qint64(value);
+        else if (key == "tl")
+            point->lifetimes = value;
+        return true;
+    });
+}
+
+static void summarize(HeapProfile &profile, const QList<AllocationPoint> &points,
+                      const QStringList &frameTable, const FilePath &projectDirectory)
+{
+    QList<DhatFrame> frames;
+    frames.reserve(frameTable.size());
+    for (const QString &frame : frameTable)
+        frames.append(parseFrame(frame, projectDirectory));
+
+    const auto callSiteFrame = [&frames, &projectDirectory](const AllocationPoint &point) {
+        int fallback = -1;
+        for (int index : point.frames) {
+            if (index < 0 || index >= frames.size() || frames.at(index).file.isEmpty())
+                continue;
+            if (frames.at(index).file.isChildOf(projectDirectory))
+                return index;
+            if (fallback < 0)
+                fallback = index;
+        }
+        return fallback >= 0 ? fallback : point.frames.value(0, 0);
+    };
+
+    QHash<QPair<FilePath, int>, int> siteIndex;
+    QHash<QString, int> siteIndexWithoutFile;
+    QList<qint64> largestPoint;
+    for (const AllocationPoint &point : points) {
+        const int frameIndex = callSiteFrame(point);
+        const DhatFrame frame = frames.value(frameIndex);
+        int &index = frame.file.isEmpty() ? siteIndexWithoutFile[frame.function]
+                                          : siteIndex[{frame.file, frame.line}];
+        if (index == 0) {
+            HeapCallSite site;
+            site.function = frame.function;
+            site.file = frame.file;
+            site.line = frame.line;
+            profile.callSites.append(site);
+            largestPoint.append(-1);
+            index = profile.callSites.size(); // One based, 0 is "not yet".
+        }
+        HeapCallSite &site = profile.callSites[index - 1];
+        site.blocks += point.blocks;
+        site.bytes += point.bytes;
+        site.bytesAtPeak += point.bytesAtPeak;
+        site.maxLiveBytes += point.maxBytes;
+        site.totalLifetime += point.lifetimes;
+        // The lifetimes of single blocks are not in the file, an allocation
+        // point counts as short-lived as a whole, as in DHAT's own viewer.
+        if (point.blocks > 0 && point.lifetimes / point.blocks < profile.shortLivedThreshold)
+            site.shortLivedBlocks += point.blocks;
+        if (point.bytes > largestPoint.at(index - 1)) {
+            largestPoint[index - 1] = point.bytes;
+            site.stack.clear();
+            const int first = int(point.frames.indexOf(frameIndex));
+            for (int i = qMax(0, first); i < point.frames.size() && site.stack.size() < 30; ++i)
+                site.stack.append(frames.value(point.frames.at(i)).function);
+        }
+
+        profile.blocks += point.blocks;
+        profile.bytes += point.bytes;
+        profile.bytesAtPeak += point.bytesAtPeak;
+    }
+}
+
+void loadDhatProfile(QPromise<HeapProfile> &promise, const FilePath &dhatFile,
+                     const FilePath &projectDirectory)
+{
+    QFile file(dhatFile.toFSPathString());
+    if (!file.open(QIODevice::ReadOnly)) {
+        reportWorkerFailure(promise, Tr::tr("Cannot open %1.").arg(dhatFile.toUserOutput()));
+        return;
+    }
+
+    HeapProfile profile;
+    QList<AllocationPoint> points;
+    QStringList frameTable;
+    JsonTokenizer json(&file);
+    const bool ok = json.next() == JsonTokenizer::BeginObject
+        && readObject(json, [&](const QString &key) {
+        const JsonTokenizer::Token token = json.next();
+        if (key == "pps" && token == JsonTokenizer::BeginArray) {
+            // A program that never allocated has no points at all.
+            for (JsonTokenizer::Token entry = json.next(); entry != JsonTokenizer::EndArray;
+                 entry = json.next()) {
+                if (promise.isCanceled())
+                    return false;
+                if (entry == JsonTokenizer::Comma)
+                    continue;
+                AllocationPoint point;
+                if (!readAllocationPoint(json, entry, &point))
+                    return false;
+                points.append(point);
+            }
+            return true;
+        }
+        if (key == "ftbl" && token == JsonTokenizer::BeginArray) {
+            for (JsonTokenizer::Token entry = json.next(); entry != JsonTokenizer::EndArray;
+                 entry = json.next()) {
+                if (entry == JsonTokenizer::String)
+                    frameTable.append(json.string());
+                else if (entry != JsonTokenizer::Comma)
+                    return false;
+            }
+            return true;
+        }
+        if (key == "cmd" && token == JsonTokenizer::String)
+            profile.command = json.string();
+        else if (key == "tu" && token == JsonTokenizer::String)
+            profile.timeUnit = json.string();
+        else if (key == "tuth" && token == JsonTokenizer::Number)
+            profile.shortLivedThreshold = qint64(json.number());
+        else if (key == "te" && token == JsonTokenizer::Number)
+            profile.totalTime = qint64(json.number());
+        else if (key == "tg" && token == JsonTokenizer::Number)
+            profile.peakTime = qint64(json.number());
+        return json.skipValue(token);
+    });
+    if (promise.isCanceled())
+        return;
+    if (!ok) {
+        reportWorkerFailure(promise, Tr::tr("%1 is not a DHAT heap profile.")
+                                         .arg(dhatFile.toUserOutput()));
+        return;
+    }
+
+    summarize(profile, points, frameTable, projectDirectory);
+    if (profile.callSites.isEmpty()) {
+        reportWorkerFailure(promise, Tr::tr("The program did not allocate any memory."));
+        return;
+    }
+    promise.addResult(profile);
+}
+
+} // Rusty::Internal
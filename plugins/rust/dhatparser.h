@@ -0,0 +1,52 @@
+#ifndef DHATPARSER_H
+#define DHATPARSER_H
+
+#include <utils/filepath.h>
+
+#include <QPromise>
+
+namespace Rusty::Internal {
+
+// The allocations made from one line of code, summed over all stacks
+// leading to it.
+class HeapCallSite
+{
+public:
+    QString function;
+    Utils::FilePath file;
+    int line = -1;
+    QStringList stack;          // Of the largest allocation point, call site first.
+    qint64 blocks = 0;
+    qint64 bytes = 0;
+    qint64 bytesAtPeak = 0;     // Live at the moment the whole heap peaked.
+    qint64 maxLiveBytes = 0;    // Sum of the allocation points' maxima.
+    qint64 shortLivedBlocks = 0;
+    double totalLifetime = 0;   // In HeapProfile::timeUnit.
+
+    double averageLifetime() const { return blocks > 0 ? totalLifetime / blocks : 0; }
+};
+
+class HeapProfile
+{
+public:
+    QString command;
+    QString timeUnit;           // "instrs" unless DHAT measured something else.
+    qint64 shortLivedThreshold = 0;
+    qint64 totalTime = 0;
+    qint64 peakTime = 0;        // When the heap was largest.
+    qint64 blocks = 0;
+    qint64 bytes = 0;
+    qint64 bytesAtPeak = 0;
+    QList<HeapCallSite> callSites;
+};
+
+// Reads the JSON written by valgrind --tool=dhat in chunks, without holding
+// the whole document, and sums up the allocation points by the innermost
+// frame inside projectDirectory. Allocations without such a frame go to
+// the innermost frame with a source file. Meant to run on a worker thread.
+void loadDhatProfile(QPromise<HeapProfile> &promise, const Utils::FilePath &dhatFile,
+                     const Utils::FilePath &projectDirectory);
+
+} // Rusty::Internal
+
+#endif // DHATPARSER_H
@@ -0,0 +1,226 @@
+#include "flamegraph.h"
+
+#include "benchmark.h"
+#include "rusttr.h"
+
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QPainter>
+#include <QToolTip>
+
+#include <climits>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+// Frames narrower than this are not drawn, neither are their callees.
+const double minimumFrameWidth = 1.0;
+
+QString sampleShare(const ProfileData &profile, qint64 samples)
+{
+    const double share = profile.totalSamples > 0 ? 100.0 * samples / profile.totalSamples : 0.0;
+    if (profile.weight == ProfileData::Weight::BlockedMicroseconds)
+        return Tr::tr("%1 % (%2)").arg(share, 0, 'f', 2).arg(formatDuration(samples * 1e-6));
+    return Tr::tr("%1 % (%n samples)", nullptr, int(qMin<qint64>(samples, INT_MAX)))
+        .arg(share, 0, 'f', 2);
+}
+
+FlameGraphWidget::FlameGraphWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setMouseTracking(true);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+}
+
+void FlameGraphWidget::setProfile(const std::shared_ptr<const ProfileData> &profile,
+                                  const FilePath &projectDirectory)
+{
+    m_profile = profile;
+    m_projectDirectory = projectDirectory;
+    m_zoomNode = 0;
+    m_deltas.clear();
+
+    // Children always come after their parent in the node list.
+    m_depths.clear();
+    int maxDepth = 0;
+    if (m_profile) {
+        const std::vector<CallTreeNode> &nodes = m_profile->callTree.nodes();
+        m_depths.reserve(int(nodes.size()));
+        for (const CallTreeNode &node : nodes) {
+            const int depth = node.parent < 0 ? 0 : m_depths.at(node.parent) + 1;
+            m_depths.append(depth);
+            maxDepth = qMax(maxDepth, depth);
+        }
+    }
+    setFixedHeight((maxDepth + 1) * rowHeight());
+    update();
+}
+
+void FlameGraphWidget::setNodeDeltas(const QList<double> &deltas)
+{
+    m_deltas = deltas;
+    m_maxDelta = 0;
+    for (double delta : deltas)
+        m_maxDelta = qMax(m_maxDelta, qAbs(delta));
+    update();
+}
+
+QSize FlameGraphWidget::sizeHint() const
+{
+    return {800, height()};
+}
+
+int FlameGraphWidget::rowHeight() const
+{
+    return fontMetrics().height() + 4;
+}
+
+QString FlameGraphWidget::label(int node) const
+{
+    if (node == 0)
+        return Tr::tr("all");
+    return m_profile->frames.at(m_profile->callTree.node(node).frame).symbol;
+}
+
+QColor FlameGraphWidget::colorFor(int node) const
+{
+    if (node == 0)
+        return palette().color(QPalette::Mid);
+
+    if (!m_deltas.isEmpty()) {
+        const double delta = m_deltas.value(node);
+        const double strength = m_maxDelta > 0 ? qAbs(delta) / m_maxDelta : 0;
+        const QColor neutral(235, 235, 235);
+        const QColor target = delta > 0 ? QColor(230, 60, 40) : QColor(60, 110, 230);
+        const auto mix = [strength](int from, int to) {
+            return from + int((to - from) * strength);
+        };
+        return QColor(mix(neutral.red(), target.red()), mix(neutral.green(), target.green()),
+                      mix(neutral.blue(), target.blue()));
+    }
+
+    // Stable colors per function, so the same function is recognized across
+    // the graph and across profiles.
+    const ProfileFrame &frame = m_profile->frames.at(m_profile->callTree.node(node).frame);
+    const uint hash = qHash(frame.symbol);
+    if (!frame.file.isEmpty() && frame.file.isChildOf(m_projectDirectory))
+        return QColor::fromHsv(int(hash % 30), 190 + int(hash % 50), 230);
+    return QColor::fromHsv(35 + int(hash % 25), 120 + int(hash % 60), 230);
+}
+
+void FlameGraphWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    m_drawnNodes.clear();
+    if (!m_profile || m_profile->callTree.root().samples == 0)
+        return;
+
+    const CallTree &tree = m_profile->callTree;
+    const int row = rowHeight();
+    const auto drawNode = [&](int node, double x, double width) {
+        const QRectF frameRect(x, height() - (m_depths.at(node) + 1) * row, width, row);
+        painter.fillRect(frameRect.adjusted(0, 0, -1, -1), colorFor(node));
+        if (width > 3 * painter.fontMetrics().averageCharWidth()) {
+            painter.setPen(Qt::black);
+            const QRectF textRect = frameRect.adjusted(3, 0, -3, -1);
+            painter.drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter,
+                             painter.fontMetrics().elidedText(label(node), Qt::ElideRight,
+                                                              int(textRect.width())));
+        }
+        m_drawnNodes.append({frameRect, node});
+    };
+
+    // The callers of the zoomed frame span the whole width below it.
+    for (int node = tree.node(m_zoomNode).parent; node >= 0; node = tree.node(node).parent)
+        drawNode(node, 0, width());
+
+    struct Pending { int node; double x; double width; };
+    QList<Pending> pending{{m_zoomNode, 0, double(width())}};
+    while (!pending.isEmpty()) {
+        const Pending current = pending.takeLast();
+        drawNode(current.node, current.x, current.width);
+        const CallTreeNode &node = tree.node(current.node);
+        double x = current.x;
+        for (int child : node.children) {
+            const double width = current.width * tree.node(child).samples / node.samples;
+            if (width >= minimumFrameWidth)
+                pending.append({child, x, width});
+            x += width;
+        }
+    }
+}
+
+int FlameGraphWidget::nodeAt(const QPoint &pos) const
+{
+    for (const auto &[frameRect, node] : m_drawnNodes) {
+        if (frameRect.contains(pos))
+            return node;
+    }
+    return -1;
+}
+
+void FlameGraphWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    const int node = nodeAt(event->position().toPoint());
+    if (node < 0) {
+        QToolTip::hideText();
+        return;
+    }
+    const CallTreeNode &treeNode = m_profile->callTree.node(node);
+    QStringList lines{label(node)};
+    if (node > 0) {
+        const ProfileFrame &frame = m_profile->frames.at(treeNode.frame);
+        if (!frame.module.isEmpty())
+            lines << Tr::tr("in %1").arg(frame.module);
+        if (!frame.file.isEmpty())
+            lines << QString("%1:%2").arg(frame.file.toUserOutput()).arg(frame.hottestLine());
+    }
+    lines << Tr::tr("Total: %1").arg(sampleShare(*m_profile, treeNode.samples));
+    if (treeNode.selfSamples > 0)
+        lines << Tr::tr("Self: %1").arg(sampleShare(*m_profile, treeNode.selfSamples));
+    if (!m_deltas.isEmpty()) {
+        lines << Tr::tr("Change: %1%2 percentage points")
+                     .arg(m_deltas.value(node) > 0 ? "+" : "")
+                     .arg(100 * m_deltas.value(node), 0, 'f', 2);
+    }
+    QToolTip::showText(event->globalPosition().toPoint(), lines.join('\n'), this);
+}
+
+void FlameGraphWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton)
+        return;
+    const int node = nodeAt(event->position().toPoint());
+    if (node > 0)
+        emit frameActivated(m_profile->callTree.node(node).frame);
+}
+
+void FlameGraphWidget::contextMenuEvent(QContextMenuEvent *event)
+{
+    const int node = nodeAt(event->pos());
+    QMenu menu;
+    if (node > 0 && node != m_zoomNode) {
+        menu.addAction(Tr::tr("Zoom Into \"%1\"").arg(label(node)), this, [this, node] {
+            zoomTo(node);
+        });
+    }
+    if (m_zoomNode != 0)
+        menu.addAction(Tr::tr("Reset Zoom"), this, [this] { zoomTo(0); });
+    if (node > 0) {
+        menu.addAction(Tr::tr("Open Source"), this, [this, node] {
+            emit frameActivated(m_profile->callTree.node(node).frame);
+        });
+    }
+    if (!menu.isEmpty())
+        menu.exec(event->globalPos());
+}
+
+void FlameGraphWidget::zoomTo(int node)
+{
+    m_zoomNode = node;
+    update();
+}
+
+} // Rusty::Internal
@@ -0,0 +1,70 @@
+#ifndef FLAMEGRAPH_H
+#define FLAMEGRAPH_H
+
+#include "profiledata.h"
+
+#include <QWidget>
+
+#include <memory>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Paints the call tree of a profile as flame graph
+ *
+ * The root spans the whole width at the bottom, callees are stacked on top of
+ * their callers with a width proportional to their inclusive samples. Frames
+ * of the project's own code are drawn in warmer colors than those of the
+ * standard library and dependencies.
+ *
+ * With node deltas set, as for the differential flame graph, frames are
+ * colored by how their share of the samples changed instead: red for frames
+ * that got more expensive, blue for those that got cheaper.
+ *
+ * A click on a frame emits frameActivated(), the context menu zooms into a
+ * frame and out again.
+ */
+class FlameGraphWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FlameGraphWidget(QWidget *parent = nullptr);
+
+    void setProfile(const std::shared_ptr<const ProfileData> &profile,
+                    const Utils::FilePath &projectDirectory);
+    // Per call tree node, the change of its share of all samples.
+    void setNodeDeltas(const QList<double> &deltas);
+
+    QSize sizeHint() const override;
+
+signals:
+    void frameActivated(int frame);
+
+private:
+    void paintEvent(QPaintEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+    int rowHeight() const;
+    int nodeAt(const QPoint &pos) const;
+    QString label(int node) const;
+    QColor colorFor(int node) const;
+    void zoomTo(int node);
+
+    std::shared_ptr<const ProfileData> m_profile;
+    Utils::FilePath m_projectDirectory;
+    int m_zoomNode = 0;
+    QList<int> m_depths;
+    QList<double> m_deltas;
+    double m_maxDelta = 0;
+    QList<QPair<QRectF, int>> m_drawnNodes; // Filled while painting, for hit tests.
+};
+
+// "12.3 % (1234 samples)", "12.3 % (45.6 ms)" for off-CPU profiles.
+QString sampleShare(const ProfileData &profile, qint64 samples);
+
+} // Rusty::Internal
+
+#endif // FLAMEGRAPH_H
@@ -0,0 +1,152 @@
+#include "heapprofiler.h"
+
+#include "benchmark.h"
+#include "dhatparser.h"
+#include "heapprofileview.h"
+#include "profiledprogram.h"
+#include "rustyconstants.h"
+#include "rusttr.h"
+#include "rustutils.h"
+#include "sourceannotations.h"
+
+#include <coreplugin/icore.h>
+#include <coreplugin/messagemanager.h>
+#include <coreplugin/progressmanager/progressmanager.h>
+
+#include <extensionsystem/pluginmanager.h>
+
+#include <projectexplorer/project.h>
+
+#include <utils/async.h>
+#include <utils/futuresynchronizer.h>
+
+#include <QDateTime>
+
+#include <climits>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const char dhatTaskId[] = "Rusty.Dhat";
+const char heapAnnotationsId[] = "Rusty.HeapAllocations";
+
+// Call sites below both shares are not annotated.
+const double minimumBlockShare = 0.001;
+const double minimumByteShare = 0.01;
+
+static SourceAnnotationMap callSiteAnnotations(const HeapProfile &profile)
+{
+    qint64 mostBlocks = 1;
+    QHash<QString, QPair<int, qint64>> functions; // Call sites and blocks per function.
+    for (const HeapCallSite &site : profile.callSites) {
+        mostBlocks = qMax(mostBlocks, site.blocks);
+        QPair<int, qint64> &function = functions[site.function];
+        ++function.first;
+        function.second += site.blocks;
+    }
+
+    SourceAnnotationMap result;
+    for (const HeapCallSite &site : profile.callSites) {
+        if (site.file.isEmpty() || site.line <= 0)
+            continue;
+        if (site.blocks < minimumBlockShare * profile.blocks
+            && site.bytes < minimumByteShare * profile.bytes) {
+            continue;
+        }
+        SourceAnnotation annotation;
+        annotation.line = site.line;
+        annotation.heat = double(site.blocks) / mostBlocks;
+        const int blocks = int(qMin<qint64>(site.blocks, INT_MAX));
+        annotation.text = Tr::tr("%n allocations, %1", nullptr, blocks)
+                              .arg(formatBytes(site.bytes));
+        if (site.shortLivedBlocks > 0) {
+            annotation.text += ' ' + Tr::tr("(%1 % short-lived)")
+                                         .arg(100 * site.shortLivedBlocks / site.blocks);
+        }
+        const QPair<int, qint64> function = functions.value(site.function);
+        annotation.toolTip = Tr::tr("DHAT: %1 live at the heap's peak.\n"
+                                    "%2 allocates %3 times from %4 call sites in total.")
+                                 .arg(formatBytes(site.bytesAtPeak), site.function)
+                                 .arg(function.second)
+                                 .arg(function.first);
+        result[site.file].append(annotation);
+    }
+    return result;
+}
+
+static void analyzeHeapProfile(const FilePath &dhatFile, const FilePath &projectDirectory,
+                               const QString &title)
+{
+    const QFuture<HeapProfile> future
+        = Utils::asyncRun(loadDhatProfile, dhatFile, projectDirectory);
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(future);
+    Core::ProgressManager::addTask(future, Tr::tr("Reading Heap Profile"), dhatTaskId);
+    Utils::onFinished(future, Core::ICore::instance(),
+                      [dhatFile, title](const QFuture<HeapProfile> &future) {
+        if (future.isCanceled())
+            return;
+        try {
+            const auto profile = std::make_shared<const HeapProfile>(future.result());
+            // Only removed once read, one that cannot be read is left to look at.
+            dhatFile.removeFile();
+            SourceAnnotations::instance()->setAnnotations(heapAnnotationsId,
+                                                          Tr::tr("Heap Allocations"),
+                                                          callSiteAnnotations(*profile),
+                                                          QColor(160, 60, 200));
+            showHeapProfile(profile, title);
+        } catch (const std::exception &error) {
+            Core::MessageManager::writeFlashing(Tr::tr("Cannot read the heap profile: %1")
+                                                    .arg(QString::fromStdString(error.what())));
+        }
+    });
+}
+
+class HeapProfilerRunWorker final : public SimpleTargetRunner
+{
+public:
+    explicit HeapProfilerRunWorker(RunControl *runControl)
+        : SimpleTargetRunner(runControl)
+    {
+        setId("HeapProfilerRunWorker");
+        m_valgrind = new ProfiledProgram(runControl, "valgrind");
+        addStartDependency(m_valgrind);
+
+        setStartModifier([this, runControl] {
+            // One file per run, the profile of an earlier run may still be read.
+            const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz");
+            m_dhatFile = rustyDataDirectory(runControl->project()->projectDirectory())
+                             .pathAppended("dhat-heap-" + stamp + ".json");
+            m_dhatFile.parentDir().ensureWritableDir();
+            // Full source paths, so that frames can be told to be in the project.
+            CommandLine command{m_valgrind->tool(),
+                                {"--tool=dhat", "--dhat-out-file=" + m_dhatFile.path(),
+                                 "--fullpath-after="}};
+            command.addCommandLineAsArgs(m_valgrind->commandLine());
+            setCommandLine(command);
+            appendMessage(Tr::tr("The program runs many times slower under DHAT."),
+                          NormalMessageFormat);
+        });
+
+        connect(this, &RunWorker::stopped, this, [this, runControl] {
+            if (!m_dhatFile.exists())
+                return;
+            analyzeHeapProfile(m_dhatFile, runControl->project()->projectDirectory(),
+                               Tr::tr("Heap Profile of %1").arg(runControl->displayName()));
+        });
+    }
+
+private:
+    ProfiledProgram *m_valgrind = nullptr;
+    FilePath m_dhatFile;
+};
+
+HeapProfilerRunWorkerFactory::HeapProfilerRunWorkerFactory()
+{
+    setProduct<HeapProfilerRunWorker>();
+    addSupportedRunMode(Constants::HEAP_RUN_MODE);
+    addSupportedRunConfig(Constants::C_RUSTRUNCONFIGURATION_ID);
+}
+
+} // Rusty::Internal
@@ -0,0 +1,24 @@
+#ifndef HEAPPROFILER_H
+#define HEAPPROFILER_H
+
+#include <projectexplorer/runcontrol.h>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Runs a Rust run configuration under valgrind's DHAT
+ *
+ * Used for the heap profiling run mode. Once the program exits, the DHAT
+ * output is read on a worker thread and the allocations are listed per call
+ * site in the project: count, bytes, bytes live at the heap's peak and the
+ * share of short-lived blocks. The call sites are annotated in the editors.
+ */
+class HeapProfilerRunWorkerFactory final : public ProjectExplorer::RunWorkerFactory
+{
+public:
+    HeapProfilerRunWorkerFactory();
+};
+
+} // Rusty::Internal
+
+#endif // HEAPPROFILER_H
@@ -0,0 +1,123 @@
+#include "heapprofileview.h"
+
+#include "benchmark.h"
+#include "resultutils.h"
+#include "rusttr.h"
+
+#include <coreplugin/editormanager/editormanager.h>
+
+#include <utils/layoutbuilder.h>
+#include <utils/link.h>
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QTreeView>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const int CallSiteRole = Qt::UserRole + 1;
+
+enum CallSiteColumn {
+    FunctionColumn,
+    LocationColumn,
+    AllocationsColumn,
+    BytesColumn,
+    AtPeakColumn,
+    MaxLiveColumn,
+    ShortLivedColumn,
+    LifetimeColumn
+};
+
+class HeapProfileView : public QWidget
+{
+public:
+    HeapProfileView(const std::shared_ptr<const HeapProfile> &profile, const QString &title)
+        : m_profile(profile)
+    {
+        setWindowTitle(title);
+        resize(1200, 700);
+
+        m_model.setHorizontalHeaderLabels({Tr::tr("Function"), Tr::tr("Location"),
+                                           Tr::tr("Allocations"), Tr::tr("Bytes"),
+                                           Tr::tr("At Peak"), Tr::tr("Max. Live"),
+                                           Tr::tr("Short-Lived"), Tr::tr("Avg. Lifetime")});
+        for (int i = 0; i < profile->callSites.size(); ++i) {
+            const HeapCallSite &site = profile->callSites.at(i);
+            const QString location = site.file.isEmpty()
+                ? QString()
+                : QString("%1:%2").arg(site.file.fileName()).arg(site.line);
+            const double shortLived = site.blocks > 0
+                ? double(site.shortLivedBlocks) / site.blocks : 0.0;
+            QList<QStandardItem *> row{
+                textItem(site.function),
+                textItem(location),
+                sortedItem(QString::number(site.blocks), site.blocks),
+                sortedItem(formatBytes(site.bytes), site.bytes),
+                sortedItem(formatBytes(site.bytesAtPeak), site.bytesAtPeak),
+                sortedItem(formatBytes(site.maxLiveBytes), site.maxLiveBytes),
+                sortedItem(QString("%1 %").arg(100 * shortLived, 0, 'f', 1), shortLived),
+                sortedItem(QString("%1 %2").arg(qRound64(site.averageLifetime()))
+                               .arg(profile->timeUnit), site.averageLifetime())};
+            row.at(FunctionColumn)->setData(i, CallSiteRole);
+            row.at(FunctionColumn)->setToolTip(site.stack.join('\n'));
+            row.at(LocationColumn)->setToolTip(site.file.toUserOutput());
+            m_model.appendRow(row);
+        }
+
+        m_proxy.setSourceModel(&m_model);
+        m_proxy.setSortRole(Qt::UserRole);
+        auto view = new QTreeView;
+        view->setModel(&m_proxy);
+        view->setRootIsDecorated(false);
+        view->setSortingEnabled(true);
+        view->setUniformRowHeights(true);
+        view->sortByColumn(AllocationsColumn, Qt::DescendingOrder);
+        view->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+        view->header()->setSectionResizeMode(FunctionColumn, QHeaderView::Interactive);
+        view->header()->resizeSection(FunctionColumn, 450);
+        connect(view, &QTreeView::activated, this, [this](const QModelIndex &index) {
+            const QVariant site = index.siblingAtColumn(FunctionColumn).data(CallSiteRole);
+            if (!site.isValid())
+                return;
+            const HeapCallSite &callSite = m_profile->callSites.at(site.toInt());
+            if (!callSite.file.isEmpty() && callSite.file.exists())
+                Core::EditorManager::openEditorAt(Link(callSite.file, callSite.line));
+        });
+
+        const double peakPosition = profile->totalTime > 0
+            ? 100.0 * profile->peakTime / profile->totalTime : 0.0;
+        auto summary = new QLabel(
+            Tr::tr("%1 allocations of %2 in total, the heap peaked at %3 after %4 % of the run. "
+                   "Blocks of allocation points that live shorter than %5 %6 on average count "
+                   "as short-lived. Hover a function for its stack.")
+                .arg(profile->blocks)
+                .arg(formatBytes(profile->bytes), formatBytes(profile->bytesAtPeak))
+                .arg(peakPosition, 0, 'f', 0)
+                .arg(profile->shortLivedThreshold)
+                .arg(profile->timeUnit));
+        summary->setWordWrap(true);
+
+        using namespace Layouting;
+        Column {
+            summary,
+            view
+        }.attachTo(this);
+    }
+
+private:
+    const std::shared_ptr<const HeapProfile> m_profile;
+    QStandardItemModel m_model;
+    QSortFilterProxyModel m_proxy;
+};
+
+void showHeapProfile(const std::shared_ptr<const HeapProfile> &profile, const QString &title)
+{
+    auto view = new HeapProfileView(profile, title);
+    showResultWindow(view);
+}
+
+} // Rusty::Internal
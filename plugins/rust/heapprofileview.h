@@ -0,0 +1,16 @@
+#ifndef HEAPPROFILEVIEW_H
+#define HEAPPROFILEVIEW_H
+
+#include "dhatparser.h"
+
+#include <memory>
+
+namespace Rusty::Internal {
+
+// Shows the allocations of a heap profile per call site, activating a call
+// site opens its source line.
+void showHeapProfile(const std::shared_ptr<const HeapProfile> &profile, const QString &title);
+
+} // Rusty::Internal
+
+#endif // HEAPPROFILEVIEW_H
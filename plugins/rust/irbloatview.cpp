@@ -0,0 +1,181 @@
+#include "irbloatview.h"
+
+#include "benchmark.h"
+#include "llvmirparser.h"
+#include "resultutils.h"
+#include "rusttr.h"
+
+#include <coreplugin/editormanager/editormanager.h>
+#include <coreplugin/icore.h>
+#include <coreplugin/messagemanager.h>
+#include <coreplugin/progressmanager/progressmanager.h>
+
+#include <extensionsystem/pluginmanager.h>
+
+#include <utils/async.h>
+#include <utils/futuresynchronizer.h>
+#include <utils/layoutbuilder.h>
+#include <utils/link.h>
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QTreeView>
+
+#include <memory>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const char irBloatTaskId[] = "Rusty.IrBloat";
+
+const int DefinitionRole = Qt::UserRole + 1;
+
+enum DefinitionColumn {
+    NameColumn,
+    LocationColumn,
+    CopiesColumn,
+    LinesColumn,
+    ShareColumn
+};
+
+static QStandardItem *shareItem(qint64 part, qint64 total)
+{
+    const double share = total > 0 ? 100.0 * part / total : 0.0;
+    return sortedItem(QString("%1 %").arg(share, 0, 'f', 2), share);
+}
+
+class IrBloatView : public QWidget
+{
+public:
+    explicit IrBloatView(const std::shared_ptr<const IrBloatReport> &report)
+        : m_report(report)
+    {
+        setWindowTitle(Tr::tr("LLVM IR Bloat of %1").arg(report->crate));
+        resize(1200, 700);
+
+        m_model.setHorizontalHeaderLabels({Tr::tr("Function"), Tr::tr("Location"),
+                                           Tr::tr("Copies"), Tr::tr("IR Lines"),
+                                           Tr::tr("Share")});
+        for (int i = 0; i < report->definitions.size(); ++i) {
+            const IrDefinition &definition = report->definitions.at(i);
+            const QString location = definition.file.isEmpty()
+                ? QString()
+                : QString("%1:%2").arg(definition.file.fileName()).arg(definition.line);
+            QList<QStandardItem *> row{textItem(definition.name), textItem(location),
+                                       countItem(definition.instances.size()),
+                                       countItem(definition.lines),
+                                       shareItem(definition.lines, report->totalLines)};
+            row.at(NameColumn)->setData(i, DefinitionRole);
+            row.at(NameColumn)->setToolTip(definition.name);
+            row.at(LocationColumn)->setToolTip(definition.file.toUserOutput());
+
+            // Every codegen unit that uses an inline or generic function gets
+            // a copy of its own.
+            QList<IrInstance> instances;
+            QList<int> copies;
+            QHash<QString, int> indexes;
+            for (const IrInstance &instance : definition.instances) {
+                const auto it = indexes.constFind(instance.name);
+                if (it == indexes.cend()) {
+                    indexes.insert(instance.name, int(instances.size()));
+                    instances.append(instance);
+                    copies.append(1);
+                } else {
+                    instances[*it].lines += instance.lines;
+                    ++copies[*it];
+                }
+            }
+            // A function that is not generic has a single instance of the same name.
+            if (instances.size() > 1 || instances.first().name != definition.name) {
+                for (int j = 0; j < instances.size(); ++j) {
+                    const IrInstance &instance = instances.at(j);
+                    QList<QStandardItem *> child{textItem(instance.name), textItem({}),
+                                                 countItem(copies.at(j)),
+                                                 countItem(instance.lines),
+                                                 shareItem(instance.lines, report->totalLines)};
+                    child.at(NameColumn)->setData(i, DefinitionRole);
+                    child.at(NameColumn)->setToolTip(instance.name);
+                    row.first()->appendRow(child);
+                }
+            }
+            m_model.appendRow(row);
+        }
+
+        m_proxy.setSourceModel(&m_model);
+        m_proxy.setSortRole(Qt::UserRole);
+        auto view = new QTreeView;
+        view->setModel(&m_proxy);
+        view->setSortingEnabled(true);
+        view->setUniformRowHeights(true);
+        view->sortByColumn(LinesColumn, Qt::DescendingOrder);
+        view->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+        view->header()->setSectionResizeMode(NameColumn, QHeaderView::Interactive);
+        view->header()->resizeSection(NameColumn, 550);
+        connect(view, &QTreeView::activated, this, [this](const QModelIndex &index) {
+            const QVariant definition = index.siblingAtColumn(NameColumn).data(DefinitionRole);
+            if (!definition.isValid())
+                return;
+            const IrDefinition &irDefinition = m_report->definitions.at(definition.toInt());
+            if (!irDefinition.file.isEmpty() && irDefinition.file.exists())
+                Core::EditorManager::openEditorAt(Link(irDefinition.file, irDefinition.line));
+        });
+
+        auto summary = new QLabel(
+            Tr::tr("%1 lines of unoptimized LLVM IR in %2 functions of %3 definitions. "
+                   "Generic functions are listed with their instances. Activate a function "
+                   "to open its definition.")
+                .arg(formatCount(report->totalLines), formatCount(report->totalFunctions),
+                     formatCount(report->definitions.size())));
+        summary->setWordWrap(true);
+
+        using namespace Layouting;
+        Column {
+            summary,
+            view
+        }.attachTo(this);
+    }
+
+private:
+    const std::shared_ptr<const IrBloatReport> m_report;
+    QStandardItemModel m_model;
+    QSortFilterProxyModel m_proxy;
+};
+
+void showIrBloatReport(const FilePath &file)
+{
+    // What LLVM is handed before any of its passes ran, that is what the
+    // compile time and, through inlining, the code size grow with. Naming
+    // the anonymous globals keeps the IR readable by the parser.
+    QString error;
+    const std::optional<CrateEmitBuild> build = crateEmitBuild(
+        file,
+        {"--emit", "llvm-ir", "-C", "debuginfo=line-tables-only", "-C", "no-prepopulate-passes",
+         "-C", "passes=name-anon-globals"},
+        &error);
+    if (!build) {
+        Core::MessageManager::writeFlashing(
+            Tr::tr("Cannot create the LLVM IR bloat report: %1").arg(error));
+        return;
+    }
+
+    const QFuture<IrBloatReport> future = Utils::asyncRun(buildIrBloatReport, *build);
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(future);
+    Core::ProgressManager::addTask(future, Tr::tr("Building LLVM IR"), irBloatTaskId);
+    Utils::onFinished(future, Core::ICore::instance(), [](const QFuture<IrBloatReport> &future) {
+        if (future.isCanceled())
+            return;
+        try {
+            auto view = new IrBloatView(std::make_shared<const IrBloatReport>(future.result()));
+            showResultWindow(view);
+        } catch (const std::exception &error) {
+            Core::MessageManager::writeFlashing(
+                Tr::tr("Cannot create the LLVM IR bloat report: %1")
+                    .arg(QString::fromStdString(error.what())));
+        }
+    });
+}
+
+} // Rusty::Internal
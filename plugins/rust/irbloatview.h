@@ -0,0 +1,15 @@
+#ifndef IRBLOATVIEW_H
+#define IRBLOATVIEW_H
+
+#include <utils/filepath.h>
+
+namespace Rusty::Internal {
+
+// Builds the crate containing file to unoptimized LLVM IR and shows how many
+// lines of IR each function definition costs, summed over all of its
+// monomorphizations, with the instances below it.
+void showIrBloatReport(const Utils::FilePath &file);
+
+} // Rusty::Internal
+
+#endif // IRBLOATVIEW_H
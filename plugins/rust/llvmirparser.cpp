@@ -0,0 +1,198 @@
+#include "llvmirparser.h"
+
+#include "resultutils.h"
+#include "rustdemangle.h"
+#include "rusttr.h"
+
+#include <QFile>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+QString stripGenericArguments(const QString &name)
+{
+    QString result;
+    result.reserve(name.size());
+    int depth = 0;
+    for (qsizetype i = 0; i < name.size(); ++i) {
+        const QChar c = name.at(i);
+        const QChar previous = i > 0 ? name.at(i - 1) : QChar();
+        if (depth > 0) {
+            // "->" of function pointer types closes nothing.
+            if (c == '<')
+                ++depth;
+            else if (c == '>' && previous != '-')
+                --depth;
+            continue;
+        }
+        // A '<' right after a name opens its arguments, otherwise it starts
+        // a qualified path like "<Vec<T> as Drop>".
+        if (c == '<' && (previous.isLetterOrNumber() || previous == '_')) {
+            depth = 1;
+            continue;
+        }
+        result.append(c);
+    }
+    return result;
+}
+
+// Legacy symbols carry no generic arguments, the debug information has them
+// in the function's name.
+static QString instanceName(const QString &symbol, const QString &subprogramName)
+{
+    QString name = demangleRustSymbol(symbol);
+    if (name.isEmpty())
+        name = symbol;
+    const qsizetype separator = name.lastIndexOf("::");
+    const QString last = name.mid(separator < 0 ? 0 : separator + 2);
+    if (!last.contains('<') && subprogramName.startsWith(last + '<'))
+        name = name.left(name.size() - last.size()) + subprogramName;
+    return name;
+}
+
+LlvmIrParser::LlvmIrParser(const FilePath &workingDirectory)
+    : m_workingDirectory(workingDirectory)
+{}
+
+void LlvmIrParser::addLine(const QString &line)
+{
+    static const QRegularExpression define(
+        R"(^define\b.*?@("[^"]+"|[\w$.-]+)\(.*?(?:!dbg !(\d+))?\s*\{?\s*$)");
+    static const QRegularExpression subprogram(R"(^!(\d+) = (?:distinct )?!DISubprogram\()");
+    static const QRegularExpression name(R"(\bname: "([^"]*)")");
+    static const QRegularExpression file(R"(\bfile: !(\d+))");
+    static const QRegularExpression lineNumber(R"(\bline: (\d+))");
+    static const QRegularExpression diFile(
+        R"(^!(\d+) = (?:distinct )?!DIFile\(filename: "([^"]*)", directory: "([^"]*)")");
+
+    if (m_inFunction) {
+        if (line.startsWith('}'))
+            m_inFunction = false;
+        else if (!line.trimmed().isEmpty())
+            ++m_functions.last().lines;
+        return;
+    }
+
+    if (line.startsWith("define ")) {
+        const QRegularExpressionMatch match = define.match(line);
+        if (!match.hasMatch())
+            return;
+        Function function;
+        function.symbol = match.captured(1).remove('"');
+        if (match.hasCaptured(2))
+            function.subprogram = match.captured(2).toInt();
+        m_functions.append(function);
+        m_inFunction = true;
+        return;
+    }
+
+    // Of the metadata, only where functions were defined matters.
+    if (!line.startsWith('!'))
+        return;
+    if (const QRegularExpressionMatch match = subprogram.match(line); match.hasMatch()) {
+        Subprogram entry;
+        entry.name = name.match(line).captured(1);
+        entry.file = file.match(line).captured(1).toInt();
+        entry.line = lineNumber.match(line).captured(1).toInt();
+        m_subprograms.insert(match.captured(1).toInt(), entry);
+    } else if (const QRegularExpressionMatch match = diFile.match(line); match.hasMatch()) {
+        m_files.insert(match.captured(1).toInt(), m_workingDirectory.resolvePath(match.captured(3))
+                                                      .resolvePath(match.captured(2))
+                                                      .cleanPath());
+    }
+}
+
+void LlvmIrParser::finishFile()
+{
+    for (const Function &function : std::as_const(m_functions)) {
+        const Subprogram subprogram = m_subprograms.value(function.subprogram);
+        IrInstance instance;
+        instance.name = instanceName(function.symbol, subprogram.name);
+        instance.lines = function.lines;
+
+        const FilePath file = m_files.value(subprogram.file);
+        const QString definitionName = stripGenericArguments(instance.name);
+        const QString key = file.isEmpty()
+                                ? definitionName
+                                : QString("%1:%2").arg(file.toString()).arg(subprogram.line);
+        int index = m_definitionIndexes.value(key, -1);
+        if (index < 0) {
+            IrDefinition definition;
+            definition.name = definitionName;
+            definition.file = file;
+            definition.line = subprogram.line;
+            index = int(m_report.definitions.size());
+            m_report.definitions.append(definition);
+            m_definitionIndexes.insert(key, index);
+        }
+        IrDefinition &definition = m_report.definitions[index];
+        definition.lines += instance.lines;
+        definition.instances.append(instance);
+        m_report.totalLines += instance.lines;
+        ++m_report.totalFunctions;
+    }
+    m_functions.clear();
+    m_subprograms.clear();
+    m_files.clear();
+    m_inFunction = false;
+}
+
+IrBloatReport LlvmIrParser::takeReport()
+{
+    std::sort(m_report.definitions.begin(), m_report.definitions.end(),
+              [](const IrDefinition &a, const IrDefinition &b) { return a.lines > b.lines; });
+    for (IrDefinition &definition : m_report.definitions) {
+        std::sort(definition.instances.begin(), definition.instances.end(),
+                  [](const IrInstance &a, const IrInstance &b) { return a.lines > b.lines; });
+    }
+    m_definitionIndexes.clear();
+    return std::move(m_report);
+}
+
+void buildIrBloatReport(QPromise<IrBloatReport> &promise, const CrateEmitBuild &build)
+{
+    FilePaths sources;
+    QString error;
+    const FilePaths irFiles = runCrateEmitBuild(
+        build, "ll", [&promise] { return promise.isCanceled(); }, &sources, &error);
+    if (promise.isCanceled())
+        return;
+    if (irFiles.isEmpty()) {
+        reportWorkerFailure(promise, error);
+        return;
+    }
+
+    // The IR of a crate easily has millions of lines, it is never read as a whole.
+    promise.setProgressRange(0, int(irFiles.size()));
+    LlvmIrParser parser(build.workingDirectory);
+    for (int i = 0; i < irFiles.size(); ++i) {
+        QFile input(irFiles.at(i).toFSPathString());
+        if (!input.open(QIODevice::ReadOnly)) {
+            reportWorkerFailure(promise, Tr::tr("Cannot open %1.")
+                                             .arg(irFiles.at(i).toUserOutput()));
+            return;
+        }
+        for (int lineNumber = 1; !input.atEnd(); ++lineNumber) {
+            parser.addLine(QString::fromUtf8(input.readLine()));
+            if (lineNumber % 100000 == 0 && promise.isCanceled())
+                return;
+        }
+        parser.finishFile();
+        promise.setProgressValue(i + 1);
+    }
+
+    IrBloatReport report = parser.takeReport();
+    if (report.totalFunctions == 0) {
+        reportWorkerFailure(promise, Tr::tr("The LLVM IR contains no functions."));
+        return;
+    }
+    // "mycrate-1a2b3c4d5e6f.mycrate.abc-cgu.0.ll"
+    report.crate = irFiles.first().fileName().section('.', 0, 0).section('-', 0, -2);
+    promise.addResult(std::move(report));
+}
+
+} // Rusty::Internal
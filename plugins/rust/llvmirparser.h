@@ -0,0 +1,94 @@
+#ifndef LLVMIRPARSER_H
+#define LLVMIRPARSER_H
+
+#include "crateemit.h"
+
+#include <utils/filepath.h>
+
+#include <QHash>
+#include <QPromise>
+
+namespace Rusty::Internal {
+
+class IrInstance
+{
+public:
+    QString name;       // Demangled, with the generic arguments if known.
+    int lines = 0;      // Of the function body.
+};
+
+// All instances of a function defined in the same place, e.g. every
+// monomorphization of a generic function, counted once per codegen unit
+// that got a copy.
+class IrDefinition
+{
+public:
+    QString name;       // Without generic arguments.
+    Utils::FilePath file;
+    int line = 0;
+    qint64 lines = 0;
+    QList<IrInstance> instances;
+};
+
+class IrBloatReport
+{
+public:
+    QString crate;
+    QList<IrDefinition> definitions;    // Most lines first.
+    qint64 totalLines = 0;
+    int totalFunctions = 0;
+};
+
+// "core::iter::Iterator::fold<u8, ...>" and "<Vec<T> as Drop>::drop" to
+// "core::iter::Iterator::fold" and "<Vec as Drop>::drop".
+QString stripGenericArguments(const QString &name);
+
+/**
+ * @brief Counts the lines of every function in rustc's textual LLVM IR
+ *
+ * The IR is read line by line and only the "define" lines and their body
+ * lengths are kept, together with the DISubprogram and DIFile metadata at
+ * the end of the file that tell where the function was defined. Metadata
+ * numbers are per file, finishFile() is called after each codegen unit.
+ */
+class LlvmIrParser
+{
+public:
+    explicit LlvmIrParser(const Utils::FilePath &workingDirectory);
+
+    void addLine(const QString &line);
+    void finishFile();
+    IrBloatReport takeReport();
+
+private:
+    class Function
+    {
+    public:
+        QString symbol;
+        int subprogram = -1;
+        int lines = 0;
+    };
+    class Subprogram
+    {
+    public:
+        QString name;
+        int file = -1;
+        int line = 0;
+    };
+
+    const Utils::FilePath m_workingDirectory;
+    IrBloatReport m_report;
+    QHash<QString, int> m_definitionIndexes;   // By location, or name if unknown.
+    QList<Function> m_functions;
+    QHash<int, Subprogram> m_subprograms;
+    QHash<int, Utils::FilePath> m_files;
+    bool m_inFunction = false;
+};
+
+// Meant to run on a worker thread. Runs the build, which emits LLVM IR, and
+// reports the IR of the crate containing build.sourceFile.
+void buildIrBloatReport(QPromise<IrBloatReport> &promise, const CrateEmitBuild &build);
+
+} // Rusty::Internal
+
+#endif // LLVMIRPARSER_H
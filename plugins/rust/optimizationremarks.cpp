@@ -0,0 +1,183 @@
+#include "optimizationremarks.h"
+
+#include "rusttr.h"
+#include "sourceannotations.h"
+
+#include <projectexplorer/buildmanager.h>
+
+#include <QColor>
+#include <QMap>
+#include <QRegularExpression>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const char remarksSourcePrefix[] = "Rusty.OptimizationRemarks.";
+
+// The text mark shows the first missed remark of a line, shortened.
+const int maxAnnotationLength = 80;
+
+static OptimizationRemarks *s_instance = nullptr;
+
+bool parseOptimizationRemark(const QString &message, OptimizationRemark *remark)
+{
+    static const QRegularExpression current(
+        R"(^(.+):(\d+):(\d+) ([\w-]+) \((\w+)\): (.*)$)",
+        QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression legacy(
+        R"(^optimization (\w+) for ([\w-]+) at (.+):(\d+):(\d+): (.*)$)",
+        QRegularExpression::DotMatchesEverythingOption);
+
+    QString kind;
+    if (const QRegularExpressionMatch match = current.match(message); match.hasMatch()) {
+        remark->file = FilePath::fromUserInput(match.captured(1));
+        remark->line = match.captured(2).toInt();
+        remark->column = match.captured(3).toInt();
+        remark->pass = match.captured(4);
+        kind = match.captured(5);
+        remark->message = match.captured(6);
+    } else if (const QRegularExpressionMatch match = legacy.match(message); match.hasMatch()) {
+        kind = match.captured(1);
+        remark->pass = match.captured(2);
+        remark->file = FilePath::fromUserInput(match.captured(3));
+        remark->line = match.captured(4).toInt();
+        remark->column = match.captured(5).toInt();
+        remark->message = match.captured(6);
+    } else {
+        return false;
+    }
+
+    if (kind == "success" || kind == "remark")
+        remark->kind = OptimizationRemark::Passed;
+    else if (kind == "missed" || kind == "failure")
+        remark->kind = OptimizationRemark::Missed;
+    else if (kind == "analysis")
+        remark->kind = OptimizationRemark::Analysis;
+    else
+        return false;
+    return true;
+}
+
+OptimizationRemarks::OptimizationRemarks()
+{
+    s_instance = this;
+    connect(BuildManager::instance(), &BuildManager::buildQueueFinished,
+            this, &OptimizationRemarks::buildQueueFinished);
+}
+
+OptimizationRemarks::~OptimizationRemarks()
+{
+    s_instance = nullptr;
+}
+
+OptimizationRemarks *OptimizationRemarks::instance()
+{
+    return s_instance;
+}
+
+QStringList OptimizationRemarks::passes()
+{
+    return {"inline", "loop-vectorize", "slp-vectorize"};
+}
+
+QString OptimizationRemarks::passDisplayName(const QString &pass)
+{
+    if (pass == "inline")
+        return Tr::tr("Inlining");
+    if (pass == "loop-vectorize")
+        return Tr::tr("Loop Vectorization");
+    if (pass == "slp-vectorize")
+        return Tr::tr("SLP Vectorization");
+    return pass;
+}
+
+void OptimizationRemarks::addRemark(const OptimizationRemark &remark)
+{
+    if (!m_replaced.contains(remark.file)) {
+        m_replaced.insert(remark.file);
+        m_remarks.remove(remark.file);
+    }
+    m_remarks[remark.file].append(remark);
+    m_changed = true;
+}
+
+bool OptimizationRemarks::isPassShown(const QString &pass) const
+{
+    return !m_hiddenPasses.contains(pass);
+}
+
+void OptimizationRemarks::setPassShown(const QString &pass, bool shown)
+{
+    if (shown == isPassShown(pass))
+        return;
+    if (shown)
+        m_hiddenPasses.remove(pass);
+    else
+        m_hiddenPasses.insert(pass);
+    publish(pass);
+}
+
+void OptimizationRemarks::buildQueueFinished()
+{
+    m_replaced.clear();
+    if (!m_changed)
+        return;
+    m_changed = false;
+    for (const QString &pass : passes())
+        publish(pass);
+}
+
+void OptimizationRemarks::publish(const QString &pass) const
+{
+    const Id source = Id(remarksSourcePrefix).withSuffix(pass);
+    if (!isPassShown(pass)) {
+        SourceAnnotations::instance()->clear(source);
+        return;
+    }
+
+    SourceAnnotationMap annotations;
+    for (auto file = m_remarks.cbegin(), end = m_remarks.cend(); file != end; ++file) {
+        // Lib and test builds of a crate report the same remarks twice.
+        QMap<int, QStringList> missed;
+        QMap<int, QStringList> lines;
+        for (const OptimizationRemark &remark : file.value()) {
+            if (remark.pass != pass)
+                continue;
+            QStringList &messages = lines[remark.line];
+            const QString text = remark.kind == OptimizationRemark::Missed
+                ? Tr::tr("missed: %1").arg(remark.message)
+                : remark.message;
+            if (messages.contains(text))
+                continue;
+            messages.append(text);
+            if (remark.kind == OptimizationRemark::Missed)
+                missed[remark.line].append(remark.message);
+        }
+        for (auto line = lines.cbegin(), lineEnd = lines.cend(); line != lineEnd; ++line) {
+            // Analysis remarks alone explain decisions that did not fail.
+            const QStringList lineMissed = missed.value(line.key());
+            if (lineMissed.isEmpty())
+                continue;
+            SourceAnnotation annotation;
+            annotation.line = line.key();
+            annotation.heat = qMin(1.0, 0.2 * lineMissed.size());
+            annotation.text = lineMissed.first();
+            if (annotation.text.size() > maxAnnotationLength)
+                annotation.text = annotation.text.left(maxAnnotationLength - 3) + "...";
+            annotation.toolTip = QString("%1:\n%2").arg(passDisplayName(pass),
+                                                        line.value().join('\n'));
+            annotations[file.key()].append(annotation);
+        }
+    }
+
+    static const QHash<QString, QColor> colors{{"inline", QColor(220, 120, 0)},
+                                               {"loop-vectorize", QColor(150, 60, 200)},
+                                               {"slp-vectorize", QColor(40, 110, 220)}};
+    SourceAnnotations::instance()->setAnnotations(
+        source, Tr::tr("Missed %1").arg(passDisplayName(pass)), annotations,
+        colors.value(pass, QColor(120, 120, 120)));
+}
+
+} // Rusty::Internal
@@ -0,0 +1,71 @@
+#ifndef OPTIMIZATIONREMARKS_H
+#define OPTIMIZATIONREMARKS_H
+
+#include <utils/filepath.h>
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+namespace Rusty::Internal {
+
+class OptimizationRemark
+{
+public:
+    enum Kind { Passed, Missed, Analysis };
+
+    Utils::FilePath file;   // As rustc printed it, usually relative to the workspace.
+    int line = 0;
+    int column = 0;
+    QString pass;           // "inline", "loop-vectorize", ...
+    Kind kind = Missed;
+    QString message;
+};
+
+// Parses rustc's rendering of an LLVM remark, a note without spans:
+// "src/lib.rs:12:9 loop-vectorize (missed): loop not vectorized" or, from
+// older releases, "optimization missed for loop-vectorize at src/lib.rs:12:9: ...".
+bool parseOptimizationRemark(const QString &message, OptimizationRemark *remark);
+
+/**
+ * @brief Collects the missed optimizations of builds for the editor
+ *
+ * Builds with "Collect optimization remarks" get one remark per inlining
+ * decision and vectorized loop, easily tens of thousands per crate. The
+ * CargoOutputParser hands over the missed ones as they arrive; they are
+ * published as source annotations, one source per pass so each can be
+ * hidden on its own, once the build queue finishes.
+ *
+ * Only recompiled crates emit remarks: a file's remarks are replaced when a
+ * build reports new ones for it, those of untouched crates are kept.
+ */
+class OptimizationRemarks : public QObject
+{
+public:
+    OptimizationRemarks();
+    ~OptimizationRemarks() override;
+
+    static OptimizationRemarks *instance();
+
+    // The passes rustc is asked for, see RsSideBuildConfiguration.
+    static QStringList passes();
+    static QString passDisplayName(const QString &pass);
+
+    void addRemark(const OptimizationRemark &remark);
+
+    bool isPassShown(const QString &pass) const;
+    void setPassShown(const QString &pass, bool shown);
+
+private:
+    void buildQueueFinished();
+    void publish(const QString &pass) const;
+
+    QHash<Utils::FilePath, QList<OptimizationRemark>> m_remarks;
+    QSet<Utils::FilePath> m_replaced;     // Files that got remarks in the running build.
+    QSet<QString> m_hiddenPasses;
+    bool m_changed = false;
+};
+
+} // Rusty::Internal
+
+#endif // OPTIMIZATIONREMARKS_H
@@ -0,0 +1,235 @@
+#include "perfparser.h"
+
+#include "resultutils.h"
+#include "rustdemangle.h"
+#include "rusttr.h"
+
+#include <utils/process.h>
+
+#include <QRegularExpression>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+static bool isHexNumber(QByteArrayView text)
+{
+    if (text.isEmpty())
+        return false;
+    for (char c : text) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+            return false;
+    }
+    return true;
+}
+
+// "1234.567890", perf script prints microseconds unless asked for --ns.
+static qint64 microseconds(const QString &seconds, const QString &fraction)
+{
+    return seconds.toLongLong() * 1000000 + fraction.left(6).leftJustified(6, '0').toLongLong();
+}
+
+// The state a thread was switched out in, as the kernel reports it for
+// sched_switch.
+static QString stateFrame(const QString &state)
+{
+    if (state.startsWith('R'))
+        return QString("[preempted]");
+    if (state.startsWith('S'))
+        return QString("[sleeping]");
+    if (state.startsWith('D'))
+        return QString("[uninterruptible sleep]");
+    return QString("[%1]").arg(state);
+}
+
+PerfScriptParser::PerfScriptParser(Mode mode)
+    : m_mode(mode)
+{
+    if (m_mode == OffCpu)
+        m_data.weight = ProfileData::Weight::BlockedMicroseconds;
+}
+
+void PerfScriptParser::addData(const QByteArray &data)
+{
+    m_pending += data;
+    qsizetype start = 0;
+    for (qsizetype end = m_pending.indexOf('\n'); end >= 0;
+         end = m_pending.indexOf('\n', start)) {
+        parseLine(m_pending.mid(start, end - start));
+        start = end + 1;
+    }
+    m_pending.remove(0, start);
+}
+
+void PerfScriptParser::finish()
+{
+    if (!m_pending.isEmpty())
+        parseLine(m_pending);
+    m_pending.clear();
+    finishSample();
+    // Threads that exited, or were still blocked when the recording ended.
+    m_switchedOut.clear();
+}
+
+ProfileData PerfScriptParser::takeData()
+{
+    return std::move(m_data);
+}
+
+void PerfScriptParser::parseLine(const QByteArray &line)
+{
+    if (line.trimmed().isEmpty()) {
+        finishSample();
+        return;
+    }
+    // "app 4711 [003] 1234.567890:" and alike, a new sample.
+    if (line.at(0) != ' ' && line.at(0) != '\t') {
+        finishSample();
+        if (m_mode == OffCpu)
+            parseOffCpuHeader(line);
+        return;
+    }
+
+    const QByteArray trimmed = line.trimmed();
+    const qsizetype space = trimmed.indexOf(' ');
+    if (space > 0 && isHexNumber(QByteArrayView(trimmed).first(space))) {
+        // "55d1c2a0b1c4 _ZN3app4main17h0123456789abcdefE (/home/me/app/target/release/app)"
+        QByteArray symbolAndModule = trimmed.mid(space + 1);
+        int frame = m_frameBySymbolAndModule.value(symbolAndModule, -1);
+        if (frame < 0) {
+            QByteArray symbol = symbolAndModule;
+            QString module;
+            const qsizetype paren = symbol.lastIndexOf(" (");
+            if (paren >= 0 && symbol.endsWith(')')) {
+                module = QString::fromUtf8(symbol.mid(paren + 2, symbol.size() - paren - 3))
+                             .section('/', -1);
+                symbol.truncate(paren);
+            }
+            QString name = QString::fromUtf8(symbol);
+            const QString demangled = demangleRustSymbol(name);
+            if (!demangled.isEmpty())
+                name = demangled;
+            frame = m_data.frameIndex(name, module);
+            m_frameBySymbolAndModule.insert(symbolAndModule, frame);
+        }
+        m_stack.append(frame);
+        m_lines.append(-1);
+        return;
+    }
+
+    // "  /home/me/app/src/main.rs:12", the location of the previous frame.
+    const qsizetype colon = trimmed.lastIndexOf(':');
+    if (colon <= 0 || m_stack.isEmpty())
+        return;
+    bool ok = false;
+    const int lineNumber = trimmed.mid(colon + 1).toInt(&ok);
+    const QByteArray file = trimmed.left(colon);
+    if (!ok || lineNumber <= 0 || file == "??")
+        return;
+    m_lines.last() = lineNumber;
+    ProfileFrame &frame = m_data.frames[m_stack.last()];
+    if (frame.file.isEmpty())
+        frame.file = FilePath::fromUserInput(QString::fromUtf8(file));
+}
+
+void PerfScriptParser::parseOffCpuHeader(const QByteArray &line)
+{
+    // "app  4711 1234.567890: sched:sched_switch: prev_comm=app prev_pid=4711 prev_prio=120
+    //  prev_state=S ==> next_comm=swapper/3 next_pid=0 next_prio=120" or
+    // "app  4711 1234.569990: PERF_RECORD_SWITCH IN", the comm may contain spaces.
+    static const QRegularExpression header(R"(\s(\d+)\s+(\d+)\.(\d+):\s+(.*)$)");
+    const QRegularExpressionMatch match = header.match(QString::fromUtf8(line));
+    if (!match.hasMatch())
+        return;
+    const qint64 tid = match.captured(1).toLongLong();
+    const qint64 time = microseconds(match.captured(2), match.captured(3));
+    const QString event = match.captured(4);
+
+    if (event.startsWith("PERF_RECORD_SWITCH")) {
+        if (event.section(' ', 1, 1) != "IN")
+            return;
+        const auto switchedOut = m_switchedOut.constFind(tid);
+        if (switchedOut == m_switchedOut.cend())
+            return;
+        if (time > switchedOut->time)
+            m_data.addSample(switchedOut->stack, switchedOut->lines, time - switchedOut->time);
+        m_switchedOut.erase(switchedOut);
+        return;
+    }
+    if (!event.contains("sched_switch"))
+        return;
+    static const QRegularExpression state("prev_state=(\\S+)");
+    m_sampleTid = tid;
+    m_sampleTime = time;
+    m_sampleState = state.match(event).captured(1);
+}
+
+void PerfScriptParser::finishSample()
+{
+    if (m_mode == OffCpu) {
+        // Kept until the thread runs again, which tells how long it was blocked.
+        if (m_sampleTid >= 0) {
+            m_stack.prepend(m_data.frameIndex(stateFrame(m_sampleState), QString()));
+            m_lines.prepend(-1);
+            m_switchedOut.insert(m_sampleTid, {m_sampleTime, m_stack, m_lines});
+        }
+        m_sampleTid = -1;
+    } else if (!m_stack.isEmpty()) {
+        m_data.addSample(m_stack, m_lines);
+    }
+    m_stack.clear();
+    m_lines.clear();
+}
+
+static void runPerfScript(QPromise<ProfileData> &promise, const CommandLine &command,
+                          PerfScriptParser &parser, const QString &emptyMessage)
+{
+    Process process;
+    process.setCommand(command);
+    process.start();
+
+    while (process.state() != QProcess::NotRunning) {
+        if (promise.isCanceled()) {
+            process.kill();
+            process.waitForFinished();
+            return;
+        }
+        process.waitForReadyRead(100);
+        parser.addData(process.readAllRawStandardOutput());
+    }
+    parser.addData(process.readAllRawStandardOutput());
+    parser.finish();
+
+    ProfileData data = parser.takeData();
+    if (data.totalSamples == 0) {
+        const QString error = process.result() == ProcessResult::FinishedWithSuccess
+            ? emptyMessage
+            : Tr::tr("perf script failed: %1").arg(process.cleanedStdErr().trimmed());
+        reportWorkerFailure(promise, error);
+        return;
+    }
+    promise.addResult(std::move(data));
+}
+
+void loadPerfData(QPromise<ProfileData> &promise, const FilePath &perf, const FilePath &dataFile)
+{
+    // perf's own demangler leaves v0 symbols alone and keeps the hash of
+    // legacy ones, the parser demangles all of them the same way.
+    PerfScriptParser parser;
+    runPerfScript(promise,
+                  {perf, {"script", "--no-demangle", "-F", "comm,tid,ip,sym,dso,srcline",
+                          "-i", dataFile.path()}},
+                  parser, Tr::tr("The profile contains no samples."));
+}
+
+void loadOffCpuData(QPromise<ProfileData> &promise, const FilePath &perf,
+                    const FilePath &dataFile)
+{
+    PerfScriptParser parser(PerfScriptParser::OffCpu);
+    runPerfScript(promise,
+                  {perf, {"script", "--no-demangle", "--show-switch-events", "-F",
+                          "comm,tid,time,event,trace,ip,sym,dso,srcline", "-i", dataFile.path()}},
+                  parser, Tr::tr("The recording contains no thread that blocked."));
+}
+
+} // Rusty::Internal
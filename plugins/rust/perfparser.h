@@ -0,0 +1,73 @@
+#ifndef PERFPARSER_H
+#define PERFPARSER_H
+
+#include "profiledata.h"
+
+#include <QPromise>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Parses the output of "perf script" into a ProfileData
+ *
+ * Expects samples with call chains as written by perf script -F
+ * comm,tid,ip,sym,dso,srcline: a header line per sample, one indented line
+ * per frame, innermost first, each optionally followed by a line with its
+ * source location, and an empty line after the sample. Data may be fed in
+ * arbitrary chunks. Symbols are demangled on the way.
+ *
+ * In off-CPU mode, samples are those of the sched:sched_switch tracepoint,
+ * interleaved with the context switches perf script --show-switch-events
+ * prints, and the header lines also need the tid, time and trace fields.
+ * A stack is weighed by the microseconds until its thread was switched in
+ * again, and gets the state the thread was left in as innermost frame.
+ */
+class PerfScriptParser
+{
+public:
+    enum Mode { CpuSamples, OffCpu };
+
+    explicit PerfScriptParser(Mode mode = CpuSamples);
+
+    void addData(const QByteArray &data);
+    void finish();
+    ProfileData takeData();
+
+private:
+    class SwitchedOut
+    {
+    public:
+        qint64 time = 0;
+        QList<int> stack;
+        QList<int> lines;
+    };
+
+    void parseLine(const QByteArray &line);
+    void parseOffCpuHeader(const QByteArray &line);
+    void finishSample();
+
+    const Mode m_mode;
+    ProfileData m_data;
+    QByteArray m_pending;
+    QList<int> m_stack;
+    QList<int> m_lines;
+    QHash<QByteArray, int> m_frameBySymbolAndModule;
+    qint64 m_sampleTid = -1;   // Off-CPU mode only, from the header of the current sample.
+    qint64 m_sampleTime = 0;
+    QString m_sampleState;
+    QHash<qint64, SwitchedOut> m_switchedOut;
+};
+
+// Runs perf script on dataFile and parses its output while it is produced,
+// meant to be run on a worker thread.
+void loadPerfData(QPromise<ProfileData> &promise, const Utils::FilePath &perf,
+                  const Utils::FilePath &dataFile);
+
+// The same for a recording of the sched:sched_switch tracepoint with
+// context switch events, see PerfScriptParser::OffCpu.
+void loadOffCpuData(QPromise<ProfileData> &promise, const Utils::FilePath &perf,
+                    const Utils::FilePath &dataFile);
+
+} // Rusty::Internal
+
+#endif // PERFPARSER_H
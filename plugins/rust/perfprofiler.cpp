@@ -0,0 +1,363 @@
+#include "perfprofiler.h"
+
+#include "benchmark.h"
+#include "flamegraph.h"
+#include "perfparser.h"
+#include "profiledprogram.h"
+#include "profileview.h"
+#include "rustyconstants.h"
+#include "rusttr.h"
+#include "rustutils.h"
+#include "sourceannotations.h"
+
+#include <coreplugin/icore.h>
+#include <coreplugin/messagemanager.h>
+#include <coreplugin/progressmanager/progressmanager.h>
+
+#include <extensionsystem/pluginmanager.h>
+
+#include <projectexplorer/buildconfiguration.h>
+#include <projectexplorer/project.h>
+#include <projectexplorer/projectexplorer.h>
+#include <projectexplorer/projectmanager.h>
+#include <projectexplorer/target.h>
+
+#include <utils/algorithm.h>
+#include <utils/async.h>
+#include <utils/futuresynchronizer.h>
+#include <utils/layoutbuilder.h>
+#include <utils/pathchooser.h>
+
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QThread>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const char perfScriptTaskId[] = "Rusty.PerfScript";
+const char perfAnnotationsId[] = "Rusty.PerfSamples";
+const char offCpuAnnotationsId[] = "Rusty.OffCpuTime";
+const char perfDiffTaskId[] = "Rusty.PerfDiff";
+
+// Recordings of a long run take hundreds of megabytes each.
+const int keptRecordings = 10;
+
+// Off-CPU recordings go to a subdirectory, they cannot be compared with
+// CPU profiles.
+static FilePath recordingsDirectory(const FilePath &projectDirectory, bool offCpu = false)
+{
+    const FilePath directory = rustyDataDirectory(projectDirectory).pathAppended("perf");
+    return offCpu ? directory.pathAppended("off-cpu") : directory;
+}
+
+// Newest first.
+static FilePaths perfRecordings(const FilePath &directory)
+{
+    return directory.dirEntries(FileFilter({"*.data"}, QDir::Files), QDir::Time);
+}
+
+static void removeOldRecordings(const FilePath &directory)
+{
+    const FilePaths recordings = perfRecordings(directory);
+    for (int i = keptRecordings; i < recordings.size(); ++i)
+        recordings.at(i).removeFile();
+}
+
+// A profile touches thousands of lines, only those with a noticeable share
+// of the samples are annotated.
+const double minimumSelfShare = 0.001;
+const double minimumTotalShare = 0.01;
+
+static SourceAnnotationMap lineAnnotations(const ProfileData &profile)
+{
+    qint64 hottest = 1;
+    for (const QHash<int, qint64> &lines : profile.selfLineSamples) {
+        for (qint64 samples : lines)
+            hottest = qMax(hottest, samples);
+    }
+
+    const auto share = [&profile](qint64 samples) {
+        return QString::number(100.0 * samples / profile.totalSamples, 'f', 1);
+    };
+    SourceAnnotationMap result;
+    for (auto file = profile.totalLineSamples.cbegin(), end = profile.totalLineSamples.cend();
+         file != end; ++file) {
+        const QHash<int, qint64> self = profile.selfLineSamples.value(file.key());
+        for (auto line = file.value().cbegin(), lineEnd = file.value().cend(); line != lineEnd;
+             ++line) {
+            const qint64 selfSamples = self.value(line.key());
+            if (selfSamples < minimumSelfShare * profile.totalSamples
+                && line.value() < minimumTotalShare * profile.totalSamples) {
+                continue;
+            }
+            SourceAnnotation annotation;
+            annotation.line = line.key();
+            annotation.heat = double(selfSamples) / hottest;
+            annotation.text = selfSamples > 0
+                ? Tr::tr("%1 % self, %2 % total").arg(share(selfSamples), share(line.value()))
+                : Tr::tr("%1 % total").arg(share(line.value()));
+            annotation.toolTip = Tr::tr("perf: executing in %1, on the stack in %2")
+                                     .arg(sampleShare(profile, selfSamples),
+                                          sampleShare(profile, line.value()));
+            result[file.key()].append(annotation);
+        }
+    }
+    return result;
+}
+
+// Off-CPU stacks end in the scheduler, there are no self lines. Lines are
+// annotated with the time the thread blocked while they were on the stack.
+static SourceAnnotationMap offCpuAnnotations(const ProfileData &profile)
+{
+    qint64 longest = 1;
+    for (const QHash<int, qint64> &lines : profile.totalLineSamples) {
+        for (qint64 blocked : lines)
+            longest = qMax(longest, blocked);
+    }
+
+    SourceAnnotationMap result;
+    for (auto file = profile.totalLineSamples.cbegin(), end = profile.totalLineSamples.cend();
+         file != end; ++file) {
+        for (auto line = file.value().cbegin(), lineEnd = file.value().cend(); line != lineEnd;
+             ++line) {
+            if (line.value() < minimumTotalShare * profile.totalSamples)
+                continue;
+            SourceAnnotation annotation;
+            annotation.line = line.key();
+            annotation.heat = double(line.value()) / longest;
+            annotation.text = Tr::tr("%1 blocked").arg(formatDuration(line.value() * 1e-6));
+            annotation.toolTip = Tr::tr("perf: on the stack of blocked threads for %1")
+                                     .arg(sampleShare(profile, line.value()));
+            result[file.key()].append(annotation);
+        }
+    }
+    return result;
+}
+
+static void analyzeProfile(const FilePath &perf, const FilePath &dataFile, bool offCpu,
+                           const FilePath &projectDirectory, const QString &title)
+{
+    const QFuture<ProfileData> future
+        = Utils::asyncRun(offCpu ? loadOffCpuData : loadPerfData, perf, dataFile);
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(future);
+    Core::ProgressManager::addTask(future, Tr::tr("Reading perf Profile"), perfScriptTaskId);
+    Utils::onFinished(future, Core::ICore::instance(),
+                      [projectDirectory, title](const QFuture<ProfileData> &future) {
+        if (future.isCanceled())
+            return;
+        try {
+            const auto profile = std::make_shared<const ProfileData>(future.result());
+            // Line samples were attributed by perf from the DWARF line tables
+            // once, while reading the profile.
+            if (profile->weight == ProfileData::Weight::BlockedMicroseconds) {
+                SourceAnnotations::instance()->setAnnotations(offCpuAnnotationsId,
+                                                              Tr::tr("Off-CPU Time"),
+                                                              offCpuAnnotations(*profile),
+                                                              QColor(40, 90, 210));
+            } else {
+                SourceAnnotations::instance()->setAnnotations(perfAnnotationsId,
+                                                              Tr::tr("perf Samples"),
+                                                              lineAnnotations(*profile),
+                                                              QColor(255, 64, 0));
+            }
+            showProfile(profile, title, projectDirectory);
+        } catch (const std::exception &error) {
+            Core::MessageManager::writeFlashing(Tr::tr("Cannot read the perf profile: %1")
+                                                    .arg(QString::fromStdString(error.what())));
+        }
+    });
+}
+
+class PerfRecordRunWorker final : public SimpleTargetRunner
+{
+public:
+    explicit PerfRecordRunWorker(RunControl *runControl)
+        : SimpleTargetRunner(runControl)
+    {
+        setId("PerfRecordRunWorker");
+        m_perf = new ProfiledProgram(runControl, "perf");
+        addStartDependency(m_perf);
+        m_offCpu = runControl->runMode() == Constants::PERF_OFFCPU_RUN_MODE;
+
+        setStartModifier([this, runControl] {
+            // Recordings are kept, so that later ones can be compared to them.
+            const FilePath directory
+                = recordingsDirectory(runControl->project()->projectDirectory(), m_offCpu);
+            removeOldRecordings(directory);
+            m_dataFile = directory.pathAppended(
+                QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz") + ".data");
+            m_dataFile.parentDir().ensureWritableDir();
+            CommandLine command{m_perf->tool(), {"record"}};
+            if (m_offCpu) {
+                // The tracepoint gives the stack a thread blocked in, the
+                // switch events when it ran again. Recording the tracepoint
+                // needs perf_event_paranoid <= 1 or access to tracefs.
+                appendMessage(Tr::tr("Recording the scheduler switches of the program."),
+                              NormalMessageFormat);
+                command.addArgs({"-e", "sched:sched_switch", "--switch-events"});
+            }
+            command.addArgs({"-g", "--call-graph", "dwarf", "-o", m_dataFile.path(), "--"});
+            command.addCommandLineAsArgs(m_perf->commandLine());
+            setCommandLine(command);
+            m_started = QDateTime::currentDateTime();
+        });
+
+        connect(this, &RunWorker::stopped, this, [this, runControl] {
+            // perf also writes the data when the program was stopped by the user.
+            if (!m_started.isValid() || m_dataFile.fileSize() <= 0
+                || m_dataFile.lastModified() < m_started) {
+                return;
+            }
+            appendMessage(Tr::tr("Reading the profile, this can take a while for long "
+                                 "recordings."), NormalMessageFormat);
+            analyzeProfile(m_perf->tool(), m_dataFile, m_offCpu,
+                           runControl->project()->projectDirectory(),
+                           m_offCpu ? Tr::tr("Off-CPU Profile of %1").arg(runControl->displayName())
+                                    : Tr::tr("Profile of %1").arg(runControl->displayName()));
+        });
+    }
+
+private:
+    ProfiledProgram *m_perf = nullptr;
+    FilePath m_dataFile;
+    QDateTime m_started;
+    bool m_offCpu = false;
+};
+
+PerfRecordRunWorkerFactory::PerfRecordRunWorkerFactory()
+{
+    setProduct<PerfRecordRunWorker>();
+    addSupportedRunMode(Constants::PERF_RUN_MODE);
+    addSupportedRunMode(Constants::PERF_OFFCPU_RUN_MODE);
+    addSupportedRunConfig(Constants::C_RUSTRUNCONFIGURATION_ID);
+}
+
+static void loadPerfDiff(QPromise<DifferentialProfile> &promise, const FilePath &perf,
+                         const FilePath &before, const FilePath &after)
+{
+    QFuture<ProfileData> beforeFuture = Utils::asyncRun(loadPerfData, perf, before);
+    QFuture<ProfileData> afterFuture = Utils::asyncRun(loadPerfData, perf, after);
+    // Cancelling the comparison has to stop both perf script runs, and neither
+    // profile is of use once the other one failed.
+    while (!beforeFuture.isFinished() || !afterFuture.isFinished()) {
+        const bool failed = (beforeFuture.isFinished() && beforeFuture.resultCount() == 0)
+                            || (afterFuture.isFinished() && afterFuture.resultCount() == 0);
+        if (promise.isCanceled() || failed) {
+            beforeFuture.cancel();
+            afterFuture.cancel();
+            break;
+        }
+        QThread::msleep(100);
+    }
+    try {
+        // Both runs end before the worker does. This throws the error of a
+        // failed run, a cancelled one has none.
+        beforeFuture.waitForFinished();
+        afterFuture.waitForFinished();
+        if (promise.isCanceled())
+            return;
+        promise.addResult(diffProfiles(beforeFuture.result(), afterFuture.result()));
+    } catch (...) {
+        promise.setException(std::current_exception());
+    }
+}
+
+void comparePerfRecordings()
+{
+    Project *project = ProjectManager::startupProject();
+    if (!project)
+        return;
+    const FilePath projectDirectory = project->projectDirectory();
+    const FilePaths recordings = perfRecordings(recordingsDirectory(projectDirectory));
+
+    QDialog dialog(Core::ICore::dialogParent());
+    dialog.setWindowTitle(Tr::tr("Compare perf Recordings"));
+    const auto recordingChooser = [&](int index) {
+        auto chooser = new PathChooser;
+        chooser->setExpectedKind(PathChooser::File);
+        chooser->setPromptDialogFilter(Tr::tr("perf recordings (*.data)"));
+        chooser->setInitialBrowsePathBackup(recordingsDirectory(projectDirectory));
+        if (index < recordings.size())
+            chooser->setFilePath(recordings.at(index));
+        return chooser;
+    };
+    PathChooser *before = recordingChooser(1);
+    PathChooser *after = recordingChooser(0);
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    QObject::connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    QObject::connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    using namespace Layouting;
+    Column {
+        Tr::tr("Both recordings should be of the same program. By default, the two "
+               "newest recordings of the startup project are compared."),
+        Form {
+            Tr::tr("Before:"), before, br,
+            Tr::tr("After:"), after, br
+        },
+        buttons
+    }.attachTo(&dialog);
+    dialog.resize(700, dialog.sizeHint().height());
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    const FilePath beforeFile = before->filePath();
+    const FilePath afterFile = after->filePath();
+    Environment environment = Environment::systemEnvironment();
+    if (Target *target = project->activeTarget()) {
+        if (BuildConfiguration *bc = target->activeBuildConfiguration())
+            environment = bc->environment();
+    }
+    const QFuture<DifferentialProfile> future
+        = Utils::asyncRun(loadPerfDiff, environment.searchInPath("perf"), beforeFile, afterFile);
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(future);
+    Core::ProgressManager::addTask(future, Tr::tr("Comparing perf Recordings"), perfDiffTaskId);
+    Utils::onFinished(future, Core::ICore::instance(),
+                      [projectDirectory, beforeFile, afterFile](
+                          const QFuture<DifferentialProfile> &future) {
+        if (future.isCanceled())
+            return;
+        try {
+            showProfileDiff(future.result(),
+                            Tr::tr("%1 Compared with %2")
+                                .arg(afterFile.fileName(), beforeFile.fileName()),
+                            projectDirectory);
+        } catch (const std::exception &error) {
+            Core::MessageManager::writeFlashing(Tr::tr("Cannot compare the perf recordings: %1")
+                                                    .arg(QString::fromStdString(error.what())));
+        }
+    });
+}
+
+void profileStartupProject(Id runMode)
+{
+    Target *target = ProjectManager::startupTarget();
+    if (!target)
+        return;
+    // Profiles of unoptimized code are misleading, and without debug
+    // information there are neither call graphs nor source lines.
+    BuildConfiguration *active = target->activeBuildConfiguration();
+    if (!active || active->buildType() != BuildConfiguration::Profile) {
+        BuildConfiguration *profiling
+            = Utils::findOrDefault(target->buildConfigurations(), [](BuildConfiguration *bc) {
+                  return bc->buildType() == BuildConfiguration::Profile;
+              });
+        if (profiling) {
+            ProjectManager::setActiveBuildConfiguration(target, profiling, SetActive::Cascade);
+            Core::MessageManager::writeSilently(
+                Tr::tr("Switched to the profiling build configuration \"%1\".")
+                    .arg(profiling->displayName()));
+        } else {
+            Core::MessageManager::writeFlashing(
+                Tr::tr("%1 has no profiling build configuration (release profile with full "
+                       "debug information), profiling the active one.")
+                    .arg(target->project()->displayName()));
+        }
+    }
+    ProjectExplorerPlugin::runStartupProject(runMode);
+}
+
+} // Rusty::Internal
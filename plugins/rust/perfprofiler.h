@@ -0,0 +1,38 @@
+#ifndef PERFPROFILER_H
+#define PERFPROFILER_H
+
+#include <projectexplorer/runcontrol.h>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Runs a Rust run configuration under perf record
+ *
+ * Used for the perf run mode: the program runs under perf record with DWARF
+ * call graphs, its output goes to the application output as usual. Once it
+ * exits, perf script is parsed on a worker thread and the profile is shown
+ * as flame graph and inverted call tree, the hottest source lines are
+ * annotated in the editors.
+ *
+ * In the off-CPU run mode, the scheduler switches of the program are
+ * recorded instead, and every stack a thread blocked in is weighed by the
+ * time until the thread ran again. Locks, futex waits and blocking system
+ * calls show up in the same views.
+ */
+class PerfRecordRunWorkerFactory final : public ProjectExplorer::RunWorkerFactory
+{
+public:
+    PerfRecordRunWorkerFactory();
+};
+
+// Makes a profiling build configuration of the startup project active, if
+// there is one, and runs the project in the given perf run mode.
+void profileStartupProject(Utils::Id runMode);
+
+// Asks for two recordings of the startup project and shows their
+// differential flame graph.
+void comparePerfRecordings();
+
+} // Rusty::Internal
+
+#endif // PERFPROFILER_H
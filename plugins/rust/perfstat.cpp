@@ -0,0 +1,255 @@
+#include "perfstat.h"
+
+#include "benchmark.h"
+#include "rusttr.h"
+#include "rustutils.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+static FilePath resultsFile(const FilePath &projectDirectory)
+{
+    return rustyDataDirectory(projectDirectory).pathAppended("perf-stat.jsonl");
+}
+
+QStringList defaultPerfStatEvents()
+{
+    // The references and branches are needed for the miss rates.
+    return {"task-clock", "context-switches", "cycles", "instructions", "cache-references",
+            "cache-misses", "branches", "branch-misses"};
+}
+
+std::optional<double> PerfStatResult::value(const QString &event) const
+{
+    for (const CounterValue &counter : counters) {
+        if (counter.event == event)
+            return counter.counted ? std::make_optional(counter.value) : std::nullopt;
+    }
+    return {};
+}
+
+static std::optional<double> ratio(const std::optional<double> &numerator,
+                                   const std::optional<double> &denominator)
+{
+    if (!numerator || !denominator || *denominator <= 0)
+        return {};
+    return *numerator / *denominator;
+}
+
+std::optional<double> PerfStatResult::instructionsPerCycle() const
+{
+    return ratio(value("instructions"), value("cycles"));
+}
+
+std::optional<double> PerfStatResult::cacheMissRate() const
+{
+    return ratio(value("cache-misses"), value("cache-references"));
+}
+
+std::optional<double> PerfStatResult::branchMissRate() const
+{
+    return ratio(value("branch-misses"), value("branches"));
+}
+
+static QString eventName(const QString &event)
+{
+    // "cpu_core/cycles/u" on hybrid CPUs, "cycles:u" with modifiers.
+    QString name = event;
+    const QStringList parts = event.split('/');
+    if (parts.size() >= 3)
+        name = parts.at(1);
+    const int colon = name.indexOf(':');
+    if (colon > 0)
+        name.truncate(colon);
+    return name;
+}
+
+QList<CounterValue> parsePerfStatOutput(const QByteArray &output)
+{
+    QList<CounterValue> counters;
+    for (const QByteArray &rawLine : output.split('\n')) {
+        const QString line = QString::fromUtf8(rawLine).trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+        const QStringList fields = line.split(',');
+        if (fields.size() < 3 || fields.at(2).isEmpty())
+            continue;
+
+        CounterValue counter;
+        counter.event = eventName(fields.at(2));
+        counter.unit = fields.at(1);
+        bool ok = false;
+        counter.value = fields.at(0).toDouble(&ok);
+        counter.counted = ok; // "<not counted>", "<not supported>"
+        if (fields.size() > 4) {
+            const double percentage = fields.at(4).toDouble(&ok);
+            if (ok)
+                counter.enabledShare = percentage / 100;
+        }
+
+        auto existing = std::find_if(counters.begin(), counters.end(),
+                                     [&counter](const CounterValue &other) {
+                                         return other.event == counter.event;
+                                     });
+        if (existing == counters.end()) {
+            counters.append(counter);
+        } else if (counter.counted) {
+            existing->value = existing->counted ? existing->value + counter.value
+                                                : counter.value;
+            existing->enabledShare = existing->counted
+                                         ? qMin(existing->enabledShare, counter.enabledShare)
+                                         : counter.enabledShare;
+            existing->counted = true;
+        }
+    }
+    return counters;
+}
+
+static QString formatCounter(const CounterValue &counter)
+{
+    if (!counter.counted)
+        return Tr::tr("not counted");
+    if (counter.unit == "msec")
+        return Tr::tr("%1 ms").arg(counter.value, 0, 'f', 2);
+    return formatCount(counter.value);
+}
+
+static QString formatPercentage(double share)
+{
+    return QString("%1 %").arg(100 * share, 0, 'f', 2);
+}
+
+QStringList describePerfStat(const PerfStatResult &result)
+{
+    QStringList lines;
+    for (const CounterValue &counter : result.counters) {
+        QString line = QString("%1: %2").arg(counter.event, formatCounter(counter));
+        // perf scales multiplexed counters, which makes them estimates.
+        if (counter.counted && counter.enabledShare < 0.999) {
+            line += ' ' + Tr::tr("(measured %1 of the time)")
+                              .arg(formatPercentage(counter.enabledShare));
+        }
+        lines.append(line);
+    }
+    if (const auto ipc = result.instructionsPerCycle())
+        lines.append(Tr::tr("Instructions per cycle: %1").arg(*ipc, 0, 'f', 2));
+    if (const auto rate = result.cacheMissRate()) {
+        lines.append(Tr::tr("Cache misses: %1 of all cache references")
+                         .arg(formatPercentage(*rate)));
+    }
+    if (const auto rate = result.branchMissRate())
+        lines.append(Tr::tr("Branch misses: %1 of all branches").arg(formatPercentage(*rate)));
+    return lines;
+}
+
+static QString signedPercentage(double change)
+{
+    return QString("%1%2 %").arg(change > 0 ? "+" : "").arg(change, 0, 'f', 1);
+}
+
+QStringList comparePerfStat(const PerfStatResult &result, const PerfStatResult &previous)
+{
+    QStringList lines;
+    for (const CounterValue &counter : result.counters) {
+        const std::optional<double> before = previous.value(counter.event);
+        if (!counter.counted || !before || *before <= 0)
+            continue;
+        const double change = 100 * (counter.value - *before) / *before;
+        lines.append(Tr::tr("%1: %2 (was %3)").arg(counter.event, signedPercentage(change),
+                                                   formatCount(*before)));
+    }
+
+    const auto compareRates = [&lines](const QString &name, const std::optional<double> &after,
+                                       const std::optional<double> &before, bool asPercentage) {
+        if (!after || !before)
+            return;
+        const auto format = [asPercentage](double value) {
+            return asPercentage ? formatPercentage(value) : QString::number(value, 'f', 2);
+        };
+        lines.append(Tr::tr("%1: %2 (was %3)").arg(name, format(*after), format(*before)));
+    };
+    compareRates(Tr::tr("Instructions per cycle"), result.instructionsPerCycle(),
+                 previous.instructionsPerCycle(), false);
+    compareRates(Tr::tr("Cache miss rate"), result.cacheMissRate(), previous.cacheMissRate(),
+                 true);
+    compareRates(Tr::tr("Branch miss rate"), result.branchMissRate(), previous.branchMissRate(),
+                 true);
+    return lines;
+}
+
+static QJsonObject toJson(const PerfStatResult &result)
+{
+    QJsonArray counters;
+    for (const CounterValue &counter : result.counters) {
+        QJsonObject object{{"event", counter.event}, {"counted", counter.counted}};
+        if (counter.counted) {
+            object.insert("value", counter.value);
+            object.insert("enabled", counter.enabledShare);
+        }
+        if (!counter.unit.isEmpty())
+            object.insert("unit", counter.unit);
+        counters.append(object);
+    }
+    return {{"timestamp", result.timestamp.toString(Qt::ISODate)},
+            {"key", result.key},
+            {"name", result.name},
+            {"configuration", result.configuration},
+            {"command", result.command},
+            {"counters", counters}};
+}
+
+static PerfStatResult fromJson(const QJsonObject &object)
+{
+    PerfStatResult result;
+    result.timestamp = QDateTime::fromString(object.value("timestamp").toString(), Qt::ISODate);
+    result.key = object.value("key").toString();
+    result.name = object.value("name").toString();
+    result.configuration = object.value("configuration").toString();
+    result.command = object.value("command").toString();
+    for (const QJsonValue &value : object.value("counters").toArray()) {
+        const QJsonObject counterObject = value.toObject();
+        CounterValue counter;
+        counter.event = counterObject.value("event").toString();
+        counter.counted = counterObject.value("counted").toBool();
+        counter.value = counterObject.value("value").toDouble();
+        counter.enabledShare = counterObject.value("enabled").toDouble(1);
+        counter.unit = counterObject.value("unit").toString();
+        result.counters.append(counter);
+    }
+    return result;
+}
+
+void appendPerfStatResult(const FilePath &projectDirectory, const PerfStatResult &result)
+{
+    const FilePath file = resultsFile(projectDirectory);
+    if (!file.parentDir().ensureWritableDir())
+        return;
+    QFile out(file.toFSPathString());
+    if (out.open(QIODevice::WriteOnly | QIODevice::Append))
+        out.write(QJsonDocument(toJson(result)).toJson(QJsonDocument::Compact) + '\n');
+}
+
+QList<PerfStatResult> loadPerfStatResults(const FilePath &projectDirectory)
+{
+    QList<PerfStatResult> results;
+    const expected_str<QByteArray> contents = resultsFile(projectDirectory).fileContents();
+    if (!contents)
+        return results;
+
+    for (const QByteArray &line : contents->split('\n')) {
+        const QJsonObject object = QJsonDocument::fromJson(line).object();
+        if (!object.isEmpty())
+            results.append(fromJson(object));
+    }
+    return results;
+}
+
+} // Rusty::Internal
@@ -0,0 +1,63 @@
+#ifndef PERFSTAT_H
+#define PERFSTAT_H
+
+#include <utils/filepath.h>
+
+#include <QDateTime>
+#include <QStringList>
+
+#include <optional>
+
+namespace Rusty::Internal {
+
+// Used when the run configuration does not name any events.
+QStringList defaultPerfStatEvents();
+
+class CounterValue
+{
+public:
+    QString event;          // As requested, without PMU prefix and modifiers.
+    double value = 0;       // Scaled by perf if the counter was multiplexed.
+    QString unit;           // "msec" for the software clocks, usually empty.
+    double enabledShare = 1;  // Share of the run time the counter was scheduled.
+    bool counted = true;    // false for "<not counted>" and "<not supported>".
+};
+
+class PerfStatResult
+{
+public:
+    QDateTime timestamp;
+    QString key;            // Build key of the run configuration.
+    QString name;
+    QString configuration;  // Display name of the build configuration.
+    QString command;
+    QList<CounterValue> counters;
+
+    std::optional<double> value(const QString &event) const;
+
+    // Derived metrics, empty if a needed counter was not measured.
+    std::optional<double> instructionsPerCycle() const;
+    std::optional<double> cacheMissRate() const;        // Of cache-references.
+    std::optional<double> branchMissRate() const;       // Of branches.
+};
+
+// Parses the output of perf stat -x , which is one counter per line:
+// value,unit,event,run time,enabled percentage[,metric value,metric unit].
+// Hybrid CPUs report an event once per core type, these are summed up.
+QList<CounterValue> parsePerfStatOutput(const QByteArray &output);
+
+// One line per counter followed by the derived metrics.
+QStringList describePerfStat(const PerfStatResult &result);
+
+// Relative change of every counter and metric present in both results.
+QStringList comparePerfStat(const PerfStatResult &result, const PerfStatResult &previous);
+
+// Results are appended to a file with one JSON object per line below the
+// project's .qtcreator directory. Results are compared with the previous
+// one of the same run and build configuration.
+void appendPerfStatResult(const Utils::FilePath &projectDirectory, const PerfStatResult &result);
+QList<PerfStatResult> loadPerfStatResults(const Utils::FilePath &projectDirectory);
+
+} // Rusty::Internal
+
+#endif // PERFSTAT_H
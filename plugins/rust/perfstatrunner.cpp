@@ -0,0 +1,130 @@
+#include "perfstatrunner.h"
+
+#include "perfstat.h"
+#include "profiledprogram.h"
+#include "rustyconstants.h"
+#include "rusttr.h"
+#include "rustutils.h"
+
+#include <extensionsystem/pluginmanager.h>
+
+#include <projectexplorer/buildconfiguration.h>
+#include <projectexplorer/project.h>
+#include <projectexplorer/target.h>
+
+#include <utils/aspects.h>
+#include <utils/async.h>
+#include <utils/futuresynchronizer.h>
+
+#include <QRegularExpression>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+class PerfStatRunWorker final : public SimpleTargetRunner
+{
+public:
+    explicit PerfStatRunWorker(RunControl *runControl)
+        : SimpleTargetRunner(runControl)
+    {
+        setId("PerfStatRunWorker");
+        m_perf = new ProfiledProgram(runControl, "perf");
+        addStartDependency(m_perf);
+
+        setStartModifier([this, runControl] {
+            // The counters go to a file, the program's own stderr stays untouched.
+            // One per run, several runs of a project may count at once.
+            const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz");
+            m_outputFile = rustyDataDirectory(runControl->project()->projectDirectory())
+                               .pathAppended("perf-stat-" + stamp + ".csv");
+            m_outputFile.parentDir().ensureWritableDir();
+
+            CommandLine command{m_perf->tool(), {"stat", "-x", ",", "-o", m_outputFile.path(),
+                                         "-e", events().join(','), "--"}};
+            // perf writes the counts in the locale, decimal commas would split
+            // the fields. The program keeps the locale it runs in otherwise.
+            Environment environment = runControl->environment();
+            CommandLine program{FilePath::fromString("env")};
+            if (environment.hasKey("LC_ALL"))
+                program.addArg("LC_ALL=" + environment.value("LC_ALL"));
+            else
+                program.addArgs({"-u", "LC_ALL"});
+            program.addCommandLineAsArgs(m_perf->commandLine());
+            command.addCommandLineAsArgs(program);
+            environment.set("LC_ALL", "C");
+            setEnvironment(environment);
+            setCommandLine(command);
+
+            m_result = {};
+            m_result.timestamp = QDateTime::currentDateTime();
+            m_result.key = runControl->buildKey();
+            m_result.name = runControl->displayName();
+            if (BuildConfiguration *bc = runControl->target()->activeBuildConfiguration())
+                m_result.configuration = bc->displayName();
+            m_result.command = m_perf->commandLine().toUserOutput();
+        });
+
+        connect(this, &RunWorker::stopped, this, &PerfStatRunWorker::reportCounters);
+    }
+
+private:
+    QStringList events() const
+    {
+        QStringList events;
+        if (const auto data = static_cast<const StringAspect::Data *>(
+                runControl()->aspect(Id(Constants::PERF_STAT_EVENTS_ID)))) {
+            static const QRegularExpression separator("[,\\s]+");
+            events = data->value.split(separator, Qt::SkipEmptyParts);
+        }
+        return events.isEmpty() ? defaultPerfStatEvents() : events;
+    }
+
+    void reportCounters()
+    {
+        if (!m_result.timestamp.isValid())
+            return;
+        const expected_str<QByteArray> output = m_outputFile.fileContents();
+        m_outputFile.removeFile();
+        m_result.counters = output ? parsePerfStatOutput(*output) : QList<CounterValue>();
+        if (m_result.counters.isEmpty()) {
+            appendMessage(Tr::tr("perf stat did not report any counters."), ErrorMessageFormat);
+            return;
+        }
+        appendMessage(Tr::tr("Hardware counters of %1:").arg(m_result.command),
+                      NormalMessageFormat);
+        appendMessage(describePerfStat(m_result).join('\n'), NormalMessageFormat);
+
+        const FilePath projectDirectory = runControl()->project()->projectDirectory();
+        const QList<PerfStatResult> history = loadPerfStatResults(projectDirectory);
+        for (auto it = history.crbegin(); it != history.crend(); ++it) {
+            if (it->key != m_result.key || it->configuration != m_result.configuration)
+                continue;
+            const QStringList changes = comparePerfStat(m_result, *it);
+            if (!changes.isEmpty()) {
+                appendMessage(Tr::tr("Compared with the run of %1:")
+                                  .arg(it->timestamp.toString(Qt::ISODate)),
+                              NormalMessageFormat);
+                appendMessage(changes.join('\n'), NormalMessageFormat);
+            }
+            break;
+        }
+        ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(
+            Utils::asyncRun(appendPerfStatResult, projectDirectory, m_result));
+        m_result = {};
+    }
+
+    ProfiledProgram *m_perf = nullptr;
+    FilePath m_outputFile;
+    PerfStatResult m_result;
+};
+
+PerfStatRunWorkerFactory::PerfStatRunWorkerFactory()
+{
+    setProduct<PerfStatRunWorker>();
+    addSupportedRunMode(Constants::PERF_STAT_RUN_MODE);
+    addSupportedRunConfig(Constants::C_RUSTRUNCONFIGURATION_ID);
+}
+
+} // Rusty::Internal
@@ -0,0 +1,25 @@
+#ifndef PERFSTATRUNNER_H
+#define PERFSTATRUNNER_H
+
+#include <projectexplorer/runcontrol.h>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Runs a Rust run configuration under perf stat
+ *
+ * Used for the hardware counter run mode: the program runs under perf stat
+ * with the events configured in the run configuration. Once it exits, the
+ * counters with instructions per cycle and the cache and branch miss rates
+ * are printed to the application output and compared with the previous run
+ * of the same run and build configuration.
+ */
+class PerfStatRunWorkerFactory final : public ProjectExplorer::RunWorkerFactory
+{
+public:
+    PerfStatRunWorkerFactory();
+};
+
+} // Rusty::Internal
+
+#endif // PERFSTATRUNNER_H
@@ -0,0 +1,156 @@
+#include "perfstatview.h"
+
+#include "benchmark.h"
+#include "perfstat.h"
+#include "resultutils.h"
+#include "rusttr.h"
+
+#include <projectexplorer/project.h>
+
+#include <utils/layoutbuilder.h>
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QTreeView>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+enum HistoryColumn {
+    NameColumn,
+    DateColumn,
+    ConfigurationColumn,
+    IpcColumn,
+    CacheMissColumn,
+    BranchMissColumn,
+    FirstEventColumn
+};
+
+static QString changeText(double value, const std::optional<double> &previous)
+{
+    if (!previous || *previous <= 0)
+        return {};
+    const double change = 100 * (value - *previous) / *previous;
+    return QString(" (%1%2 %)").arg(change > 0 ? "+" : "").arg(change, 0, 'f', 1);
+}
+
+static QStandardItem *rateItem(const std::optional<double> &rate,
+                               const std::optional<double> &previous, bool asPercentage)
+{
+    if (!rate)
+        return sortedItem({}, -1.0);
+    const QString text = asPercentage ? QString("%1 %").arg(100 * *rate, 0, 'f', 2)
+                                      : QString::number(*rate, 'f', 2);
+    return sortedItem(text + changeText(*rate, previous), *rate);
+}
+
+class PerfStatHistoryView : public QWidget
+{
+public:
+    explicit PerfStatHistoryView(const FilePath &projectDirectory)
+    {
+        setWindowTitle(Tr::tr("Hardware Counter History"));
+        resize(1100, 600);
+
+        m_proxy.setSourceModel(&m_model);
+        m_proxy.setSortRole(Qt::UserRole);
+        auto view = new QTreeView;
+        view->setModel(&m_proxy);
+        view->setRootIsDecorated(false);
+        view->setSortingEnabled(true);
+        view->setUniformRowHeights(true);
+        view->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+        const QList<PerfStatResult> results = loadPerfStatResults(projectDirectory);
+        auto summary = new QLabel(results.isEmpty()
+            ? Tr::tr("No hardware counters recorded yet. Run a Rust run configuration with "
+                     "Tools > Rusty > Count Hardware Events of Startup Project.")
+            : Tr::tr("%n runs recorded. Changes are relative to the previous run of the same "
+                     "run and build configuration.", nullptr, results.size()));
+
+        using namespace Layouting;
+        Column {
+            summary,
+            view
+        }.attachTo(this);
+
+        fill(results);
+        view->sortByColumn(DateColumn, Qt::DescendingOrder);
+    }
+
+private:
+    void fill(const QList<PerfStatResult> &results)
+    {
+        QStringList events;
+        for (const PerfStatResult &result : results) {
+            for (const CounterValue &counter : result.counters) {
+                if (!events.contains(counter.event))
+                    events.append(counter.event);
+            }
+        }
+        m_model.setHorizontalHeaderLabels(QStringList{Tr::tr("Run Configuration"),
+                                                      Tr::tr("Date"),
+                                                      Tr::tr("Build Configuration"),
+                                                      Tr::tr("IPC"),
+                                                      Tr::tr("Cache Misses"),
+                                                      Tr::tr("Branch Misses")}
+                                          + events);
+
+        QHash<QString, const PerfStatResult *> previousRuns;
+        for (const PerfStatResult &result : results) {
+            const QString group = result.key + '\n' + result.configuration;
+            const PerfStatResult *previous = previousRuns.value(group);
+            previousRuns.insert(group, &result);
+            const auto previousValue = [previous](auto metric) -> std::optional<double> {
+                return previous ? metric(*previous) : std::nullopt;
+            };
+
+            QList<QStandardItem *> row{
+                textItem(result.name),
+                sortedItem(result.timestamp.toString(Qt::ISODate), result.timestamp),
+                textItem(result.configuration),
+                rateItem(result.instructionsPerCycle(),
+                         previousValue([](const PerfStatResult &r) {
+                             return r.instructionsPerCycle();
+                         }),
+                         false),
+                rateItem(result.cacheMissRate(),
+                         previousValue([](const PerfStatResult &r) { return r.cacheMissRate(); }),
+                         true),
+                rateItem(result.branchMissRate(),
+                         previousValue([](const PerfStatResult &r) { return r.branchMissRate(); }),
+                         true)};
+            row.first()->setToolTip(result.command);
+            for (const QString &event : std::as_const(events)) {
+                const std::optional<double> value = result.value(event);
+                if (!value) {
+                    row.append(sortedItem({}, -1.0));
+                    continue;
+                }
+                const std::optional<double> before = previous ? previous->value(event)
+                                                               : std::nullopt;
+                QStandardItem *eventItem
+                    = sortedItem(formatCount(*value) + changeText(*value, before), *value);
+                eventItem->setToolTip(QString::number(*value, 'f', 0));
+                row.append(eventItem);
+            }
+            m_model.appendRow(row);
+        }
+    }
+
+    QStandardItemModel m_model;
+    QSortFilterProxyModel m_proxy;
+};
+
+void showPerfStatHistory(ProjectExplorer::Project *project)
+{
+    if (!project)
+        return;
+    auto view = new PerfStatHistoryView(project->projectDirectory());
+    showResultWindow(view);
+}
+
+} // Rusty::Internal
@@ -0,0 +1,12 @@
+#ifndef PERFSTATVIEW_H
+#define PERFSTATVIEW_H
+
+namespace ProjectExplorer { class Project; }
+
+namespace Rusty::Internal {
+
+void showPerfStatHistory(ProjectExplorer::Project *project);
+
+} // Rusty::Internal
+
+#endif // PERFSTATVIEW_H
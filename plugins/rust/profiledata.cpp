@@ -0,0 +1,118 @@
+#include "profiledata.h"
+
+#include <QSet>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+int ProfileFrame::hottestLine() const
+{
+    int line = -1;
+    qint64 samples = 0;
+    for (auto it = lines.cbegin(), end = lines.cend(); it != end; ++it) {
+        if (it.value() > samples || (it.value() == samples && it.key() < line)) {
+            line = it.key();
+            samples = it.value();
+        }
+    }
+    return line;
+}
+
+CallTree::CallTree()
+    : m_nodes(1)
+{}
+
+int CallTree::child(int node, int frame) const
+{
+    return m_childIndex.value(quint64(node) << 32 | quint32(frame), -1);
+}
+
+int CallTree::addChild(int node, int frame)
+{
+    const quint64 key = quint64(node) << 32 | quint32(frame);
+    const auto it = m_childIndex.constFind(key);
+    if (it != m_childIndex.constEnd())
+        return *it;
+    const int index = int(m_nodes.size());
+    CallTreeNode child;
+    child.frame = frame;
+    child.parent = node;
+    m_nodes.push_back(child);
+    m_nodes[node].children.append(index);
+    m_childIndex.insert(key, index);
+    return index;
+}
+
+void CallTree::addStack(const QList<int> &frames, qint64 weight)
+{
+    int node = 0;
+    m_nodes[0].samples += weight;
+    for (int frame : frames) {
+        node = addChild(node, frame);
+        m_nodes[node].samples += weight;
+    }
+    m_nodes[node].selfSamples += weight;
+}
+
+QList<int> CallTree::path(int node) const
+{
+    QList<int> frames;
+    for (; node > 0; node = m_nodes.at(node).parent)
+        frames.prepend(m_nodes.at(node).frame);
+    return frames;
+}
+
+int ProfileData::frameIndex(const QString &symbol, const QString &module)
+{
+    const QPair<QString, QString> key(symbol, module);
+    const auto it = m_frameIndex.constFind(key);
+    if (it != m_frameIndex.constEnd())
+        return *it;
+    ProfileFrame frame;
+    frame.symbol = symbol;
+    frame.module = module;
+    frames.append(frame);
+    m_frameIndex.insert(key, frames.size() - 1);
+    return frames.size() - 1;
+}
+
+void ProfileData::addSample(const QList<int> &stack, const QList<int> &lines, qint64 weight)
+{
+    callTree.addStack(QList<int>(stack.crbegin(), stack.crend()), weight);
+    totalSamples += weight;
+
+    // Recursion puts the same line on the stack several times, it still was
+    // on the stack in only one sample.
+    QSet<QPair<int, int>> seen;
+    for (int i = 0; i < stack.size(); ++i) {
+        const int line = lines.value(i, -1);
+        if (line <= 0)
+            continue;
+        ProfileFrame &frame = frames[stack.at(i)];
+        frame.lines[line] += weight;
+        if (frame.file.isEmpty())
+            continue;
+        if (i == 0)
+            selfLineSamples[frame.file][line] += weight;
+        if (!seen.contains({stack.at(i), line})) {
+            seen.insert({stack.at(i), line});
+            totalLineSamples[frame.file][line] += weight;
+        }
+    }
+}
+
+CallTree ProfileData::invertedCallTree() const
+{
+    CallTree inverted;
+    const std::vector<CallTreeNode> &nodes = callTree.nodes();
+    for (int i = 1; i < int(nodes.size()); ++i) {
+        if (nodes.at(i).selfSamples == 0)
+            continue;
+        const QList<int> path = callTree.path(i);
+        inverted.addStack(QList<int>(path.crbegin(), path.crend()), nodes.at(i).selfSamples);
+    }
+    return inverted;
+}
+
+} // Rusty::Internal
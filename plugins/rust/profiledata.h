@@ -0,0 +1,92 @@
+#ifndef PROFILEDATA_H
+#define PROFILEDATA_H
+
+#include <utils/filepath.h>
+
+#include <QHash>
+
+#include <vector>
+
+namespace Rusty::Internal {
+
+// A function as it appears in samples, the same symbol in two modules is
+// two frames.
+class ProfileFrame
+{
+public:
+    QString symbol;
+    QString module;             // File name of the binary or library.
+    Utils::FilePath file;       // Source file, if debug information was available.
+    QHash<int, qint64> lines;   // Samples per source line this frame was seen at.
+
+    int hottestLine() const;
+};
+
+class CallTreeNode
+{
+public:
+    int frame = -1;       // -1 for the root.
+    int parent = -1;
+    qint64 samples = 0;   // Inclusive.
+    qint64 selfSamples = 0;
+    QList<int> children;
+};
+
+/**
+ * @brief A call tree over the frames of a ProfileData
+ *
+ * Nodes are stored in a flat vector, node 0 is the root which stands for the
+ * whole program. Stacks are added outermost frame first.
+ */
+class CallTree
+{
+public:
+    CallTree();
+
+    const std::vector<CallTreeNode> &nodes() const { return m_nodes; }
+    const CallTreeNode &node(int index) const { return m_nodes.at(index); }
+    const CallTreeNode &root() const { return m_nodes.front(); }
+
+    void addStack(const QList<int> &frames, qint64 weight);
+    int child(int node, int frame) const; // -1 if there is no such child.
+    QList<int> path(int node) const;      // Frames from the outermost one down to node.
+
+private:
+    int addChild(int node, int frame);
+
+    std::vector<CallTreeNode> m_nodes;
+    QHash<quint64, int> m_childIndex; // (node << 32 | frame) -> child node.
+};
+
+class ProfileData
+{
+public:
+    // CPU profiles count samples, off-CPU profiles weigh every stack by the
+    // time a thread was blocked in it.
+    enum class Weight { Samples, BlockedMicroseconds };
+
+    Weight weight = Weight::Samples;
+    QList<ProfileFrame> frames;
+    CallTree callTree;           // Callers above callees.
+    qint64 totalSamples = 0;
+
+    // Samples per source line, self: the line was executing, total: the line
+    // was executing or called what was executing.
+    QHash<Utils::FilePath, QHash<int, qint64>> selfLineSamples;
+    QHash<Utils::FilePath, QHash<int, qint64>> totalLineSamples;
+
+    int frameIndex(const QString &symbol, const QString &module);
+    // Adds a sample, innermost frame first as profilers print them. Lines
+    // are the source lines of the frames, -1 if unknown.
+    void addSample(const QList<int> &stack, const QList<int> &lines, qint64 weight = 1);
+
+    // Innermost functions at the top level, their callers below them.
+    CallTree invertedCallTree() const;
+
+private:
+    QHash<QPair<QString, QString>, int> m_frameIndex;
+};
+
+} // Rusty::Internal
+
+#endif // PROFILEDATA_H
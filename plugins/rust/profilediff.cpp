@@ -0,0 +1,105 @@
+#include "profilediff.h"
+
+namespace Rusty::Internal {
+
+class FrameSamples
+{
+public:
+    QList<qint64> self;
+    QList<qint64> total;
+};
+
+// Self and inclusive samples per frame. A frame that recurses is counted
+// once per stack for its inclusive samples.
+static FrameSamples frameSamples(const ProfileData &profile)
+{
+    FrameSamples result;
+    result.self.fill(0, profile.frames.size());
+    result.total.fill(0, profile.frames.size());
+    QList<int> onStack(profile.frames.size(), 0);
+
+    const CallTree &tree = profile.callTree;
+    QList<QPair<int, bool>> pending{{0, false}}; // Node, leaving it.
+    while (!pending.isEmpty()) {
+        const auto [index, leaving] = pending.takeLast();
+        const CallTreeNode &node = tree.node(index);
+        if (leaving) {
+            --onStack[node.frame];
+            continue;
+        }
+        if (node.frame >= 0) {
+            result.self[node.frame] += node.selfSamples;
+            if (onStack.at(node.frame) == 0)
+                result.total[node.frame] += node.samples;
+            ++onStack[node.frame];
+            pending.append({index, true});
+        }
+        for (int child : node.children)
+            pending.append({child, false});
+    }
+    return result;
+}
+
+DifferentialProfile diffProfiles(const ProfileData &before, const ProfileData &after)
+{
+    DifferentialProfile result;
+    result.samplesBefore = before.totalSamples;
+
+    auto merged = std::make_shared<ProfileData>(after);
+    QList<int> frameMap;
+    frameMap.reserve(before.frames.size());
+    for (const ProfileFrame &frame : before.frames) {
+        const int index = merged->frameIndex(frame.symbol, frame.module);
+        ProfileFrame &mergedFrame = merged->frames[index];
+        if (mergedFrame.file.isEmpty()) {
+            mergedFrame.file = frame.file;
+            mergedFrame.lines = frame.lines;
+        }
+        frameMap.append(index);
+    }
+
+    // Walk both trees in parallel, a node of the earlier profile that has no
+    // counterpart in the later one disappeared and only shows in the
+    // function deltas.
+    const CallTree &mergedTree = merged->callTree;
+    QList<double> shareBefore(int(mergedTree.nodes().size()), 0.0);
+    const double totalBefore = qMax<qint64>(1, before.totalSamples);
+    const double totalAfter = qMax<qint64>(1, after.totalSamples);
+    shareBefore[0] = before.totalSamples > 0 ? 1.0 : 0.0;
+    QList<QPair<int, int>> pending{{0, 0}};
+    while (!pending.isEmpty()) {
+        const auto [beforeIndex, mergedIndex] = pending.takeLast();
+        for (int child : before.callTree.node(beforeIndex).children) {
+            const CallTreeNode &node = before.callTree.node(child);
+            const int mergedChild = mergedTree.child(mergedIndex, frameMap.at(node.frame));
+            if (mergedChild < 0)
+                continue;
+            shareBefore[mergedChild] = node.samples / totalBefore;
+            pending.append({child, mergedChild});
+        }
+    }
+    result.nodeDeltas.reserve(shareBefore.size());
+    for (int i = 0; i < shareBefore.size(); ++i)
+        result.nodeDeltas.append(mergedTree.node(i).samples / totalAfter - shareBefore.at(i));
+
+    const FrameSamples samplesBefore = frameSamples(before);
+    const FrameSamples samplesAfter = frameSamples(after);
+    result.functions.resize(merged->frames.size());
+    for (int i = 0; i < result.functions.size(); ++i) {
+        result.functions[i].frame = i;
+        if (i < samplesAfter.self.size()) {
+            result.functions[i].selfAfter = samplesAfter.self.at(i) / totalAfter;
+            result.functions[i].totalAfter = samplesAfter.total.at(i) / totalAfter;
+        }
+    }
+    for (int i = 0; i < frameMap.size(); ++i) {
+        FunctionDelta &function = result.functions[frameMap.at(i)];
+        function.selfBefore = samplesBefore.self.at(i) / totalBefore;
+        function.totalBefore = samplesBefore.total.at(i) / totalBefore;
+    }
+
+    result.profile = merged;
+    return result;
+}
+
+} // Rusty::Internal
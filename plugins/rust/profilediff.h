@@ -0,0 +1,45 @@
+#ifndef PROFILEDIFF_H
+#define PROFILEDIFF_H
+
+#include "profiledata.h"
+
+#include <memory>
+
+namespace Rusty::Internal {
+
+// Shares are fractions of all samples of the respective profile.
+class FunctionDelta
+{
+public:
+    int frame = -1;
+    double selfBefore = 0;
+    double selfAfter = 0;
+    double totalBefore = 0;
+    double totalAfter = 0;
+
+    double selfDelta() const { return selfAfter - selfBefore; }
+    double totalDelta() const { return totalAfter - totalBefore; }
+};
+
+/**
+ * @brief The difference between two profiles of the same program
+ *
+ * The call tree is the one of the later profile, its frames also include
+ * those only found in the earlier one. Profiles differ in length, so all
+ * comparisons are between shares of the total samples rather than sample
+ * counts.
+ */
+class DifferentialProfile
+{
+public:
+    std::shared_ptr<const ProfileData> profile;
+    QList<double> nodeDeltas;         // Per call tree node, share after minus share before.
+    QList<FunctionDelta> functions;   // Per frame.
+    qint64 samplesBefore = 0;
+};
+
+DifferentialProfile diffProfiles(const ProfileData &before, const ProfileData &after);
+
+} // Rusty::Internal
+
+#endif // PROFILEDIFF_H
@@ -0,0 +1,40 @@
+#include "profiledprogram.h"
+
+#include "rustrunconfiguration.h"
+#include "rusttr.h"
+
+#include <projectexplorer/runconfigurationaspects.h>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+ProfiledProgram::ProfiledProgram(RunControl *runControl, const QString &toolName)
+    : RunWorker(runControl)
+    , m_toolName(toolName)
+{
+    setId("ProfiledProgram");
+}
+
+void ProfiledProgram::start()
+{
+    m_tool = runControl()->buildEnvironment().searchInPath(m_toolName);
+    if (m_tool.isEmpty()) {
+        reportFailure(Tr::tr("%1 was not found in PATH.").arg(m_toolName));
+        return;
+    }
+    const FilePath executable = freshArtifact(runControl()->target(), runControl()->buildKey());
+    if (executable.isEmpty()) {
+        reportFailure(Tr::tr("The executable of \"%1\" is out of date or was not built by the "
+                             "active build configuration. Build the project first.")
+                          .arg(runControl()->displayName()));
+        return;
+    }
+    m_commandLine = CommandLine(executable);
+    if (const auto arguments = runControl()->aspect<ArgumentsAspect>())
+        m_commandLine.addArgs(arguments->arguments, CommandLine::Raw);
+    reportStarted();
+}
+
+} // Rusty::Internal
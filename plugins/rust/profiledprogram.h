@@ -0,0 +1,35 @@
+#ifndef PROFILEDPROGRAM_H
+#define PROFILEDPROGRAM_H
+
+#include <projectexplorer/runcontrol.h>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Start dependency of the run workers that run a program under a tool
+ *
+ * Looks up the tool (perf, valgrind) in the build environment and the
+ * executable of the last build, and fails the run before anything was
+ * started if either is missing. Under "cargo run" the tool would profile
+ * cargo's up-to-date check and build, valgrind does not even follow into
+ * the program.
+ */
+class ProfiledProgram final : public ProjectExplorer::RunWorker
+{
+public:
+    ProfiledProgram(ProjectExplorer::RunControl *runControl, const QString &toolName);
+
+    Utils::FilePath tool() const { return m_tool; }
+    Utils::CommandLine commandLine() const { return m_commandLine; }   // Of the executable.
+
+private:
+    void start() final;
+
+    const QString m_toolName;
+    Utils::FilePath m_tool;
+    Utils::CommandLine m_commandLine;
+};
+
+} // Rusty::Internal
+
+#endif // PROFILEDPROGRAM_H
@@ -0,0 +1,292 @@
+#include "profileview.h"
+
+#include "benchmark.h"
+#include "flamegraph.h"
+#include "resultutils.h"
+#include "rusttr.h"
+
+#include <coreplugin/editormanager/editormanager.h>
+
+#include <utils/layoutbuilder.h>
+#include <utils/link.h>
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QScrollArea>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QTabWidget>
+#include <QTreeView>
+
+#include <climits>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const int FrameRole = Qt::UserRole + 1;
+
+// Functions below this share of the samples in both profiles are not
+// listed in the differential table.
+const double minimumComparedShare = 0.001;
+
+// Callers contributing less than this share of the samples are left out of
+// the inverted tree, they would make up most of its rows.
+const double minimumCallerShare = 0.0001;
+
+void openProfileFrame(const ProfileFrame &frame)
+{
+    if (frame.file.isEmpty() || !frame.file.exists())
+        return;
+    Core::EditorManager::openEditorAt(Link(frame.file, frame.hottestLine()));
+}
+
+static QStandardItem *sampleItem(const ProfileData &profile, qint64 samples)
+{
+    auto item = new QStandardItem(
+        QString("%1 %").arg(100.0 * samples / qMax<qint64>(1, profile.totalSamples), 0, 'f', 2));
+    item->setData(samples, Qt::UserRole);
+    item->setToolTip(sampleShare(profile, samples));
+    item->setEditable(false);
+    return item;
+}
+
+class InvertedCallTreeView : public QTreeView
+{
+public:
+    InvertedCallTreeView(const std::shared_ptr<const ProfileData> &profile)
+        : m_profile(profile)
+    {
+        const bool offCpu = profile->weight == ProfileData::Weight::BlockedMicroseconds;
+        m_model.setHorizontalHeaderLabels({Tr::tr("Function"),
+                                           offCpu ? Tr::tr("Blocked") : Tr::tr("Samples"),
+                                           Tr::tr("Module"), Tr::tr("Location")});
+        const CallTree inverted = profile->invertedCallTree();
+        const qint64 minimumSamples = qint64(profile->totalSamples * minimumCallerShare);
+
+        // Breadth first, items are created for a node's children once the
+        // node itself has its item.
+        QList<QPair<int, QStandardItem *>> pending{{0, m_model.invisibleRootItem()}};
+        while (!pending.isEmpty()) {
+            const auto [index, parentItem] = pending.takeFirst();
+            for (int child : inverted.node(index).children) {
+                const CallTreeNode &node = inverted.node(child);
+                if (node.samples < minimumSamples)
+                    continue;
+                const ProfileFrame &frame = profile->frames.at(node.frame);
+                auto name = new QStandardItem(frame.symbol);
+                name->setData(frame.symbol, Qt::UserRole);
+                name->setData(node.frame, FrameRole);
+                name->setToolTip(frame.symbol);
+                name->setEditable(false);
+                auto module = new QStandardItem(frame.module);
+                module->setData(frame.module, Qt::UserRole);
+                module->setEditable(false);
+                const QString location = frame.file.isEmpty()
+                    ? QString()
+                    : QString("%1:%2").arg(frame.file.fileName()).arg(frame.hottestLine());
+                auto locationItem = new QStandardItem(location);
+                locationItem->setData(location, Qt::UserRole);
+                locationItem->setToolTip(frame.file.toUserOutput());
+                locationItem->setEditable(false);
+                parentItem->appendRow({name, sampleItem(*profile, node.samples),
+                                       module, locationItem});
+                pending.append({child, name});
+            }
+        }
+
+        m_proxy.setSourceModel(&m_model);
+        m_proxy.setSortRole(Qt::UserRole);
+        setModel(&m_proxy);
+        setSortingEnabled(true);
+        setUniformRowHeights(true);
+        sortByColumn(1, Qt::DescendingOrder);
+        header()->setSectionResizeMode(0, QHeaderView::Interactive);
+        header()->resizeSection(0, 500);
+
+        connect(this, &QTreeView::activated, this, [this](const QModelIndex &index) {
+            const QVariant frame = index.siblingAtColumn(0).data(FrameRole);
+            if (frame.isValid())
+                openProfileFrame(m_profile->frames.at(frame.toInt()));
+        });
+    }
+
+private:
+    const std::shared_ptr<const ProfileData> m_profile;
+    QStandardItemModel m_model;
+    QSortFilterProxyModel m_proxy;
+};
+
+class ProfileView : public QWidget
+{
+public:
+    ProfileView(const std::shared_ptr<const ProfileData> &profile, const QString &title,
+                const FilePath &projectDirectory)
+    {
+        setWindowTitle(title);
+        resize(1100, 700);
+
+        auto flameGraph = new FlameGraphWidget;
+        flameGraph->setProfile(profile, projectDirectory);
+        connect(flameGraph, &FlameGraphWidget::frameActivated, this, [profile](int frame) {
+            openProfileFrame(profile->frames.at(frame));
+        });
+        auto scrollArea = new QScrollArea;
+        scrollArea->setWidget(flameGraph);
+        scrollArea->setWidgetResizable(true);
+        scrollArea->setAlignment(Qt::AlignBottom);
+
+        auto tabs = new QTabWidget;
+        tabs->addTab(scrollArea, Tr::tr("Flame Graph"));
+        tabs->addTab(new InvertedCallTreeView(profile), Tr::tr("Inverted Call Tree"));
+
+        auto summary = new QLabel(
+            profile->weight == ProfileData::Weight::BlockedMicroseconds
+                ? Tr::tr("%1 blocked in %2 functions, the topmost frame tells how the thread "
+                         "waited. Click a frame to open its source line.")
+                      .arg(formatDuration(profile->totalSamples * 1e-6))
+                      .arg(profile->frames.size())
+                : Tr::tr("%n samples in %1 functions. Click a frame to open its hottest source "
+                         "line.", nullptr, int(qMin<qint64>(profile->totalSamples, INT_MAX)))
+                      .arg(profile->frames.size()));
+
+        using namespace Layouting;
+        Column {
+            summary,
+            tabs
+        }.attachTo(this);
+    }
+};
+
+static QStandardItem *shareItem(double share, bool signedValue = false)
+{
+    const QString sign = signedValue && share > 0 ? QString("+") : QString();
+    auto item = new QStandardItem(QString("%1%2 %").arg(sign).arg(100 * share, 0, 'f', 2));
+    item->setData(share, Qt::UserRole);
+    item->setEditable(false);
+    if (signedValue && share != 0)
+        item->setForeground(share > 0 ? QColor(200, 40, 30) : QColor(40, 90, 210));
+    return item;
+}
+
+class FunctionDeltaView : public QTreeView
+{
+public:
+    explicit FunctionDeltaView(const DifferentialProfile &diff)
+        : m_profile(diff.profile)
+    {
+        m_model.setHorizontalHeaderLabels({Tr::tr("Function"), Tr::tr("Module"),
+                                           Tr::tr("Self Before"), Tr::tr("Self After"),
+                                           Tr::tr("Self Change"), Tr::tr("Total Before"),
+                                           Tr::tr("Total After"), Tr::tr("Total Change")});
+        for (const FunctionDelta &function : diff.functions) {
+            if (qMax(function.totalBefore, function.totalAfter) < minimumComparedShare)
+                continue;
+            const ProfileFrame &frame = m_profile->frames.at(function.frame);
+            auto name = new QStandardItem(frame.symbol);
+            name->setData(frame.symbol, Qt::UserRole);
+            name->setData(function.frame, FrameRole);
+            name->setToolTip(frame.symbol);
+            name->setEditable(false);
+            auto module = new QStandardItem(frame.module);
+            module->setData(frame.module, Qt::UserRole);
+            module->setEditable(false);
+            m_model.appendRow({name, module, shareItem(function.selfBefore),
+                               shareItem(function.selfAfter), shareItem(function.selfDelta(), true),
+                               shareItem(function.totalBefore), shareItem(function.totalAfter),
+                               shareItem(function.totalDelta(), true)});
+        }
+
+        m_proxy.setSourceModel(&m_model);
+        m_proxy.setSortRole(Qt::UserRole);
+        setModel(&m_proxy);
+        setRootIsDecorated(false);
+        setSortingEnabled(true);
+        setUniformRowHeights(true);
+        sortByColumn(4, Qt::DescendingOrder);
+        header()->setSectionResizeMode(0, QHeaderView::Interactive);
+        header()->resizeSection(0, 450);
+
+        connect(this, &QTreeView::activated, this, [this](const QModelIndex &index) {
+            const QVariant frame = index.siblingAtColumn(0).data(FrameRole);
+            if (frame.isValid())
+                openProfileFrame(m_profile->frames.at(frame.toInt()));
+        });
+    }
+
+private:
+    const std::shared_ptr<const ProfileData> m_profile;
+    QStandardItemModel m_model;
+    QSortFilterProxyModel m_proxy;
+};
+
+class ProfileDiffView : public QWidget
+{
+public:
+    ProfileDiffView(const DifferentialProfile &diff, const QString &title,
+                    const FilePath &projectDirectory)
+    {
+        setWindowTitle(title);
+        resize(1100, 700);
+
+        const std::shared_ptr<const ProfileData> profile = diff.profile;
+        auto flameGraph = new FlameGraphWidget;
+        flameGraph->setProfile(profile, projectDirectory);
+        flameGraph->setNodeDeltas(diff.nodeDeltas);
+        connect(flameGraph, &FlameGraphWidget::frameActivated, this, [profile](int frame) {
+            openProfileFrame(profile->frames.at(frame));
+        });
+        auto scrollArea = new QScrollArea;
+        scrollArea->setWidget(flameGraph);
+        scrollArea->setWidgetResizable(true);
+        scrollArea->setAlignment(Qt::AlignBottom);
+
+        auto tabs = new QTabWidget;
+        tabs->addTab(new FunctionDeltaView(diff), Tr::tr("Functions"));
+        tabs->addTab(scrollArea, Tr::tr("Differential Flame Graph"));
+
+        const auto mostChanged = [&diff](bool regressed) {
+            const FunctionDelta *result = nullptr;
+            for (const FunctionDelta &function : diff.functions) {
+                const double delta = regressed ? function.selfDelta() : -function.selfDelta();
+                if (delta > 0 && (!result || delta > (regressed ? result->selfDelta()
+                                                                : -result->selfDelta()))) {
+                    result = &function;
+                }
+            }
+            return result ? Tr::tr("%1 (%2%3 percentage points)")
+                                .arg(diff.profile->frames.at(result->frame).symbol,
+                                     regressed ? QString("+") : QString())
+                                .arg(100 * result->selfDelta(), 0, 'f', 2)
+                           : Tr::tr("none");
+        };
+        auto summary = new QLabel(Tr::tr("Shares of all samples, %1 samples before and %2 "
+                                         "after. Red frames got more expensive, blue ones "
+                                         "cheaper.\nMost regressed: %3\nMost improved: %4")
+                                      .arg(diff.samplesBefore).arg(profile->totalSamples)
+                                      .arg(mostChanged(true), mostChanged(false)));
+        summary->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+        using namespace Layouting;
+        Column {
+            summary,
+            tabs
+        }.attachTo(this);
+    }
+};
+
+void showProfileDiff(const DifferentialProfile &diff, const QString &title,
+                     const FilePath &projectDirectory)
+{
+    auto view = new ProfileDiffView(diff, title, projectDirectory);
+    showResultWindow(view);
+}
+
+void showProfile(const std::shared_ptr<const ProfileData> &profile, const QString &title,
+                 const FilePath &projectDirectory)
+{
+    auto view = new ProfileView(profile, title, projectDirectory);
+    showResultWindow(view);
+}
+
+} // Rusty::Internal
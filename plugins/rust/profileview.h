@@ -0,0 +1,25 @@
+#ifndef PROFILEVIEW_H
+#define PROFILEVIEW_H
+
+#include "profiledata.h"
+#include "profilediff.h"
+
+#include <memory>
+
+namespace Rusty::Internal {
+
+// Opens the source line a frame spent most samples at.
+void openProfileFrame(const ProfileFrame &frame);
+
+// Shows the flame graph and the inverted call tree of a profile.
+void showProfile(const std::shared_ptr<const ProfileData> &profile, const QString &title,
+                 const Utils::FilePath &projectDirectory);
+
+// Shows the differential flame graph of two profiles and the functions whose
+// share of the samples changed most.
+void showProfileDiff(const DifferentialProfile &diff, const QString &title,
+                     const Utils::FilePath &projectDirectory);
+
+} // Rusty::Internal
+
+#endif // PROFILEVIEW_H
@@ -0,0 +1,39 @@
+#include "resultutils.h"
+
+#include "benchmark.h"
+
+#include <coreplugin/icore.h>
+
+#include <QStandardItem>
+#include <QWidget>
+
+namespace Rusty::Internal {
+
+QStandardItem *sortedItem(const QString &text, const QVariant &sortValue)
+{
+    auto item = new QStandardItem(text);
+    item->setData(sortValue, Qt::UserRole);
+    item->setEditable(false);
+    return item;
+}
+
+QStandardItem *textItem(const QString &text)
+{
+    return sortedItem(text, text);
+}
+
+QStandardItem *countItem(qint64 count)
+{
+    QStandardItem *item = sortedItem(formatCount(count), count);
+    item->setToolTip(QString::number(count));
+    return item;
+}
+
+void showResultWindow(QWidget *view)
+{
+    view->setParent(Core::ICore::dialogParent(), Qt::Window);
+    view->setAttribute(Qt::WA_DeleteOnClose);
+    view->show();
+}
+
+} // Rusty::Internal
@@ -0,0 +1,33 @@
+#ifndef RESULTUTILS_H
+#define RESULTUTILS_H
+
+#include <QPromise>
+#include <QVariant>
+
+#include <stdexcept>
+
+QT_BEGIN_NAMESPACE
+class QStandardItem;
+class QWidget;
+QT_END_NAMESPACE
+
+namespace Rusty::Internal {
+
+// Values are displayed formatted but sorted by their number.
+QStandardItem *sortedItem(const QString &text, const QVariant &sortValue);
+QStandardItem *textItem(const QString &text);
+QStandardItem *countItem(qint64 count);
+
+// Shows a result view as a window of its own, which is deleted when closed.
+void showResultWindow(QWidget *view);
+
+// The worker's error is rethrown by QFuture::result() on the GUI thread.
+template<typename T>
+void reportWorkerFailure(QPromise<T> &promise, const QString &error)
+{
+    promise.setException(std::make_exception_ptr(std::runtime_error(error.toStdString())));
+}
+
+} // Rusty::Internal
+
+#endif // RESULTUTILS_H
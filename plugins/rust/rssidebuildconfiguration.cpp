@@ -3,26 +3,52 @@
 
 #include "rssidebuildconfiguration.h"
 
+#include "buildhistory.h"
+#include "cargobuildscheduler.h"
+#include "cargooutputparser.h"
+#include "cargotimings.h"
+#include "optimizationremarks.h"
 #include "rustyconstants.h"
 #include "rustproject.h"
 #include "rusttr.h"
+#include "rustutils.h"
+
+#include <coreplugin/messagemanager.h>
+
+#include <extensionsystem/pluginmanager.h>
 
 #include <projectexplorer/buildinfo.h>
 #include <projectexplorer/buildsteplist.h>
 #include <projectexplorer/environmentaspect.h>
+#include <projectexplorer/kit.h>
 #include <projectexplorer/processparameters.h>
 #include <projectexplorer/runconfiguration.h>
 #include <projectexplorer/target.h>
 
+#include <utils/async.h>
 #include <utils/commandline.h>
+#include <utils/futuresynchronizer.h>
+#include <utils/hostosinfo.h>
+#include <utils/outputformatter.h>
 #include <utils/process.h>
 
+#include <QCryptographicHash>
+#include <QDir>
+#include <QRegularExpression>
+#include <QSet>
+#include <QSysInfo>
+
+#include <algorithm>
+
 using namespace ProjectExplorer;
 using namespace Utils;
 
 namespace Rusty::Internal {
 
 const char RssideBuildStep[] = "Rust.RssideBuildStep";
+const char LastUnitCountKey[] = "Rust.RssideBuildStep.LastUnitCount";
+const char CrateDurationsKey[] = "Rust.RssideBuildStep.CrateDurations";
+const char ExecutablesKey[] = "Rust.BuildConfiguration.Executables";
 
 RsSideBuildStepFactory::RsSideBuildStepFactory()
 {
@@ -47,13 +73,30 @@ RsSideBuildStep::RsSideBuildStep(BuildStepList *bsl, Id id)
 
     QString str(m_cargoProject.value());
 
-    setCommandLineProvider([this] { return CommandLine(m_cargoProject(), {"build"}); });
+    m_collectTimings.setSettingsKey("Rust.CargoCollectTimings");
+    m_collectTimings.setLabel(Tr::tr("Collect build timings"),
+                              BoolAspect::LabelPlacement::AtCheckBox);
+    m_collectTimings.setToolTip(Tr::tr("Runs cargo with --timings and keeps the per-crate "
+                                       "timings of every build for the Build Timings view."));
+
+    // Diagnostics are requested as JSON so they can be turned into tasks while
+    // the build is still running, see CargoOutputParser.
+    setCommandLineProvider([this] {
+        QStringList arguments{m_checkRun ? "check" : "build", "--message-format=json"};
+        if (auto bc = qobject_cast<RsSideBuildConfiguration *>(buildConfiguration()))
+            arguments << bc->cargoArguments();
+        if (m_collectTimings() && !m_checkRun)
+            arguments << "--timings";
+        return CommandLine(m_cargoProject(), arguments);
+    });
     setWorkingDirectoryProvider([this] {
         return m_cargoProject().withNewMappedPath(project()->projectDirectory()); // FIXME: new path needed?
     });
     setEnvironmentModifier([this](Environment &env) {
         env.prependOrSetPath(m_cargoProject().parentDir());
     });
+
+    connect(&m_tracker, &CargoBuildTracker::progressChanged, this, &BuildStep::progress);
 }
 
 void RsSideBuildStep::updateRsSideProjectPath(const FilePath &rsSideProjectPath)
@@ -61,37 +104,851 @@ void RsSideBuildStep::updateRsSideProjectPath(const FilePath &rsSideProjectPath)
     m_cargoProject.setValue(rsSideProjectPath);
 }
 
+FilePath RsSideBuildStep::targetDirectory() const
+{
+    const QString targetDir = buildEnvironment().value("CARGO_TARGET_DIR");
+    if (!targetDir.isEmpty())
+        return project()->projectDirectory().resolvePath(targetDir);
+    return project()->projectDirectory().pathAppended("target");
+}
+
+bool RsSideBuildStep::init()
+{
+    // Must be known before the command line is set up.
+    CargoBuildScheduler *scheduler = CargoBuildScheduler::instance();
+    m_checkRun = scheduler && scheduler->isStartingCheck();
+    if (!AbstractProcessStep::init())
+        return false;
+    if (scheduler)
+        scheduler->buildQueued(buildConfiguration(), m_checkRun);
+    return true;
+}
+
+void RsSideBuildStep::setupOutputFormatter(OutputFormatter *formatter)
+{
+    auto parser = new CargoOutputParser;
+    connect(parser, &CargoOutputParser::lockWaitFinished, this, [this](qint64 ms) {
+        m_lockWaitMs += ms;
+    });
+    connect(parser, &CargoOutputParser::unitStarted,
+            &m_tracker, &CargoBuildTracker::unitStarted);
+    connect(parser, &CargoOutputParser::artifactFinished,
+            &m_tracker, &CargoBuildTracker::artifactFinished);
+    connect(parser, &CargoOutputParser::artifactFinished,
+            this, [this](const CargoArtifact &artifact) {
+                if (!artifact.executable.isEmpty())
+                    m_executables.insert(artifact.sourcePath, artifact.executable);
+            });
+    formatter->addLineParser(parser);
+    AbstractProcessStep::setupOutputFormatter(formatter);
+}
+
 Tasking::GroupItem RsSideBuildStep::runRecipe()
 {
     using namespace Tasking;
 
     const auto onSetup = [this] {
+        m_skipped = true;
         if (!processParameters()->effectiveCommand().isExecutableFile())
             return SetupResult::StopWithDone;
+        if (CargoBuildScheduler::isPruning()) {
+            emit addOutput(Tr::tr("Stale artifacts are being removed from the target "
+                                  "directories, build again when that is done."),
+                           OutputFormat::ErrorMessage);
+            return SetupResult::StopWithError;
+        }
+        CargoBuildScheduler *scheduler = CargoBuildScheduler::instance();
+        if (scheduler && scheduler->isRedundant(buildConfiguration(), m_checkRun)) {
+            emit addOutput(Tr::tr("Nothing changed since the identical build before, skipped."),
+                           OutputFormat::NormalMessage);
+            return SetupResult::StopWithDone;
+        }
+        m_skipped = false;
+        if (scheduler)
+            scheduler->buildStarted(buildConfiguration(), m_checkRun);
+        m_lockWaitMs = 0;
+        m_executables.clear();
+        m_tracker.start(m_lastUnitCount, m_crateDurations);
+        if (auto bc = qobject_cast<RsSideBuildConfiguration *>(buildConfiguration())) {
+            bc->ensureLinkTimer();
+            bc->markTargetDirectoryUsed();
+        }
         return SetupResult::Continue;
     };
+    const auto onFinished = [this](bool success) {
+        if (CargoBuildScheduler *scheduler = CargoBuildScheduler::instance())
+            scheduler->buildFinished(buildConfiguration(), success);
+        if (m_lockWaitMs > 0) {
+            emit addOutput(Tr::tr("Waited %1 s for the cargo build directory lock.")
+                               .arg(m_lockWaitMs / 1000.0, 0, 'f', 1),
+                           OutputFormat::NormalMessage);
+        }
+    };
+
+    return Group {
+        onGroupSetup(onSetup),
+        defaultProcessTask(),
+        onGroupDone([this, onFinished] {
+            onFinished(true);
+            // Checks produce no binaries, their numbers say nothing about builds.
+            if (m_skipped || m_checkRun)
+                return;
+            reportBuildStatistics();
+            if (m_collectTimings())
+                recordTimings();
+            if (auto bc = qobject_cast<RsSideBuildConfiguration *>(buildConfiguration())) {
+                bc->addExecutables(m_executables);
+                bc->collectStaleTargetDirectories();
+            }
+        }),
+        onGroupError([onFinished] { onFinished(false); })
+    };
+}
 
-    return Group { onGroupSetup(onSetup), defaultProcessTask() };
+void RsSideBuildStep::recordTimings()
+{
+    // The report of the latest run is always also written as cargo-timing.html.
+    const FilePath html = targetDirectory().pathAppended("cargo-timings/cargo-timing.html");
+    const FilePath report = timingReportsDirectory(project()->projectDirectory())
+            .pathAppended(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".json");
+    const QString configuration = buildConfiguration()->displayName();
+
+    const auto future = Utils::asyncRun([html, report, configuration] {
+        QString errorMessage;
+        CargoTimingReport timings = CargoTimingReport::fromCargoHtml(html, &errorMessage);
+        if (!errorMessage.isEmpty())
+            return errorMessage;
+        timings.configuration = configuration;
+        timings.save(report, &errorMessage);
+        return errorMessage;
+    });
+    Utils::onResultReady(future, this, [](const QString &errorMessage) {
+        if (!errorMessage.isEmpty())
+            Core::MessageManager::writeSilently(errorMessage);
+    });
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(future);
+}
+
+void RsSideBuildStep::reportBuildStatistics()
+{
+    // Only complete builds tell how many units the configuration has.
+    m_lastUnitCount = m_tracker.finishedUnits();
+    m_crateDurations = m_tracker.crateDurations();
+
+    qint64 linkTimeMs = 0;
+    if (auto bc = qobject_cast<RsSideBuildConfiguration *>(buildConfiguration())) {
+        QStringList links;
+        for (const auto &[output, duration] : bc->takeLinkTimes()) {
+            links << QString("%1 (%2 s)").arg(output).arg(duration / 1000.0, 0, 'f', 2);
+            linkTimeMs += duration;
+        }
+        if (!links.isEmpty()) {
+            emit addOutput(Tr::tr("Link time: %1").arg(links.join(", ")),
+                           OutputFormat::NormalMessage);
+        }
+    }
+
+    BuildHistoryEntry entry;
+    entry.timestamp = QDateTime::currentDateTime();
+    entry.configuration = buildConfiguration()->displayName();
+    entry.wallTimeMs = m_tracker.elapsedMs();
+    entry.rebuiltUnits = m_tracker.compiledUnits();
+    entry.linkTimeMs = linkTimeMs;
+    entry.crateDurations = m_tracker.compiledCrateDurations();
+    appendBuildHistory(project()->projectDirectory(), entry);
+
+    const QList<QPair<QString, qint64>> outliers = m_tracker.outliers();
+    if (outliers.isEmpty())
+        return;
+    QStringList crates;
+    for (const auto &[crate, duration] : outliers)
+        crates << QString("%1 (%2 s)").arg(crate).arg(duration / 1000.0, 0, 'f', 1);
+    emit addOutput(Tr::tr("Slowest crates: %1").arg(crates.join(", ")),
+                   OutputFormat::NormalMessage);
+}
+
+void RsSideBuildStep::toMap(Store &map) const
+{
+    AbstractProcessStep::toMap(map);
+    map.insert(LastUnitCountKey, m_lastUnitCount);
+    QVariantMap durations;
+    for (auto it = m_crateDurations.cbegin(), end = m_crateDurations.cend(); it != end; ++it)
+        durations.insert(it.key(), it.value());
+    map.insert(CrateDurationsKey, durations);
+}
+
+void RsSideBuildStep::fromMap(const Store &map)
+{
+    AbstractProcessStep::fromMap(map);
+    m_lastUnitCount = map.value(LastUnitCountKey).toInt();
+    m_crateDurations.clear();
+    const QVariantMap durations = map.value(CrateDurationsKey).toMap();
+    for (auto it = durations.cbegin(), end = durations.cend(); it != end; ++it)
+        m_crateDurations.insert(it.key(), it.value().toLongLong());
 }
 
 // RsSideBuildConfiguration
 
-class RsSideBuildConfiguration : public BuildConfiguration
+enum class BuildVariant { Debug, FastDev, Release, Profiling, MaxPerf };
+enum CargoProfile { DevProfile, ReleaseProfile };
+
+const char LinkLogVariable[] = "RUSTY_LINK_LOG";
+const char LastUsedStamp[] = ".rusty-last-used";
+
+// Appends the duration of each linker invocation and its output file to the
+// file named by RUSTY_LINK_LOG. rustc hides the linker's own output unless
+// linking fails, so the result cannot be passed back on stderr.
+const char linkTimerSource[] = R"script(#!/bin/sh
+start=$(date +%s%N)
+cc "$@"
+status=$?
+end=$(date +%s%N)
+out=""
+previous=""
+for argument in "$@"; do
+    [ "$previous" = "-o" ] && out="$argument"
+    previous="$argument"
+done
+echo "$(( (end - start) / 1000000 )) $out" >> "$RUSTY_LINK_LOG"
+exit $status
+)script";
+
+// Written when the environment is set up, every cargo run with it links
+// through the script, checks on save and emit builds included.
+static void writeLinkTimerScript(const FilePath &script)
+{
+    static QSet<FilePath> upToDate;
+    if (upToDate.contains(script) && script.exists())
+        return;
+    const expected_str<QByteArray> contents = script.fileContents();
+    if (!contents || *contents != QByteArray(linkTimerSource)) {
+        if (!script.parentDir().ensureWritableDir() || !script.writeFileContents(linkTimerSource))
+            return;
+        script.setPermissions(script.permissions() | QFile::ExeOwner | QFile::ExeGroup
+                              | QFile::ExeOther);
+    }
+    upToDate.insert(script);
+}
+
+// cargo reads .cargo/config.toml of the project directory and all its
+// parents, then the one in CARGO_HOME.
+static FilePaths cargoConfigFiles(const Environment &env, const FilePath &projectDirectory)
+{
+    FilePaths directories;
+    for (FilePath directory = projectDirectory; !directory.isEmpty();
+         directory = directory.parentDir()) {
+        directories << directory.pathAppended(".cargo");
+        if (directory.isRootPath())
+            break;
+    }
+    const QString cargoHome = env.value("CARGO_HOME");
+    directories << (cargoHome.isEmpty()
+                        ? FilePath::fromString(QDir::homePath()).pathAppended(".cargo")
+                        : FilePath::fromUserInput(cargoHome));
+    FilePaths result;
+    for (const FilePath &directory : std::as_const(directories)) {
+        for (const QString &name : {QString("config.toml"), QString("config")}) {
+            const FilePath file = directory.pathAppended(name);
+            if (file.isFile())
+                result << file;
+        }
+    }
+    return result;
+}
+
+// A linker of the user's, set for a target in the cargo configuration or the
+// environment or passed in RUSTFLAGS, is not replaced by the link timer.
+static bool hasConfiguredLinker(const Environment &env, const FilePath &projectDirectory)
+{
+    for (const QString &variable : env.toStringList()) {
+        const QString name = variable.section('=', 0, 0);
+        if (name.startsWith("CARGO_TARGET_") && name.endsWith("_LINKER"))
+            return true;
+    }
+    if (env.value("RUSTFLAGS").contains("linker=")
+        || env.value("CARGO_ENCODED_RUSTFLAGS").contains("linker=")) {
+        return true;
+    }
+    static const QRegularExpression linkerSetting("^\\s*linker\\s*=|linker=",
+                                                  QRegularExpression::MultilineOption);
+    for (const FilePath &config : cargoConfigFiles(env, projectDirectory)) {
+        const expected_str<QByteArray> contents = config.fileContents();
+        if (contents && QString::fromUtf8(*contents).contains(linkerSetting))
+            return true;
+    }
+    return false;
+}
+
+// rustc's target triple of the host, as far as the host tells.
+static QString hostTriple()
+{
+    QString arch = QSysInfo::currentCpuArchitecture();
+    if (arch == "arm64")
+        arch = "aarch64";
+    else if (arch == "i386")
+        arch = "i686";
+    if (HostOsInfo::isWindowsHost())
+        return arch + "-pc-windows-msvc";
+    if (HostOsInfo::isMacHost())
+        return arch + "-apple-darwin";
+    return arch + "-unknown-linux-gnu";
+}
+
+// The cfg names and key="value" pairs a target triple such as
+// "x86_64-unknown-linux-gnu" sets.
+static QSet<QString> cfgFacts(const QString &triple)
+{
+    const QStringList parts = triple.split('-');
+    QString arch = parts.value(0);
+    if (arch.startsWith('i') && arch.endsWith("86"))
+        arch = "x86";
+    QString os = parts.value(2);
+    if (os == "darwin")
+        os = "macos";
+    const QString family = os == "windows" ? QString("windows") : QString("unix");
+    return {family, "target_family=" + family, "target_os=" + os, "target_arch=" + arch,
+            "target_vendor=" + parts.value(1), "target_env=" + parts.value(3),
+            QString("target_pointer_width=") + (arch.endsWith("64") ? "64" : "32")};
+}
+
+// Evaluates the cfg predicate at position: all(), any(), not() and the names
+// and pairs of facts. Anything else, features for one, does not match.
+static bool matchesCfg(const QString &text, qsizetype &position, const QSet<QString> &facts)
+{
+    const auto skipSpaces = [&] {
+        while (position < text.size() && text.at(position).isSpace())
+            ++position;
+    };
+    skipSpaces();
+    const qsizetype start = position;
+    while (position < text.size()
+           && (text.at(position).isLetterOrNumber() || text.at(position) == '_')) {
+        ++position;
+    }
+    const QString name = text.mid(start, position - start);
+    skipSpaces();
+    if (position < text.size() && text.at(position) == '(') {
+        ++position;
+        QList<bool> values;
+        skipSpaces();
+        while (position < text.size() && text.at(position) != ')') {
+            const qsizetype before = position;
+            values << matchesCfg(text, position, facts);
+            skipSpaces();
+            if (position < text.size() && text.at(position) == ',')
+                ++position;
+            if (position == before) {
+                position = text.size();
+                return false;
+            }
+            skipSpaces();
+        }
+        ++position;
+        if (name == "all")
+            return !values.contains(false);
+        if (name == "any")
+            return values.contains(true);
+        return name == "not" && !values.value(0, true);
+    }
+    if (position < text.size() && text.at(position) == '=') {
+        const qsizetype open = text.indexOf('"', position);
+        const qsizetype close = open < 0 ? -1 : text.indexOf('"', open + 1);
+        if (close < 0) {
+            position = text.size();
+            return false;
+        }
+        position = close + 1;
+        return facts.contains(name + '=' + text.mid(open + 1, close - open - 1));
+    }
+    return facts.contains(name);
+}
+
+// A rustflags value is an array of flags or a string of space separated ones.
+static QStringList tomlFlags(const QString &value)
+{
+    static const QRegularExpression string(R"re("((?:[^"\\]|\\.)*)"|'([^']*)')re");
+    QStringList strings;
+    for (auto it = string.globalMatch(value); it.hasNext();) {
+        const QRegularExpressionMatch match = it.next();
+        strings << (match.capturedStart(1) >= 0 ? match.captured(1) : match.captured(2));
+    }
+    if (value.startsWith('['))
+        return strings;
+    return strings.value(0).split(' ', Qt::SkipEmptyParts);
+}
+
+// The flags cargo passes to rustc on its own: CARGO_ENCODED_RUSTFLAGS or
+// RUSTFLAGS of the environment, otherwise the rustflags of the target tables
+// that apply to the target or, if there are none, build.rustflags. Setting
+// CARGO_ENCODED_RUSTFLAGS replaces all of them, so they are passed on in it.
+static QStringList configuredRustFlags(const Environment &env, const FilePath &projectDirectory)
+{
+    if (env.hasKey("CARGO_ENCODED_RUSTFLAGS"))
+        return env.value("CARGO_ENCODED_RUSTFLAGS").split(QChar(0x1f), Qt::SkipEmptyParts);
+    if (env.hasKey("RUSTFLAGS"))
+        return env.value("RUSTFLAGS").split(' ', Qt::SkipEmptyParts);
+
+    QString triple = env.value("CARGO_BUILD_TARGET");
+    if (triple.isEmpty())
+        triple = hostTriple();
+    const QSet<QString> facts = cfgFacts(triple);
+    QStringList buildFlags;
+    QStringList targetFlags;
+    // Arrays of several files are joined, the ones closer to the project last.
+    FilePaths configs = cargoConfigFiles(env, projectDirectory);
+    std::reverse(configs.begin(), configs.end());
+    for (const FilePath &config : std::as_const(configs)) {
+        const expected_str<QByteArray> contents = config.fileContents();
+        if (!contents)
+            continue;
+        const QStringList lines = QString::fromUtf8(*contents).split('\n');
+        QString table;
+        for (int i = 0; i < lines.size(); ++i) {
+            const QString line = lines.at(i).trimmed();
+            if (line.startsWith('[')) {
+                table = line.mid(1, line.indexOf(']') - 1).trimmed();
+                continue;
+            }
+            const qsizetype equals = line.indexOf('=');
+            if (equals <= 0 || line.startsWith('#'))
+                continue;
+            const QString key = line.left(equals).trimmed();
+            const QString name = table.isEmpty() ? key : table + '.' + key;
+            if (!name.endsWith(".rustflags"))
+                continue;
+            QString value = line.mid(equals + 1).trimmed();
+            if (value.startsWith('[')) {
+                while (!value.contains(']') && i + 1 < lines.size())
+                    value += ' ' + lines.at(++i).trimmed();
+            }
+            if (name == "build.rustflags") {
+                buildFlags << tomlFlags(value);
+            } else if (name.startsWith("target.")) {
+                QString target = name.mid(7, name.size() - 17);
+                if (target.size() > 1 && (target.front() == '\'' || target.front() == '"'))
+                    target = target.mid(1, target.size() - 2);
+                qsizetype position = 4;
+                if (target == triple
+                    || (target.startsWith("cfg(") && target.endsWith(')')
+                        && matchesCfg(target.chopped(1), position, facts))) {
+                    targetFlags << tomlFlags(value);
+                }
+            }
+        }
+    }
+    return targetFlags.isEmpty() ? buildFlags : targetFlags;
+}
+
+static FilePath fastestLinker()
+{
+    for (const QString &linker : {QString("mold"), QString("ld.lld")}) {
+        if (FilePath(linker).searchInPath().isExecutableFile())
+            return FilePath(linker);
+    }
+    return {};
+}
+
+RsSideBuildConfiguration::RsSideBuildConfiguration(Target *target, Id id)
+    : BuildConfiguration(target, id)
 {
-public:
-    RsSideBuildConfiguration(Target *target, Id id)
-        : BuildConfiguration(target, id)
-    {
-        setConfigWidgetDisplayName(Tr::tr("General"));
+    setConfigWidgetDisplayName(Tr::tr("General"));
+
+    profile.setSettingsKey("Rust.BuildConfiguration.Profile");
+    profile.setLabelText(Tr::tr("Cargo profile:"));
+    profile.setDisplayStyle(SelectionAspect::DisplayStyle::ComboBox);
+    profile.addOption("dev");
+    profile.addOption("release", Tr::tr("Builds with --release."));
+
+    lto.setSettingsKey("Rust.BuildConfiguration.Lto");
+    lto.setLabelText(Tr::tr("Link-time optimization:"));
+    lto.setDisplayStyle(SelectionAspect::DisplayStyle::ComboBox);
+    lto.addOption(Tr::tr("Profile default"));
+    lto.addOption(Tr::tr("Off"));
+    lto.addOption(Tr::tr("Thin"));
+    lto.addOption(Tr::tr("Fat"));
+
+    codegenUnits.setSettingsKey("Rust.BuildConfiguration.CodegenUnits");
+    codegenUnits.setLabelText(Tr::tr("Codegen units:"));
+    codegenUnits.setToolTip(Tr::tr("0 keeps the profile's default."));
+    codegenUnits.setRange(0, 256);
+
+    targetCpu.setSettingsKey("Rust.BuildConfiguration.TargetCpu");
+    targetCpu.setLabelText(Tr::tr("Target CPU:"));
+    targetCpu.setDisplayStyle(StringAspect::LineEditDisplay);
+    targetCpu.setPlaceHolderText(Tr::tr("Default"));
+    targetCpu.setToolTip(Tr::tr("Passed as -C target-cpu, for example \"native\", after the "
+                                "rustflags of the environment or the cargo configuration."));
+
+    linker.setSettingsKey("Rust.BuildConfiguration.Linker");
+    linker.setLabelText(Tr::tr("Linker:"));
+    linker.setDisplayStyle(SelectionAspect::DisplayStyle::ComboBox);
+    linker.addOption(Tr::tr("Default"));
+    linker.addOption("lld", Tr::tr("Links with LLVM's lld, needs ld.lld in PATH."));
+    linker.addOption("mold", Tr::tr("Links with mold, needs mold in PATH."));
 
-        setInitializer([this](const BuildInfo &) {
-            buildSteps()->appendStep(RssideBuildStep);
-            updateCacheAndEmitEnvironmentChanged();
-        });
+    debugInfo.setSettingsKey("Rust.BuildConfiguration.DebugInfo");
+    debugInfo.setLabelText(Tr::tr("Debug information:"));
+    debugInfo.setDisplayStyle(SelectionAspect::DisplayStyle::ComboBox);
+    debugInfo.addOption(Tr::tr("Profile default"));
+    debugInfo.addOption(Tr::tr("None"));
+    debugInfo.addOption(Tr::tr("Line tables only"));
+    debugInfo.addOption(Tr::tr("Limited"));
+    debugInfo.addOption(Tr::tr("Full"));
 
+    splitDebugInfo.setSettingsKey("Rust.BuildConfiguration.SplitDebugInfo");
+    splitDebugInfo.setLabelText(Tr::tr("Split debug information:"));
+    splitDebugInfo.setDisplayStyle(SelectionAspect::DisplayStyle::ComboBox);
+    splitDebugInfo.addOption(Tr::tr("Profile default"));
+    splitDebugInfo.addOption(Tr::tr("Off"));
+    splitDebugInfo.addOption(Tr::tr("Packed"));
+    splitDebugInfo.addOption(Tr::tr("Unpacked"));
+
+    incremental.setSettingsKey("Rust.BuildConfiguration.Incremental");
+    incremental.setLabelText(Tr::tr("Incremental compilation:"));
+    incremental.setDisplayStyle(SelectionAspect::DisplayStyle::ComboBox);
+    incremental.addOption(Tr::tr("Profile default"));
+    incremental.addOption(Tr::tr("On"));
+    incremental.addOption(Tr::tr("Off"));
+
+    optimizationRemarks.setSettingsKey("Rust.BuildConfiguration.OptimizationRemarks");
+    optimizationRemarks.setLabel(Tr::tr("Collect optimization remarks"),
+                                 BoolAspect::LabelPlacement::AtCheckBox);
+    optimizationRemarks.setToolTip(Tr::tr("Has rustc report inlining and vectorization "
+                                          "decisions and shows the missed ones in the editor. "
+                                          "Builds without debug information get line tables "
+                                          "for the remarks' locations."));
+
+    measureLinkTime.setSettingsKey("Rust.BuildConfiguration.MeasureLinkTime");
+    measureLinkTime.setLabel(Tr::tr("Measure link time"), BoolAspect::LabelPlacement::AtCheckBox);
+    measureLinkTime.setToolTip(Tr::tr("Runs the linker through a small wrapper script that "
+                                      "records how long each link takes. Not done when a "
+                                      "linker is configured for cargo."));
+    measureLinkTime.setVisible(HostOsInfo::isLinuxHost());
+
+    manageTargetDirectory.setSettingsKey("Rust.BuildConfiguration.ManageTargetDirectory");
+    manageTargetDirectory.setLabel(Tr::tr("Manage target directory"),
+                                   BoolAspect::LabelPlacement::AtCheckBox);
+    manageTargetDirectory.setToolTip(Tr::tr("Builds into target/qtc/<kit>-<profile>-<flags hash>, "
+                                            "so configurations with different flags do not "
+                                            "invalidate each other's artifacts."));
+    manageTargetDirectory.setDefaultValue(true);
+
+    keptTargetDirectories.setSettingsKey("Rust.BuildConfiguration.KeptTargetDirectories");
+    keptTargetDirectories.setLabelText(Tr::tr("Keep target directories:"));
+    keptTargetDirectories.setToolTip(Tr::tr("The least recently used target directories below "
+                                            "target/qtc beyond this count are deleted after a "
+                                            "build. Directories of existing build "
+                                            "configurations are never deleted."));
+    keptTargetDirectories.setRange(1, 100);
+    keptTargetDirectories.setDefaultValue(8);
+    keptTargetDirectories.setEnabler(&manageTargetDirectory);
+
+    targetDirectory.setLabelText(Tr::tr("Target directory:"));
+    targetDirectory.setDisplayStyle(StringAspect::LabelDisplay);
+    connect(this, &BuildConfiguration::environmentChanged, this, [this] {
+        targetDirectory.setValue(cargoTargetDirectory().toUserOutput());
+    });
+
+    checkOnSave.setSettingsKey("Rust.BuildConfiguration.CheckOnSave");
+    checkOnSave.setLabel(Tr::tr("Check on save"), BoolAspect::LabelPlacement::AtCheckBox);
+    checkOnSave.setToolTip(Tr::tr("Runs cargo check with this configuration whenever a Rust "
+                                  "file of the project is saved."));
+
+    prebuildDependencies.setSettingsKey("Rust.BuildConfiguration.PrebuildDependencies");
+    prebuildDependencies.setLabel(Tr::tr("Pre-build dependencies when Cargo.lock changes"),
+                                  BoolAspect::LabelPlacement::AtCheckBox);
+    prebuildDependencies.setToolTip(Tr::tr("Builds updated dependencies in the background at "
+                                           "low priority while this is the active build "
+                                           "configuration, so the next build only compiles "
+                                           "the workspace crates."));
+    prebuildDependencies.setDefaultValue(true);
+    prebuildDependencies.setVisible(HostOsInfo::isAnyUnixHost());
+
+    for (BaseAspect *aspect : {static_cast<BaseAspect *>(&profile), &lto, &codegenUnits,
+                               &targetCpu, &linker, &debugInfo, &splitDebugInfo, &incremental,
+                               &optimizationRemarks, &measureLinkTime,
+                               &manageTargetDirectory}) {
+        connect(aspect, &BaseAspect::changed,
+                this, &BuildConfiguration::updateCacheAndEmitEnvironmentChanged);
+    }
+
+    setInitializer([this](const BuildInfo &info) {
+        applyVariantDefaults(info.extraInfo.toInt());
+        buildSteps()->appendStep(RssideBuildStep);
         updateCacheAndEmitEnvironmentChanged();
+    });
+
+    updateCacheAndEmitEnvironmentChanged();
+}
+
+void RsSideBuildConfiguration::applyVariantDefaults(int variant)
+{
+    switch (BuildVariant(variant)) {
+    case BuildVariant::Debug:
+        break;
+    case BuildVariant::FastDev: {
+        const FilePath fastLinker = fastestLinker();
+        if (fastLinker.fileName() == "mold")
+            linker.setValue(2);
+        else if (!fastLinker.isEmpty())
+            linker.setValue(1);
+        debugInfo.setValue(2);
+        splitDebugInfo.setValue(HostOsInfo::isWindowsHost() ? 0 : 3);
+        incremental.setValue(1);
+        measureLinkTime.setValue(HostOsInfo::isLinuxHost());
+        break;
+    }
+    case BuildVariant::Release:
+        profile.setValue(ReleaseProfile);
+        break;
+    case BuildVariant::Profiling:
+        // Optimized code with full debug information kept in the binary, so
+        // profilers can resolve inlined frames and source lines.
+        profile.setValue(ReleaseProfile);
+        debugInfo.setValue(4);
+        splitDebugInfo.setValue(1);
+        break;
+    case BuildVariant::MaxPerf:
+        profile.setValue(ReleaseProfile);
+        lto.setValue(3);
+        codegenUnits.setValue(1);
+        targetCpu.setValue("native");
+        break;
+    }
+}
+
+QString RsSideBuildConfiguration::cargoProfile() const
+{
+    return profile() == ReleaseProfile ? QString("release") : QString("dev");
+}
+
+QStringList RsSideBuildConfiguration::cargoArguments() const
+{
+    if (profile() == ReleaseProfile)
+        return {"--release"};
+    return {};
+}
+
+BuildConfiguration::BuildType RsSideBuildConfiguration::buildType() const
+{
+    if (profile() != ReleaseProfile)
+        return Debug;
+    return debugInfo() >= 3 ? Profile : Release;
+}
+
+FilePath RsSideBuildConfiguration::linkTimerScript() const
+{
+    return rustyDataDirectory(project()->projectDirectory()).pathAppended("link-timer.sh");
+}
+
+FilePath RsSideBuildConfiguration::linkTimeLog() const
+{
+    // Builds are serialized, one log per project is enough.
+    return rustyDataDirectory(project()->projectDirectory()).pathAppended("link-times.log");
+}
+
+void RsSideBuildConfiguration::addToEnvironment(Environment &env) const
+{
+    // Everything is passed as environment overrides, Cargo.toml stays untouched.
+    const QString profileName = cargoProfile().toUpper().replace('-', '_');
+    QStringList fingerprint{cargoProfile()};
+    const auto setProfileValue = [&](const QString &key, const QString &value) {
+        if (value.isEmpty())
+            return;
+        const QString variable = QString("CARGO_PROFILE_%1_%2").arg(profileName, key);
+        env.set(variable, value);
+        fingerprint << variable + '=' + value;
+    };
+    static const QStringList debugInfoValues{{}, "0", "line-tables-only", "1", "2"};
+    static const QStringList splitDebugInfoValues{{}, "off", "packed", "unpacked"};
+    static const QStringList incrementalValues{{}, "true", "false"};
+    static const QStringList ltoValues{{}, "off", "thin", "fat"};
+    setProfileValue("LTO", ltoValues.value(lto()));
+    if (codegenUnits() > 0)
+        setProfileValue("CODEGEN_UNITS", QString::number(codegenUnits()));
+    QString debug = debugInfoValues.value(debugInfo());
+    // Remarks of code without line tables all point to "<unknown file>".
+    if (optimizationRemarks() && (debug == "0" || (debug.isEmpty() && profile() == ReleaseProfile)))
+        debug = "line-tables-only";
+    setProfileValue("DEBUG", debug);
+    setProfileValue("SPLIT_DEBUGINFO", splitDebugInfoValues.value(splitDebugInfo()));
+    setProfileValue("INCREMENTAL", incrementalValues.value(incremental()));
+
+    QStringList rustFlags;
+    if (!targetCpu().isEmpty())
+        rustFlags << "-C" << "target-cpu=" + targetCpu();
+    if (linker() == 1)
+        rustFlags << "-C" << "link-arg=-fuse-ld=lld";
+    else if (linker() == 2)
+        rustFlags << "-C" << "link-arg=-fuse-ld=mold";
+    if (optimizationRemarks()) {
+        for (const QString &pass : OptimizationRemarks::passes())
+            rustFlags << "-C" << "remark=" + pass;
     }
-};
+    if (measureLinkTime() && HostOsInfo::isLinuxHost()
+        && !hasConfiguredLinker(env, project()->projectDirectory())) {
+        writeLinkTimerScript(linkTimerScript());
+        rustFlags << "-C" << "linker=" + linkTimerScript().path();
+        env.set(LinkLogVariable, linkTimeLog().path());
+    }
+    if (!rustFlags.isEmpty()) {
+        // RUSTFLAGS would drop the rustflags of the cargo configuration and be
+        // split at the spaces of the script's path, the encoded flags keep both.
+        Environment buildEnv = env;
+        buildEnv.modify(userEnvironmentChanges());
+        rustFlags = configuredRustFlags(buildEnv, project()->projectDirectory()) + rustFlags;
+        env.set("CARGO_ENCODED_RUSTFLAGS", rustFlags.join(QChar(0x1f)));
+    }
+
+    // Each configuration builds into a directory of its own, otherwise every
+    // switch between configurations with different flags rebuilds everything.
+    if (manageTargetDirectory()) {
+        // The user's environment changes are applied after this, flags set
+        // there change the artifacts just as well.
+        Environment buildEnv = env;
+        buildEnv.modify(userEnvironmentChanges());
+        fingerprint << "RUSTFLAGS=" + buildEnv.value("RUSTFLAGS")
+                    << "CARGO_ENCODED_RUSTFLAGS=" + buildEnv.value("CARGO_ENCODED_RUSTFLAGS")
+                    << "CARGO_BUILD_TARGET=" + buildEnv.value("CARGO_BUILD_TARGET");
+        const QByteArray hash = QCryptographicHash::hash(fingerprint.join('\n').toUtf8(),
+                                                         QCryptographicHash::Sha1);
+        const QString name = QString("%1-%2-%3").arg(kit()->fileSystemFriendlyName(),
+                                                     cargoProfile(),
+                                                     QString::fromLatin1(hash.toHex().left(8)));
+        env.set("CARGO_TARGET_DIR", managedTargetRoot().pathAppended(name).path());
+    }
+}
+
+FilePath RsSideBuildConfiguration::managedTargetRoot() const
+{
+    return project()->projectDirectory().pathAppended("target/qtc");
+}
+
+FilePath RsSideBuildConfiguration::cargoTargetDirectory() const
+{
+    const QString targetDir = environment().value("CARGO_TARGET_DIR");
+    if (!targetDir.isEmpty())
+        return project()->projectDirectory().resolvePath(targetDir);
+    return project()->projectDirectory().pathAppended("target");
+}
+
+void RsSideBuildConfiguration::markTargetDirectoryUsed() const
+{
+    if (!manageTargetDirectory())
+        return;
+    const FilePath directory = cargoTargetDirectory();
+    if (directory.ensureWritableDir())
+        directory.pathAppended(LastUsedStamp).writeFileContents(
+            QDateTime::currentDateTime().toString(Qt::ISODate).toUtf8());
+}
+
+static QStringList removeStaleTargetDirectories(const FilePath &root,
+                                                const FilePaths &inUse,
+                                                int keep)
+{
+    // Least recently used first, the stamp is rewritten before every build.
+    FilePaths candidates = root.dirEntries(QDir::Dirs | QDir::NoDotAndDotDot);
+    const auto lastUsed = [](const FilePath &directory) {
+        const FilePath stamp = directory.pathAppended(LastUsedStamp);
+        return stamp.exists() ? stamp.lastModified() : directory.lastModified();
+    };
+    std::sort(candidates.begin(), candidates.end(), [&](const FilePath &a, const FilePath &b) {
+        return lastUsed(a) < lastUsed(b);
+    });
+
+    QStringList removed;
+    qsizetype remaining = candidates.size();
+    for (const FilePath &directory : std::as_const(candidates)) {
+        if (remaining <= keep)
+            break;
+        if (inUse.contains(directory))
+            continue;
+        if (directory.removeRecursively())
+            removed << directory.toUserOutput();
+        --remaining;
+    }
+    return removed;
+}
+
+void RsSideBuildConfiguration::collectStaleTargetDirectories() const
+{
+    if (!manageTargetDirectory())
+        return;
+
+    FilePaths inUse;
+    for (Target *target : project()->targets()) {
+        for (BuildConfiguration *bc : target->buildConfigurations()) {
+            if (auto rsBc = qobject_cast<RsSideBuildConfiguration *>(bc))
+                inUse << rsBc->cargoTargetDirectory();
+        }
+    }
+
+    const auto future = Utils::asyncRun(removeStaleTargetDirectories, managedTargetRoot(),
+                                        inUse, int(keptTargetDirectories()));
+    Utils::onResultReady(future, project(), [](const QStringList &removed) {
+        for (const QString &directory : removed) {
+            Core::MessageManager::writeSilently(
+                Tr::tr("Removed stale Cargo target directory \"%1\".").arg(directory));
+        }
+    });
+    ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(future);
+}
+
+void RsSideBuildConfiguration::addExecutables(const QHash<FilePath, FilePath> &executables)
+{
+    m_executables.insert(executables);
+}
+
+FilePath RsSideBuildConfiguration::executableFor(const FilePath &sourceFile) const
+{
+    return m_executables.value(sourceFile);
+}
+
+void RsSideBuildConfiguration::toMap(Store &map) const
+{
+    BuildConfiguration::toMap(map);
+    QVariantMap executables;
+    for (auto it = m_executables.cbegin(), end = m_executables.cend(); it != end; ++it)
+        executables.insert(it.key().toString(), it.value().toVariant());
+    map.insert(ExecutablesKey, executables);
+}
+
+void RsSideBuildConfiguration::fromMap(const Store &map)
+{
+    BuildConfiguration::fromMap(map);
+    m_executables.clear();
+    const QVariantMap executables = map.value(ExecutablesKey).toMap();
+    for (auto it = executables.cbegin(), end = executables.cend(); it != end; ++it)
+        m_executables.insert(FilePath::fromString(it.key()), FilePath::fromVariant(it.value()));
+}
+
+void RsSideBuildConfiguration::ensureLinkTimer() const
+{
+    if (!measureLinkTime() || !HostOsInfo::isLinuxHost())
+        return;
+    linkTimeLog().removeFile();
+    // The script may have been removed since the environment was set up.
+    writeLinkTimerScript(linkTimerScript());
+}
+
+QList<QPair<QString, qint64>> RsSideBuildConfiguration::takeLinkTimes() const
+{
+    QList<QPair<QString, qint64>> result;
+    const FilePath log = linkTimeLog();
+    const expected_str<QByteArray> contents = log.fileContents();
+    if (!contents)
+        return result;
+    for (const QByteArray &line : contents->split('\n')) {
+        const int space = line.indexOf(' ');
+        if (space <= 0)
+            continue;
+        result.append({FilePath::fromUserInput(QString::fromLocal8Bit(line.mid(space + 1)))
+                           .fileName(),
+                       line.left(space).toLongLong()});
+    }
+    log.removeFile();
+    return result;
+}
 
 RsSideBuildConfigurationFactory::RsSideBuildConfigurationFactory()
 {
@@ -99,11 +956,33 @@ RsSideBuildConfigurationFactory::RsSideBuildConfigurationFactory()
     setSupportedProjectType(RustProjectId);
     setSupportedProjectMimeTypeName(Constants::C_RS_MIMETYPE);
     setBuildGenerator([](const Kit *, const FilePath &projectPath, bool) {
-        BuildInfo info;
-        info.displayName = "build";
-        info.typeName = "build";
-        info.buildDirectory = projectPath.parentDir();
-        return QList<BuildInfo>{info};
+        const auto buildInfo = [&projectPath](const QString &displayName, const QString &typeName,
+                                              BuildConfiguration::BuildType buildType,
+                                              BuildVariant variant) {
+            BuildInfo info;
+            info.displayName = displayName;
+            info.typeName = typeName;
+            info.buildType = buildType;
+            // Cargo builds in the project directory, where the artifacts go is
+            // up to the managed target directory or cargo's default.
+            info.buildDirectory = projectPath.parentDir();
+            info.extraInfo = int(variant);
+            return info;
+        };
+
+        return QList<BuildInfo>{
+            buildInfo(Tr::tr("Debug"), "build", BuildConfiguration::Debug, BuildVariant::Debug),
+            // Shorter edit-build cycles: faster linker, less debug information
+            // and incremental compilation, configured through the environment.
+            buildInfo(Tr::tr("Fast Dev"), "fastdev", BuildConfiguration::Debug,
+                      BuildVariant::FastDev),
+            buildInfo(Tr::tr("Release"), "release", BuildConfiguration::Release,
+                      BuildVariant::Release),
+            buildInfo(Tr::tr("Profiling"), "profiling", BuildConfiguration::Profile,
+                      BuildVariant::Profiling),
+            // Fat LTO, a single codegen unit and the host's instruction set.
+            buildInfo(Tr::tr("Max Perf"), "maxperf", BuildConfiguration::Release,
+                      BuildVariant::MaxPerf)};
     });
 }
 
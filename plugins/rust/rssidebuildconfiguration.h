@@ -1,6 +1,8 @@
 #ifndef RSSIDEBUILDSTEP_H
 #define RSSIDEBUILDSTEP_H
 
+#include "cargobuildtracker.h"
+
 #include <projectexplorer/abstractprocessstep.h>
 #include <projectexplorer/buildconfiguration.h>
 #include <projectexplorer/buildstep.h>
@@ -14,10 +16,27 @@ public:
     RsSideBuildStep(ProjectExplorer::BuildStepList *bsl, Utils::Id id);
     void updateRsSideProjectPath(const Utils::FilePath &rsSideProjectPath);
 
+    Utils::FilePath targetDirectory() const;
+
 private:
+    bool init() final;
+    void setupOutputFormatter(Utils::OutputFormatter *formatter) final;
     Tasking::GroupItem runRecipe() final;
+    void toMap(Utils::Store &map) const final;
+    void fromMap(const Utils::Store &map) final;
+    void reportBuildStatistics();
+    void recordTimings();
 
     Utils::FilePathAspect m_cargoProject{this};
+    Utils::BoolAspect m_collectTimings{this};
+
+    CargoBuildTracker m_tracker;
+    bool m_checkRun = false;
+    bool m_skipped = false;     // Nothing ran, there is nothing to report.
+    QHash<Utils::FilePath, Utils::FilePath> m_executables;
+    qint64 m_lockWaitMs = 0;
+    int m_lastUnitCount = 0;
+    QHash<QString, qint64> m_crateDurations;
 };
 
 class RsSideBuildStepFactory : public ProjectExplorer::BuildStepFactory
@@ -26,6 +45,59 @@ public:
     RsSideBuildStepFactory();
 };
 
+class RsSideBuildConfiguration : public ProjectExplorer::BuildConfiguration
+{
+    Q_OBJECT
+
+public:
+    RsSideBuildConfiguration(ProjectExplorer::Target *target, Utils::Id id);
+
+    QStringList cargoArguments() const;
+    BuildType buildType() const final;
+
+    Utils::FilePath cargoTargetDirectory() const;
+    void markTargetDirectoryUsed() const;
+    void collectStaleTargetDirectories() const;
+
+    // Executables of the last build, by the source file of their target.
+    void addExecutables(const QHash<Utils::FilePath, Utils::FilePath> &executables);
+    Utils::FilePath executableFor(const Utils::FilePath &sourceFile) const;
+
+    // Starts a new link time log and makes sure the linker wrapper used to
+    // time the link step exists, if enabled.
+    void ensureLinkTimer() const;
+    // Link times in milliseconds per output file recorded since the last call.
+    QList<QPair<QString, qint64>> takeLinkTimes() const;
+
+    Utils::SelectionAspect profile{this};
+    Utils::SelectionAspect lto{this};
+    Utils::IntegerAspect codegenUnits{this};
+    Utils::StringAspect targetCpu{this};
+    Utils::SelectionAspect linker{this};
+    Utils::SelectionAspect debugInfo{this};
+    Utils::SelectionAspect splitDebugInfo{this};
+    Utils::SelectionAspect incremental{this};
+    Utils::BoolAspect optimizationRemarks{this};
+    Utils::BoolAspect measureLinkTime{this};
+    Utils::BoolAspect manageTargetDirectory{this};
+    Utils::IntegerAspect keptTargetDirectories{this};
+    Utils::StringAspect targetDirectory{this};
+    Utils::BoolAspect checkOnSave{this};
+    Utils::BoolAspect prebuildDependencies{this};
+
+private:
+    void toMap(Utils::Store &map) const final;
+    void fromMap(const Utils::Store &map) final;
+    void addToEnvironment(Utils::Environment &env) const final;
+    void applyVariantDefaults(int variant);
+    QString cargoProfile() const;
+    Utils::FilePath managedTargetRoot() const;
+    Utils::FilePath linkTimerScript() const;
+    Utils::FilePath linkTimeLog() const;
+
+    QHash<Utils::FilePath, Utils::FilePath> m_executables;
+};
+
 class RsSideBuildConfigurationFactory : public ProjectExplorer::BuildConfigurationFactory
 {
 public:
@@ -0,0 +1,689 @@
+#include "rustdemangle.h"
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QStringList>
+
+#include <cctype>
+#include <limits>
+#include <optional>
+
+namespace Rusty::Internal {
+
+// The cache is dropped as a whole once it gets this large, a program logging
+// symbols keeps hitting the same few thousand.
+const int maxCachedSymbols = 100000;
+// Backreferences allow exponentially long output from a short symbol, the
+// length is checked after every piece and the backreferences are counted.
+const int maxDemangledLength = 4096;
+const int maxBackrefs = 1000;
+const int maxRecursionDepth = 200;
+
+static bool isSymbolChar(QChar c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+           || c == '_' || c == '$' || c == '.';
+}
+
+// Legacy mangling: Itanium style nested names, the last component being the
+// hash "h<16 hex digits>", with '$' escapes for characters C++ has no use for.
+
+static bool isLegacyHash(const QByteArray &component)
+{
+    if (component.size() != 17 || component.at(0) != 'h')
+        return false;
+    for (int i = 1; i < component.size(); ++i) {
+        if (!isxdigit(uchar(component.at(i))))
+            return false;
+    }
+    return true;
+}
+
+static std::optional<QString> unescapeLegacy(const QByteArray &component)
+{
+    static const QHash<QByteArray, QChar> escapes{{"SP", '@'}, {"BP", '*'}, {"RF", '&'},
+                                                  {"LT", '<'}, {"GT", '>'}, {"LP", '('},
+                                                  {"RP", ')'}, {"C", ','}};
+    QString result;
+    int i = component.startsWith("_$") ? 1 : 0;
+    while (i < component.size()) {
+        const char c = component.at(i);
+        if (c == '$') {
+            const int end = component.indexOf('$', i + 1);
+            if (end < 0)
+                return std::nullopt;
+            const QByteArray code = component.mid(i + 1, end - i - 1);
+            if (const auto escape = escapes.constFind(code); escape != escapes.constEnd()) {
+                result += *escape;
+            } else if (code.startsWith('u')) {
+                bool ok = false;
+                const uint unicode = code.mid(1).toUInt(&ok, 16);
+                if (!ok)
+                    return std::nullopt;
+                result += QChar(char16_t(unicode));
+            } else {
+                return std::nullopt;
+            }
+            i = end + 1;
+        } else if (c == '.' && i + 1 < component.size() && component.at(i + 1) == '.') {
+            result += "::";
+            i += 2;
+        } else {
+            result += QChar::fromLatin1(c);
+            ++i;
+        }
+    }
+    return result;
+}
+
+static QString demangleLegacy(const QByteArray &symbol)
+{
+    QList<QByteArray> components;
+    int pos = 3; // "_ZN"
+    while (pos < symbol.size() && symbol.at(pos) != 'E') {
+        int length = 0;
+        if (!isdigit(uchar(symbol.at(pos))))
+            return {};
+        while (pos < symbol.size() && isdigit(uchar(symbol.at(pos)))) {
+            length = length * 10 + symbol.at(pos) - '0';
+            if (length > symbol.size())
+                return {};
+            ++pos;
+        }
+        if (pos + length > symbol.size())
+            return {};
+        components.append(symbol.mid(pos, length));
+        pos += length;
+    }
+    // Without the hash it is most likely a C++ symbol.
+    if (pos >= symbol.size() || components.size() < 2 || !isLegacyHash(components.last()))
+        return {};
+    components.removeLast();
+
+    QStringList names;
+    for (const QByteArray &component : std::as_const(components)) {
+        const std::optional<QString> name = unescapeLegacy(component);
+        if (!name)
+            return {};
+        names.append(*name);
+    }
+    return names.join("::");
+}
+
+// v0 mangling, see https://doc.rust-lang.org/rustc/symbol-mangling/v0.html
+
+static std::optional<QString> decodePunycode(const QByteArray &input)
+{
+    const int base = 36, tMin = 1, tMax = 26, skew = 38, damp = 700;
+    // Rust uses '_' instead of '-' as delimiter between basic and encoded part.
+    const int delimiter = input.lastIndexOf('_');
+    std::u32string output;
+    for (int i = 0; i < delimiter; ++i)
+        output.push_back(char32_t(uchar(input.at(i))));
+
+    quint64 n = 128;
+    quint64 i = 0;
+    quint64 bias = 72;
+    bool firstDelta = true;
+    int pos = delimiter + 1;
+    while (pos < input.size()) {
+        const quint64 oldI = i;
+        quint64 w = 1;
+        for (quint64 k = base;; k += base) {
+            if (pos >= input.size())
+                return std::nullopt;
+            const char c = input.at(pos++);
+            quint64 digit;
+            if (c >= 'a' && c <= 'z')
+                digit = c - 'a';
+            else if (c >= '0' && c <= '9')
+                digit = c - '0' + 26;
+            else
+                return std::nullopt;
+            i += digit * w;
+            const quint64 t = k <= bias ? tMin : (k >= bias + tMax ? tMax : k - bias);
+            if (digit < t)
+                break;
+            w *= base - t;
+            if (w > 0x10FFFF * 64)
+                return std::nullopt;
+        }
+        const quint64 length = output.size() + 1;
+        quint64 delta = firstDelta ? (i - oldI) / damp : (i - oldI) / 2;
+        firstDelta = false;
+        delta += delta / length;
+        quint64 k = 0;
+        while (delta > ((base - tMin) * tMax) / 2) {
+            delta /= base - tMin;
+            k += base;
+        }
+        bias = k + ((base - tMin + 1) * delta) / (delta + skew);
+        n += i / length;
+        i %= length;
+        if (n > 0x10FFFF)
+            return std::nullopt;
+        output.insert(output.begin() + i, char32_t(n));
+        ++i;
+    }
+    return QString::fromStdU32String(output);
+}
+
+class V0Demangler
+{
+public:
+    explicit V0Demangler(const QByteArray &symbol) : m_symbol(symbol) {}
+
+    QString demangle()
+    {
+        // Optional encoding version, only 0 exists.
+        if (isdigit(uchar(peek()))) {
+            quint64 version = 0;
+            if (!decimal(&version))
+                return {};
+        }
+        QString result;
+        if (!path(&result, true))
+            return {};
+        // The instantiating crate is of no interest.
+        if (isupper(uchar(peek()))) {
+            QString ignored;
+            if (!path(&ignored, false))
+                return {};
+        }
+        // Vendor specific suffixes like ".llvm.1234".
+        if (m_pos < m_symbol.size() && peek() != '.' && peek() != '$')
+            return {};
+        return result;
+    }
+
+private:
+    class DepthGuard
+    {
+    public:
+        explicit DepthGuard(int &depth) : m_depth(++depth) {}
+        ~DepthGuard() { --m_depth; }
+        bool tooDeep() const { return m_depth > maxRecursionDepth; }
+
+    private:
+        int &m_depth;
+    };
+
+    static bool fits(const QString &text) { return text.size() <= maxDemangledLength; }
+    static bool fits(const QStringList &parts)
+    {
+        qsizetype length = 0;
+        for (const QString &part : parts)
+            length += part.size();
+        return length <= maxDemangledLength;
+    }
+
+    char peek() const { return m_pos < m_symbol.size() ? m_symbol.at(m_pos) : '\0'; }
+    char next() { return m_pos < m_symbol.size() ? m_symbol.at(m_pos++) : '\0'; }
+
+    bool eat(char c)
+    {
+        if (peek() != c)
+            return false;
+        ++m_pos;
+        return true;
+    }
+
+    bool decimal(quint64 *value)
+    {
+        if (!isdigit(uchar(peek())))
+            return false;
+        *value = 0;
+        if (eat('0'))
+            return true;
+        while (isdigit(uchar(peek()))) {
+            *value = *value * 10 + (next() - '0');
+            if (*value > quint64(m_symbol.size()))
+                return false;
+        }
+        return true;
+    }
+
+    bool base62(quint64 *value)
+    {
+        if (eat('_')) {
+            *value = 0;
+            return true;
+        }
+        quint64 result = 0;
+        while (!eat('_')) {
+            const char c = next();
+            int digit;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (c >= 'a' && c <= 'z')
+                digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'Z')
+                digit = c - 'A' + 36;
+            else
+                return false;
+            if (result > (std::numeric_limits<quint64>::max() - digit) / 62)
+                return false;
+            result = result * 62 + digit;
+        }
+        *value = result + 1;
+        return true;
+    }
+
+    bool optionalBase62(char tag, quint64 *value)
+    {
+        *value = 0;
+        return !eat(tag) || base62(value);
+    }
+
+    bool identifier(QString *name)
+    {
+        const bool punycode = eat('u');
+        quint64 length = 0;
+        if (!decimal(&length))
+            return false;
+        eat('_');
+        if (m_pos + qsizetype(length) > m_symbol.size())
+            return false;
+        const QByteArray bytes = m_symbol.mid(m_pos, qsizetype(length));
+        m_pos += qsizetype(length);
+        if (!punycode) {
+            *name = QString::fromLatin1(bytes);
+            return true;
+        }
+        const std::optional<QString> decoded = decodePunycode(bytes);
+        if (!decoded)
+            return false;
+        *name = *decoded;
+        return true;
+    }
+
+    template<typename Parse>
+    bool atBackref(Parse parse)
+    {
+        const qsizetype start = m_pos - 1;
+        quint64 target = 0;
+        if (!base62(&target) || target >= quint64(start) || ++m_backrefs > maxBackrefs)
+            return false;
+        const qsizetype saved = m_pos;
+        m_pos = qsizetype(target);
+        const bool ok = parse();
+        m_pos = saved;
+        return ok;
+    }
+
+    bool path(QString *out, bool inValue)
+    {
+        const DepthGuard guard(m_depth);
+        if (guard.tooDeep())
+            return false;
+
+        quint64 disambiguator = 0;
+        switch (next()) {
+        case 'C':
+            return optionalBase62('s', &disambiguator) && identifier(out);
+        case 'M': {
+            QString ignored;
+            QString self;
+            if (!optionalBase62('s', &disambiguator) || !path(&ignored, false) || !type(&self))
+                return false;
+            *out = '<' + self + '>';
+            return fits(*out);
+        }
+        case 'X': {
+            QString ignored;
+            QString self;
+            QString trait;
+            if (!optionalBase62('s', &disambiguator) || !path(&ignored, false) || !type(&self)
+                || !path(&trait, false)) {
+                return false;
+            }
+            *out = '<' + self + " as " + trait + '>';
+            return fits(*out);
+        }
+        case 'Y': {
+            QString self;
+            QString trait;
+            if (!type(&self) || !path(&trait, false))
+                return false;
+            *out = '<' + self + " as " + trait + '>';
+            return fits(*out);
+        }
+        case 'N': {
+            const char ns = next();
+            if (!isalpha(uchar(ns)))
+                return false;
+            QString parent;
+            QString name;
+            if (!path(&parent, inValue) || !optionalBase62('s', &disambiguator)
+                || !identifier(&name)) {
+                return false;
+            }
+            if (isupper(uchar(ns))) {
+                // Closures and shims, "{closure#0}" or "{closure:name#0}".
+                QString kind = ns == 'C' ? QString("closure")
+                                         : ns == 'S' ? QString("shim") : QString(QChar(ns));
+                if (!name.isEmpty())
+                    kind += ':' + name;
+                *out = parent + "::{" + kind + '#' + QString::number(disambiguator) + '}';
+            } else {
+                *out = name.isEmpty() ? parent : QString(parent + "::" + name);
+            }
+            return fits(*out);
+        }
+        case 'I': {
+            if (!path(out, inValue))
+                return false;
+            QStringList arguments;
+            while (!eat('E')) {
+                QString argument;
+                if (!genericArgument(&argument))
+                    return false;
+                if (!argument.isEmpty())
+                    arguments.append(argument);
+                if (!fits(arguments))
+                    return false;
+            }
+            *out += (inValue ? "::<" : "<") + arguments.join(", ") + '>';
+            return fits(*out);
+        }
+        case 'B':
+            return atBackref([this, out, inValue] { return path(out, inValue); });
+        }
+        return false;
+    }
+
+    bool genericArgument(QString *out)
+    {
+        if (eat('L')) {
+            // Lifetimes are erased in symbols anyway.
+            quint64 ignored;
+            out->clear();
+            return base62(&ignored);
+        }
+        if (eat('K'))
+            return constant(out);
+        return type(out);
+    }
+
+    static QString basicType(char tag)
+    {
+        switch (tag) {
+        case 'a': return "i8";
+        case 'b': return "bool";
+        case 'c': return "char";
+        case 'd': return "f64";
+        case 'e': return "str";
+        case 'f': return "f32";
+        case 'h': return "u8";
+        case 'i': return "isize";
+        case 'j': return "usize";
+        case 'l': return "i32";
+        case 'm': return "u32";
+        case 'n': return "i128";
+        case 'o': return "u128";
+        case 'p': return "_";
+        case 's': return "i16";
+        case 't': return "u16";
+        case 'u': return "()";
+        case 'v': return "...";
+        case 'x': return "i64";
+        case 'y': return "u64";
+        case 'z': return "!";
+        }
+        return {};
+    }
+
+    bool type(QString *out)
+    {
+        const DepthGuard guard(m_depth);
+        if (guard.tooDeep())
+            return false;
+
+        const char tag = peek();
+        if (const QString basic = basicType(tag); !basic.isEmpty()) {
+            ++m_pos;
+            *out = basic;
+            return true;
+        }
+
+        QString inner;
+        quint64 ignored = 0;
+        switch (tag) {
+        case 'A': {
+            ++m_pos;
+            QString length;
+            if (!type(&inner) || !constant(&length))
+                return false;
+            *out = '[' + inner + "; " + length + ']';
+            return fits(*out);
+        }
+        case 'S':
+            ++m_pos;
+            if (!type(&inner))
+                return false;
+            *out = '[' + inner + ']';
+            return fits(*out);
+        case 'T': {
+            ++m_pos;
+            QStringList elements;
+            while (!eat('E')) {
+                if (!type(&inner))
+                    return false;
+                elements.append(inner);
+                if (!fits(elements))
+                    return false;
+            }
+            *out = '(' + elements.join(", ") + (elements.size() == 1 ? ",)" : ")");
+            return fits(*out);
+        }
+        case 'R':
+        case 'Q':
+            ++m_pos;
+            if (!optionalBase62('L', &ignored) || !type(&inner))
+                return false;
+            *out = (tag == 'R' ? "&" : "&mut ") + inner;
+            return fits(*out);
+        case 'P':
+        case 'O':
+            ++m_pos;
+            if (!type(&inner))
+                return false;
+            *out = (tag == 'P' ? "*const " : "*mut ") + inner;
+            return fits(*out);
+        case 'F':
+            ++m_pos;
+            return functionSignature(out);
+        case 'D':
+            ++m_pos;
+            if (!dynBounds(out) || !eat('L') || !base62(&ignored))
+                return false;
+            return true;
+        case 'B':
+            ++m_pos;
+            return atBackref([this, out] { return type(out); });
+        }
+        return path(out, false);
+    }
+
+    bool functionSignature(QString *out)
+    {
+        quint64 ignored = 0;
+        if (!optionalBase62('G', &ignored))
+            return false;
+        QString prefix = eat('U') ? QString("unsafe ") : QString();
+        if (eat('K')) {
+            QString abi = "C";
+            if (!eat('C')) {
+                if (!identifier(&abi))
+                    return false;
+                abi.replace('_', '-');
+            }
+            prefix += "extern \"" + abi + "\" ";
+        }
+        QStringList parameters;
+        QString parameter;
+        while (!eat('E')) {
+            if (!type(&parameter))
+                return false;
+            parameters.append(parameter);
+            if (!fits(parameters))
+                return false;
+        }
+        QString result;
+        if (!type(&result))
+            return false;
+        *out = prefix + "fn(" + parameters.join(", ") + ')';
+        if (result != "()")
+            *out += " -> " + result;
+        return fits(*out);
+    }
+
+    bool dynBounds(QString *out)
+    {
+        quint64 ignored = 0;
+        if (!optionalBase62('G', &ignored))
+            return false;
+        QStringList traits;
+        while (!eat('E')) {
+            QString trait;
+            if (!path(&trait, false))
+                return false;
+            QStringList bindings;
+            while (eat('p')) {
+                QString name;
+                QString bound;
+                if (!identifier(&name) || !type(&bound))
+                    return false;
+                bindings.append(name + " = " + bound);
+                if (!fits(bindings))
+                    return false;
+            }
+            if (!bindings.isEmpty()) {
+                if (trait.endsWith('>'))
+                    trait.insert(trait.size() - 1, ", " + bindings.join(", "));
+                else
+                    trait += '<' + bindings.join(", ") + '>';
+            }
+            traits.append(trait);
+            if (!fits(traits))
+                return false;
+        }
+        *out = "dyn " + traits.join(" + ");
+        return fits(*out);
+    }
+
+    bool constant(QString *out)
+    {
+        if (eat('p')) {
+            *out = "_";
+            return true;
+        }
+        if (eat('B'))
+            return atBackref([this, out] { return constant(out); });
+
+        const char tag = next();
+        const bool negative = eat('n');
+        QByteArray hex;
+        while (!eat('_')) {
+            const char c = next();
+            if (!isxdigit(uchar(c)) || isupper(uchar(c)))
+                return false;
+            hex += c;
+        }
+        bool ok = hex.size() <= 16;
+        const quint64 value = hex.isEmpty() ? 0 : hex.toULongLong(&ok, 16);
+        switch (tag) {
+        case 'b':
+            if (value > 1)
+                return false;
+            *out = value ? QString("true") : QString("false");
+            return true;
+        case 'c': {
+            if (!ok || value > 0x10FFFF)
+                return false;
+            const char32_t character = char32_t(value);
+            *out = '\'' + QString::fromUcs4(&character, 1) + '\'';
+            return true;
+        }
+        case 'a': case 'h': case 'i': case 'j': case 'l': case 'm': case 'n': case 'o':
+        case 's': case 't': case 'x': case 'y':
+            *out = ok ? QString::number(value) : QString("0x" + QString::fromLatin1(hex));
+            if (negative)
+                out->prepend('-');
+            return true;
+        }
+        return false;
+    }
+
+    const QByteArray m_symbol;
+    qsizetype m_pos = 0;
+    int m_depth = 0;
+    int m_backrefs = 0;
+};
+
+static QString demangleUncached(const QString &symbol)
+{
+    // macOS prefixes every symbol with another underscore.
+    QByteArray mangled = symbol.toLatin1();
+    if (mangled.startsWith("__"))
+        mangled.remove(0, 1);
+    if (mangled.startsWith("_ZN"))
+        return demangleLegacy(mangled);
+    if (mangled.startsWith("_R") && mangled.size() > 2
+        && (isupper(uchar(mangled.at(2))) || isdigit(uchar(mangled.at(2))))) {
+        return V0Demangler(mangled.mid(2)).demangle();
+    }
+    return {};
+}
+
+QString demangleRustSymbol(const QString &symbol)
+{
+    static QReadWriteLock lock;
+    static QHash<QString, QString> cache;
+    {
+        QReadLocker locker(&lock);
+        const auto cached = cache.constFind(symbol);
+        if (cached != cache.constEnd())
+            return *cached;
+    }
+    const QString demangled = demangleUncached(symbol);
+    QWriteLocker locker(&lock);
+    if (cache.size() >= maxCachedSymbols)
+        cache.clear();
+    cache.insert(symbol, demangled);
+    return demangled;
+}
+
+bool mayContainRustSymbol(const QString &text)
+{
+    return text.contains(QLatin1String("_ZN")) || text.contains(QLatin1String("_R"));
+}
+
+QString demangleRustSymbols(const QString &text)
+{
+    if (!mayContainRustSymbol(text))
+        return text;
+
+    QString result;
+    qsizetype copied = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        if (text.at(i) != '_' || (i > 0 && isSymbolChar(text.at(i - 1))))
+            continue;
+        qsizetype end = i;
+        while (end < text.size() && isSymbolChar(text.at(end)))
+            ++end;
+        const QString demangled = demangleRustSymbol(text.mid(i, end - i));
+        if (!demangled.isEmpty()) {
+            result += QStringView(text).mid(copied, i - copied);
+            result += demangled;
+            copied = end;
+        }
+        i = end;
+    }
+    if (copied == 0)
+        return text;
+    result += QStringView(text).mid(copied);
+    return result;
+}
+
+} // Rusty::Internal
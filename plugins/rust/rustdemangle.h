@@ -0,0 +1,21 @@
+#ifndef RUSTDEMANGLE_H
+#define RUSTDEMANGLE_H
+
+#include <QString>
+
+namespace Rusty::Internal {
+
+// Demangles a legacy ("_ZN...17h<hash>E") or v0 ("_R...") Rust symbol name.
+// Returns an empty string for anything else, including C++ symbols. Results
+// are cached, the function may be called from any thread.
+QString demangleRustSymbol(const QString &symbol);
+
+// Replaces every mangled Rust symbol in text by its demangled name.
+QString demangleRustSymbols(const QString &text);
+
+// Cheap test whether text may contain a mangled Rust symbol at all.
+bool mayContainRustSymbol(const QString &text);
+
+} // Rusty::Internal
+
+#endif // RUSTDEMANGLE_H
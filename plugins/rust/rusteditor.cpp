@@ -1,5 +1,7 @@
 #include "rusteditor.h"
 
+#include "assemblyview.h"
+#include "irbloatview.h"
 #include "rsside.h"
 #include "rustyconstants.h"
 
@@ -11,10 +13,13 @@
 #include "rustsettings.h"
 #include "rusttr.h"
 #include "rustutils.h"
+#include "sourceannotations.h"
 
+#include <coreplugin/actionmanager/actioncontainer.h>
 #include <coreplugin/actionmanager/actionmanager.h>
 #include <coreplugin/actionmanager/commandbutton.h>
 #include <coreplugin/coreplugintr.h>
+#include <coreplugin/documentmanager.h>
 #include <coreplugin/icore.h>
 
 #include <projectexplorer/project.h>
@@ -76,6 +81,54 @@ static void registerReplAction(QObject *parent)
 
 }
 
+static void registerAssemblyAction(QObject *parent)
+{
+    auto action = new QAction(Tr::tr("Show Assembly"), parent);
+    action->setToolTip(Tr::tr("Build the crate with the active build configuration and show the "
+                              "assembly of the function under the cursor."));
+    Core::Command *command
+        = Core::ActionManager::registerAction(action, Constants::RUST_SHOW_ASSEMBLY,
+                                              Core::Context(Constants::C_RUSTEDITOR_ID));
+    Core::ActionContainer *contextMenu
+        = Core::ActionManager::createMenu(Constants::M_RUST_EDITOR_CONTEXT);
+    contextMenu->addAction(command);
+
+    QObject::connect(action, &QAction::triggered, parent, [] {
+        TextEditorWidget *widget = TextEditorWidget::currentTextEditorWidget();
+        if (!widget)
+            return;
+        // cargo builds what is on disk.
+        TextDocument *document = widget->textDocument();
+        if (document->isModified()
+            && !Core::DocumentManager::saveModifiedDocumentSilently(document)) {
+            return;
+        }
+        showAssemblyAt(document->filePath(), widget->textCursor().blockNumber() + 1);
+    });
+}
+
+static void registerIrBloatAction(QObject *parent)
+{
+    auto action = new QAction(Tr::tr("LLVM IR Bloat Report"), parent);
+    action->setToolTip(Tr::tr("Build the crate to LLVM IR and show which functions and generic "
+                              "instances it consists of."));
+    Core::Command *command
+        = Core::ActionManager::registerAction(action, Constants::RUST_IR_BLOAT_REPORT,
+                                              Core::Context(Constants::C_RUSTEDITOR_ID));
+    Core::ActionManager::createMenu(Constants::M_RUST_EDITOR_CONTEXT)->addAction(command);
+
+    QObject::connect(action, &QAction::triggered, parent, [] {
+        Core::IDocument *document = Core::EditorManager::currentDocument();
+        if (!document)
+            return;
+        if (document->isModified()
+            && !Core::DocumentManager::saveModifiedDocumentSilently(document)) {
+            return;
+        }
+        showIrBloatReport(document->filePath());
+    });
+}
+
 class RustDocument : public TextDocument
 {
     Q_OBJECT
@@ -116,6 +169,7 @@ public:
 
 protected:
     void finalizeInitialization() override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
     void setUserDefinedPython(const Interpreter &interpreter);
     void updateInterpretersSelector();
 
@@ -154,7 +208,12 @@ void RustEditorWidget::finalizeInitialization()
             this, &RustEditorWidget::updateInterpretersSelector);
     connect(ProjectExplorerPlugin::instance(), &ProjectExplorerPlugin::fileListChanged,
             this, &RustEditorWidget::updateInterpretersSelector);
+    SourceAnnotations::instance()->attach(this);
+}
 
+void RustEditorWidget::contextMenuEvent(QContextMenuEvent *event)
+{
+    showDefaultContextMenu(event, Constants::M_RUST_EDITOR_CONTEXT);
 }
 
 void RustEditorWidget::setUserDefinedPython(const Interpreter &interpreter)
@@ -283,6 +342,8 @@ RustEditorFactory::RustEditorFactory()
 {
 
     registerReplAction(&m_guard);
+    registerAssemblyAction(&m_guard);
+    registerIrBloatAction(&m_guard);
 
     setId(Constants::C_RUSTEDITOR_ID);
     setDisplayName(::Core::Tr::tr(Constants::C_EDITOR_DISPLAY_NAME));
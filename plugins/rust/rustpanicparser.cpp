@@ -0,0 +1,224 @@
+#include "rustpanicparser.h"
+
+#include "rustdemangle.h"
+#include "rustproject.h"
+#include "rusttaskqueue.h"
+#include "rusttr.h"
+
+#include <QRegularExpression>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+// Rust >= 1.73: "thread 'main' panicked at src/main.rs:5:9:", message in the next line.
+static const QRegularExpression &panicPattern()
+{
+    static const QRegularExpression pattern("^thread '([^']*)' panicked at (.+:\\d+:\\d+):$");
+    return pattern;
+}
+
+// Rust < 1.73: "thread 'main' panicked at 'message', src/main.rs:5:9"
+static const QRegularExpression &oldPanicPattern()
+{
+    static const QRegularExpression pattern(
+        "^thread '([^']*)' panicked at '(.*)', (.+:\\d+:\\d+)$");
+    return pattern;
+}
+
+// "  12: 0x55d1c2a0b1c4 - app::main::h0123456789abcdef" (RUST_BACKTRACE=full)
+// or "  12: app::main". The hash of legacy symbols is left out of the capture.
+static const QRegularExpression &framePattern()
+{
+    static const QRegularExpression pattern(
+        "^\\s*\\d+: (?:0x[0-9a-fA-F]+ - )?(.+?)(?:::h[0-9a-f]{16})?$");
+    return pattern;
+}
+
+// "             at ./src/main.rs:5:9"
+static const QRegularExpression &frameLocationPattern()
+{
+    static const QRegularExpression pattern("^\\s+at (.+:\\d+(?::\\d+)?)$");
+    return pattern;
+}
+
+static QString demangled(const QString &text)
+{
+    return mayContainRustSymbol(text) ? demangleRustSymbols(text) : text;
+}
+
+RustPanicOutputParser::RustPanicOutputParser(const FilePath &projectDirectory)
+    : m_projectDirectory(projectDirectory)
+{
+    // Backtraces print paths relative to the working directory, which is the
+    // project directory unless the user changed it.
+    addSearchDir(projectDirectory);
+}
+
+OutputLineParser::Result RustPanicOutputParser::handleLine(const QString &text,
+                                                           OutputFormat format)
+{
+    const QString line = rightTrimmed(text);
+
+    switch (m_state) {
+    case State::Idle:
+        if (line.startsWith("thread '") && line.contains("' panicked at "))
+            return handlePanic(line);
+        return handleOtherLine(text);
+    case State::Message:
+        // Panic messages may span several lines, but nothing marks their
+        // end if neither a note nor a backtrace follows, so only the first
+        // line is taken.
+        if (!line.startsWith("note: ") && line != "stack backtrace:") {
+            m_panic.summary += ": " + line;
+            m_panic.details.append(line);
+            m_state = State::AfterMessage;
+            return Status::InProgress;
+        }
+        m_state = State::AfterMessage;
+        [[fallthrough]];
+    case State::AfterMessage:
+        if (line == "stack backtrace:") {
+            m_panic.details.append(line);
+            m_state = State::Backtrace;
+            return Status::InProgress;
+        }
+        if (line.startsWith("note: run with `RUST_BACKTRACE=")) {
+            finishPanic();
+            return Status::Done;
+        }
+        finishPanic();
+        return handleLine(text, format);
+    case State::Backtrace:
+        return handleBacktraceLine(text);
+    }
+    return Status::NotHandled;
+}
+
+OutputLineParser::Result RustPanicOutputParser::handlePanic(const QString &text)
+{
+    QRegularExpressionMatch match = panicPattern().match(text);
+    const bool oldFormat = !match.hasMatch();
+    if (oldFormat) {
+        match = oldPanicPattern().match(text);
+        if (!match.hasMatch())
+            return Status::NotHandled;
+    }
+
+    const int locationGroup = oldFormat ? 3 : 2;
+    int line = -1;
+    const FilePath file = resolvedLocation(match.captured(locationGroup), &line);
+    m_panic = Task(Task::Error, Tr::tr("Thread \"%1\" panicked").arg(match.captured(1)), file,
+                   line, RustErrorTaskCategory);
+    m_panic.details.append(text);
+    m_frames.clear();
+    m_frameSymbol.clear();
+    if (oldFormat) {
+        m_panic.summary += ": " + match.captured(2);
+        m_state = State::AfterMessage;
+    } else {
+        m_state = State::Message;
+    }
+
+    LinkSpecs links;
+    addLinkSpecForAbsoluteFilePath(links, file, line, match.capturedStart(locationGroup),
+                                   match.capturedLength(locationGroup));
+    return {Status::InProgress, links};
+}
+
+OutputLineParser::Result RustPanicOutputParser::handleBacktraceLine(const QString &text)
+{
+    const QString line = rightTrimmed(text);
+
+    const QRegularExpressionMatch location = frameLocationPattern().match(line);
+    if (location.hasMatch()) {
+        m_panic.details.append(line);
+        int lineNumber = -1;
+        const FilePath file = resolvedLocation(location.captured(1), &lineNumber);
+        // Frames in the standard library and in dependencies are noise in
+        // the issues pane, they stay in the output only.
+        if (!m_frameSymbol.isEmpty() && file.isChildOf(m_projectDirectory)) {
+            m_frames.append(Task(Task::Unknown, m_frameSymbol, file, lineNumber,
+                                 RustErrorTaskCategory));
+            m_frameSymbol.clear();
+        }
+        LinkSpecs links;
+        addLinkSpecForAbsoluteFilePath(links, file, lineNumber, location.capturedStart(1),
+                                       location.capturedLength(1));
+        return {Status::InProgress, links};
+    }
+
+    const QRegularExpressionMatch frame = framePattern().match(line);
+    if (frame.hasMatch()) {
+        m_frameSymbol = demangled(frame.captured(1));
+        if (m_frameSymbol == frame.captured(1)) {
+            m_panic.details.append(line);
+            return Status::InProgress;
+        }
+        const QString demangledText = demangled(text);
+        m_panic.details.append(rightTrimmed(demangledText));
+        return {Status::InProgress, {}, demangledText};
+    }
+
+    if (line.startsWith("note: Some details are omitted")) {
+        finishPanic();
+        return Status::Done;
+    }
+
+    // Anything else ends the backtrace, e.g. the panic of another thread.
+    finishPanic();
+    return handleLine(text, StdErrFormat);
+}
+
+OutputLineParser::Result RustPanicOutputParser::handleOtherLine(const QString &text)
+{
+    if (!mayContainRustSymbol(text))
+        return Status::NotHandled;
+    const QString result = demangleRustSymbols(text);
+    if (result == text)
+        return Status::NotHandled;
+    return {Status::Done, {}, result};
+}
+
+void RustPanicOutputParser::flush()
+{
+    // Nothing follows the backtrace of a program that exits after the panic.
+    if (m_state != State::Idle)
+        finishPanic();
+    RustTaskQueue::instance()->flush();
+}
+
+FilePath RustPanicOutputParser::resolvedLocation(const QString &location, int *line) const
+{
+    // "src/main.rs:5:9" or "/rustc/<hash>/library/core/src/option.rs:2020"
+    QStringList parts = location.split(':');
+    if (parts.size() >= 3 && parts.last().toInt() > 0 && parts.at(parts.size() - 2).toInt() > 0)
+        parts.removeLast();
+    *line = parts.takeLast().toInt();
+    return absoluteFilePath(FilePath::fromUserInput(parts.join(':')));
+}
+
+void RustPanicOutputParser::finishPanic()
+{
+    // A panic inside the standard library (unwrap() on None, an index out of
+    // bounds, ...) is best reported at the first frame of the project's code.
+    if (!m_panic.file.isChildOf(m_projectDirectory) && !m_frames.isEmpty()) {
+        m_panic.file = m_frames.first().file;
+        m_panic.line = m_frames.first().line;
+        m_panic.movedLine = m_panic.line;
+    }
+
+    Tasks group;
+    group.reserve(m_frames.size() + 1);
+    group.append(m_panic);
+    group.append(m_frames);
+    RustTaskQueue::instance()->addGroup(group);
+
+    m_panic = {};
+    m_frames.clear();
+    m_frameSymbol.clear();
+    m_state = State::Idle;
+}
+
+} // Rusty::Internal
@@ -0,0 +1,49 @@
+#ifndef RUSTPANICPARSER_H
+#define RUSTPANICPARSER_H
+
+#include <projectexplorer/task.h>
+
+#include <utils/outputformatter.h>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Turns panics in the output of Rust programs into issues
+ *
+ * Recognizes "thread 'main' panicked at src/main.rs:5:9:" (and the format
+ * before Rust 1.73, which has the message in the same line) together with
+ * the message and the backtrace printed with RUST_BACKTRACE set. Locations
+ * become links, the panic an issue with the frames of the project's own code
+ * as notes. Mangled symbols, e.g. in RUST_BACKTRACE=full traces or in log
+ * output, are demangled on the way.
+ *
+ * Programs may print hundreds of thousands of lines per second, so lines
+ * outside of a panic are only looked at with a few cheap prefix checks.
+ */
+class RustPanicOutputParser : public Utils::OutputLineParser
+{
+public:
+    explicit RustPanicOutputParser(const Utils::FilePath &projectDirectory);
+
+private:
+    enum class State { Idle, Message, AfterMessage, Backtrace };
+
+    Result handleLine(const QString &text, Utils::OutputFormat format) final;
+    void flush() final;
+
+    Result handlePanic(const QString &text);
+    Result handleBacktraceLine(const QString &text);
+    Result handleOtherLine(const QString &text);
+    Utils::FilePath resolvedLocation(const QString &location, int *line) const;
+    void finishPanic();
+
+    const Utils::FilePath m_projectDirectory;
+    State m_state = State::Idle;
+    ProjectExplorer::Task m_panic;
+    ProjectExplorer::Tasks m_frames;
+    QString m_frameSymbol;
+};
+
+} // Rusty::Internal
+
+#endif // RUSTPANICPARSER_H
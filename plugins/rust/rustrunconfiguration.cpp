@@ -1,13 +1,17 @@
 #include "rustrunconfiguration.h"
 
+#include "cargobuildscheduler.h"
 #include "cratesupport.h"
+#include "perfstat.h"
 #include "rsside.h"
 #include "rssidebuildconfiguration.h"
 #include "rssideuicextracompiler.h"
 #include "rustyconstants.h"
 #include "rustlanguageclient.h"
+#include "rustpanicparser.h"
 #include "rustproject.h"
 #include "rustsettings.h"
+#include "rusttaskqueue.h"
 #include "rusttr.h"
 
 #include <coreplugin/icore.h>
@@ -89,9 +93,11 @@ private:
             }
         } else {
             // The actual exception. This ends the traceback.
-            TaskHub::addTask({Task::Error, text, {}, -1, category});
-            for (auto rit = m_tasks.crbegin(), rend = m_tasks.crend(); rit != rend; ++rit)
-                TaskHub::addTask(*rit);
+            Tasks group;
+            group.reserve(m_tasks.size() + 1);
+            group.append({Task::Error, text, {}, -1, category});
+            std::copy(m_tasks.crbegin(), m_tasks.crend(), std::back_inserter(group));
+            RustTaskQueue::instance()->addGroup(group);
             m_tasks.clear();
             m_inTraceBack = false;
             status = Status::Done;
@@ -99,6 +105,8 @@ private:
         return status;
     }
 
+    void flush() final { RustTaskQueue::instance()->flush(); }
+
     bool handleLink(const QString &href) final
     {
         const QRegularExpressionMatch match = filePattern.match(href);
@@ -112,7 +120,7 @@ private:
 
     const QRegularExpression filePattern;
     QList<Task> m_tasks;
-    bool m_inTraceBack;
+    bool m_inTraceBack = false;
 };
 
 ////////////////////////////////////////////////////////////////
@@ -328,6 +336,58 @@ void RustInterpreterAspectPrivate::updateExtraCompilers()
 
 const char RUST_EXECUTABLE_RUNCONFIG_ID[] = "ProjectExplorer.RustRunConfiguration";
 
+static bool isNewerThanInputs(const FilePath &executable, const Project *project)
+{
+    const QDateTime built = executable.lastModified();
+    const FilePath projectDirectory = project->projectDirectory();
+    FilePaths inputs = project->files(Project::SourceFiles);
+    inputs << projectDirectory.pathAppended("Cargo.toml")
+           << projectDirectory.pathAppended("Cargo.lock");
+    for (const FilePath &input : std::as_const(inputs)) {
+        if (input.lastModified() > built)
+            return false;
+    }
+    return true;
+}
+
+// The executable must be in the target directory of the active build
+// configuration and newer than every source and manifest.
+FilePath freshArtifact(const Target *target, const QString &buildKey)
+{
+    auto bc = qobject_cast<RsSideBuildConfiguration *>(target->activeBuildConfiguration());
+    if (!bc)
+        return {};
+    const FilePath executable = bc->executableFor(FilePath::fromString(buildKey));
+    if (!executable.isExecutableFile() || !executable.isChildOf(bc->cargoTargetDirectory()))
+        return {};
+
+    // The command line is asked for on every update of the run settings,
+    // stat'ing all sources each time is far too slow for large workspaces.
+    class Freshness
+    {
+    public:
+        QPair<int, int> generation;
+        bool fresh = false;
+    };
+    static QHash<FilePath, Freshness> cache;
+    CargoBuildScheduler *scheduler = CargoBuildScheduler::instance();
+    if (!scheduler)
+        return isNewerThanInputs(executable, target->project()) ? executable : FilePath();
+    auto it = cache.find(executable);
+    if (it == cache.end() || it->generation != scheduler->generation()) {
+        it = cache.insert(executable, {scheduler->generation(),
+                                       isNewerThanInputs(executable, target->project())});
+    }
+    return it->fresh ? executable : FilePath();
+}
+
+static CommandLine cargoRunCommand(const FilePath &cargo, const Target *target)
+{
+    CommandLine cmd{cargo, {"run"}};
+    if (auto bc = qobject_cast<RsSideBuildConfiguration *>(target->activeBuildConfiguration()))
+        cmd.addArgs(bc->cargoArguments());
+    return cmd;
+}
 
 class RustRunConfiguration : public RunConfiguration
 {
@@ -346,9 +406,57 @@ public:
 
         workingDir.setMacroExpander(macroExpander());
 
-        setCommandLineGetter([this] {
-            CommandLine cmd{interpreter.currentInterpreter().command};
-            cmd.addArg("run");
+        runArtifact.setSettingsKey("RustEditor.RunConfiguration.RunArtifact");
+        runArtifact.setLabel(Tr::tr("Run the built executable directly"),
+                             BoolAspect::LabelPlacement::AtCheckBox);
+        runArtifact.setToolTip(Tr::tr("Starts the executable of the last build without going "
+                                      "through cargo run. Falls back to cargo run when a "
+                                      "source file is newer than the executable."));
+        runArtifact.setDefaultValue(true);
+
+        benchmarkRuns.setId(Constants::BENCHMARK_RUNS_ID);
+        benchmarkRuns.setSettingsKey(Constants::BENCHMARK_RUNS_ID);
+        benchmarkRuns.setLabelText(Tr::tr("Benchmark runs:"));
+        benchmarkRuns.setToolTip(Tr::tr("How often the executable is started when the project "
+                                        "is run in benchmark mode."));
+        benchmarkRuns.setRange(1, 10000);
+        benchmarkRuns.setDefaultValue(10);
+
+        benchmarkWarmups.setId(Constants::BENCHMARK_WARMUPS_ID);
+        benchmarkWarmups.setSettingsKey(Constants::BENCHMARK_WARMUPS_ID);
+        benchmarkWarmups.setLabelText(Tr::tr("Benchmark warmup runs:"));
+        benchmarkWarmups.setToolTip(Tr::tr("Runs before the measured ones that fill the page "
+                                           "cache and wake up the CPU, their timings are "
+                                           "not used."));
+        benchmarkWarmups.setRange(0, 1000);
+        benchmarkWarmups.setDefaultValue(3);
+
+        benchmarkInput.setId(Constants::BENCHMARK_INPUT_ID);
+        benchmarkInput.setSettingsKey(Constants::BENCHMARK_INPUT_ID);
+        benchmarkInput.setLabelText(Tr::tr("Benchmark input:"));
+        benchmarkInput.setToolTip(Tr::tr("File fed to the standard input of every benchmark "
+                                         "run. Relative to the working directory."));
+        benchmarkInput.setExpectedKind(PathChooser::File);
+        benchmarkInput.setPlaceHolderText(Tr::tr("None"));
+
+        perfStatEvents.setId(Constants::PERF_STAT_EVENTS_ID);
+        perfStatEvents.setSettingsKey(Constants::PERF_STAT_EVENTS_ID);
+        perfStatEvents.setLabelText(Tr::tr("Hardware events:"));
+        perfStatEvents.setToolTip(Tr::tr("Comma separated perf events counted when the project "
+                                         "is run in hardware counter mode, see perf list."));
+        perfStatEvents.setDisplayStyle(StringAspect::LineEditDisplay);
+        perfStatEvents.setPlaceHolderText(defaultPerfStatEvents().join(','));
+
+        setCommandLineGetter([this, target] {
+            CommandLine cmd;
+            const FilePath artifact = runArtifact() ? freshArtifact(target, buildKey())
+                                                    : FilePath();
+            if (!artifact.isEmpty()) {
+                cmd.setExecutable(artifact);
+            } else {
+                cmd = cargoRunCommand(interpreter.currentInterpreter().command, target);
+                cmd.addArg("--");
+            }
             cmd.addArgs(arguments(), CommandLine::Raw);
             return cmd;
         });
@@ -367,28 +475,15 @@ public:
     EnvironmentAspect environment{this};
     ArgumentsAspect arguments{this};
     WorkingDirectoryAspect workingDir{this};
+    BoolAspect runArtifact{this};
+    IntegerAspect benchmarkRuns{this};
+    IntegerAspect benchmarkWarmups{this};
+    FilePathAspect benchmarkInput{this};
+    StringAspect perfStatEvents{this};
 
     TerminalAspect terminal{this};
 };
 
-static CommandLine rustRunCommand(const Target *target,
-                                const QString &buildKey)
-{
-    if (BuildConfiguration *bc = target->activeBuildConfiguration()) {
-        const Environment env = bc->environment();
-        const FilePath emrun = env.searchInPath("cargo");
-        const FilePath emrunPy = emrun.absolutePath().pathAppended(emrun.baseName() + ".rs");
-
-        QStringList args(emrunPy.path());
-        args.append("--port");
-        args.append("--no_emrun_detect");
-        args.append("--serve_after_close");
-
-        return CommandLine("test.exe", args);
-    }
-    return {};
-}
-
 class RustRunWorker : public SimpleTargetRunner
 {
 public:
@@ -409,13 +504,8 @@ public:
         });
         */
 
-        setStartModifier([this, runControl] {
-            setCommandLine(rustRunCommand(runControl->target(),
-                                          runControl->buildKey()));
-
-            setEnvironment(runControl->buildEnvironment());
-        });
-
+        // The run configuration's command line already is the fresh artifact
+        // or cargo run, with the configured arguments and environment.
     }
 };
 
@@ -431,7 +521,8 @@ RustOutputFormatterFactory::RustOutputFormatterFactory()
 {
     setFormatterCreator([](Target *t) -> QList<OutputLineParser *> {
         if (t && t->project()->mimeType() == Constants::C_RS_MIMETYPE)
-            return {new PythonOutputLineParser};
+            return {new RustPanicOutputParser(t->project()->projectDirectory()),
+                    new PythonOutputLineParser};
         return {};
     });
 }
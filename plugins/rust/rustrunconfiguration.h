@@ -38,6 +38,10 @@ public:
     RustOutputFormatterFactory();
 };
 
+// The executable the last build produced for the target built from buildKey,
+// empty if there is none or cargo would rebuild it.
+Utils::FilePath freshArtifact(const ProjectExplorer::Target *target, const QString &buildKey);
+
 class RustRunWorkerFactory final : public ProjectExplorer::RunWorkerFactory
 {
 public:
@@ -0,0 +1,101 @@
+#include "rusttaskqueue.h"
+
+#include "rusty.h"
+
+#include <projectexplorer/taskhub.h>
+
+#include <utils/algorithm.h>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+const int flushIntervalMs = 100;
+
+RustTaskQueue *RustTaskQueue::instance()
+{
+    static RustTaskQueue *instance = new RustTaskQueue;
+    return instance;
+}
+
+RustTaskQueue::RustTaskQueue()
+    : QObject(RustyPlugin::instance())
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(flushIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &RustTaskQueue::processBatch);
+    // Several build steps parse cargo output in one build, what they reported
+    // is only forgotten when the BuildManager clears the issues.
+    connect(TaskHub::instance(), &TaskHub::tasksCleared, this, &RustTaskQueue::clear);
+}
+
+Tasks RustTaskQueue::filterGroup(const Tasks &group)
+{
+    if (group.isEmpty())
+        return {};
+
+    // The first task of a group is the diagnostic itself, the rest are notes
+    // attached to it. Identical diagnostics come with identical notes.
+    const Task &primary = group.first();
+    const ReportedTask key{primary.file, primary.line, primary.column, primary.summary};
+    if (!Utils::insert(m_reported[primary.category], key))
+        return {};
+
+    Tasks result = group;
+    QHash<FilePath, int> &textMarks = m_textMarks[primary.category];
+    for (Task &task : result) {
+        if (task.options & Task::AddTextMark) {
+            int &marks = textMarks[task.file];
+            if (marks >= MaxTextMarksPerFile)
+                task.options &= ~Task::AddTextMark;
+            else
+                ++marks;
+        }
+    }
+    return result;
+}
+
+void RustTaskQueue::addGroup(const Tasks &group)
+{
+    addFiltered(filterGroup(group));
+}
+
+void RustTaskQueue::addFiltered(const Tasks &tasks)
+{
+    if (tasks.isEmpty())
+        return;
+    for (const Task &task : tasks)
+        m_pending.enqueue(task);
+
+    if (!m_timer.isActive())
+        m_timer.start(flushIntervalMs);
+}
+
+void RustTaskQueue::clear(Id category)
+{
+    m_reported.remove(category);
+    m_textMarks.remove(category);
+    m_pending.removeIf([category](const Task &task) { return task.category == category; });
+}
+
+void RustTaskQueue::flush()
+{
+    m_timer.stop();
+    for (const Task &task : std::as_const(m_pending))
+        TaskHub::addTask(task);
+    m_pending.clear();
+}
+
+void RustTaskQueue::processBatch()
+{
+    for (int i = 0; i < BatchSize && !m_pending.isEmpty(); ++i)
+        TaskHub::addTask(m_pending.dequeue());
+
+    // Keep the event loop responsive, continue with the next batch as soon as
+    // pending events have been processed.
+    if (!m_pending.isEmpty())
+        m_timer.start(0);
+}
+
+} // Rusty::Internal
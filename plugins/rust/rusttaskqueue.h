@@ -0,0 +1,79 @@
+#ifndef RUSTTASKQUEUE_H
+#define RUSTTASKQUEUE_H
+
+#include <projectexplorer/task.h>
+
+#include <QHash>
+#include <QQueue>
+#include <QSet>
+#include <QTimer>
+
+namespace Rusty::Internal {
+
+/**
+ * @brief Feeds tasks into the TaskHub in batches
+ *
+ * A warning heavy build produces tens of thousands of tasks. Adding each of
+ * them directly updates the issues model and creates a text mark every time.
+ * The queue collects one group of tasks per diagnostic, drops groups that were
+ * already reported (the same warning is emitted for lib and test builds of a
+ * file) and hands them to the TaskHub on a timer. Only the first
+ * MaxTextMarksPerFile tasks of a file get a text mark.
+ *
+ * Build output parsers filter their groups with filterGroup() and link the
+ * tasks to their lines in the compile output before they queue them with
+ * addFiltered(), the link is made by task id and survives the wait.
+ *
+ * The queue forgets what it knows about a category when the TaskHub clears
+ * its tasks.
+ */
+class RustTaskQueue : public QObject
+{
+public:
+    static RustTaskQueue *instance();
+
+    // Returns nothing if the group was already reported, otherwise the group
+    // with text marks beyond the limit removed.
+    ProjectExplorer::Tasks filterGroup(const ProjectExplorer::Tasks &group);
+    void addGroup(const ProjectExplorer::Tasks &group);
+    // Queues tasks that went through filterGroup() already.
+    void addFiltered(const ProjectExplorer::Tasks &tasks);
+    void flush();
+
+    static constexpr int MaxTextMarksPerFile = 100;
+    static constexpr int BatchSize = 500;
+
+private:
+    RustTaskQueue();
+
+    class ReportedTask
+    {
+    public:
+        Utils::FilePath file;
+        int line = -1;
+        int column = 0;
+        QString summary;
+
+        friend bool operator==(const ReportedTask &a, const ReportedTask &b)
+        {
+            return a.file == b.file && a.line == b.line && a.column == b.column
+                   && a.summary == b.summary;
+        }
+        friend size_t qHash(const ReportedTask &task, size_t seed = 0)
+        {
+            return qHashMulti(seed, task.file, task.line, task.column, task.summary);
+        }
+    };
+
+    void clear(Utils::Id category);
+    void processBatch();
+
+    QQueue<ProjectExplorer::Task> m_pending;
+    QHash<Utils::Id, QSet<ReportedTask>> m_reported;
+    QHash<Utils::Id, QHash<Utils::FilePath, int>> m_textMarks;
+    QTimer m_timer;
+};
+
+} // Rusty::Internal
+
+#endif // RUSTTASKQUEUE_H
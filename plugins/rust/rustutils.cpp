@@ -149,6 +149,12 @@ QString rustName(const FilePath &pythonPath)
     return name;
 }
 
+FilePath rustyDataDirectory(const FilePath &projectDirectory)
+{
+    // Project local data, next to the settings Qt Creator keeps in .qtcreator.
+    return projectDirectory.pathAppended(".qtcreator/rusty");
+}
+
 RustProject *rustProjectForFile(const FilePath &pythonFile)
 {
     for (Project *project : ProjectManager::projects()) {
@@ -10,6 +10,7 @@ void openRustRepl(QObject *parent, const Utils::FilePath &file, ReplType type);
 Utils::FilePath detectCargo(const Utils::FilePath &documentPath);
 void defineRustForDocument(const Utils::FilePath &documentPath, const Utils::FilePath &python);
 QString rustName(const Utils::FilePath &pythonPath);
+Utils::FilePath rustyDataDirectory(const Utils::FilePath &projectDirectory);
 
 class RustProject;
 RustProject *rustProjectForFile(const Utils::FilePath &pythonFile);
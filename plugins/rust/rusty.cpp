@@ -17,6 +17,19 @@
 #include <QMainWindow>
 #include <QMenu>
 
+#include "benchmarkrunner.h"
+#include "benchmarkview.h"
+#include "buildhistoryview.h"
+#include "buildtimingsview.h"
+#include "cachegrindprofiler.h"
+#include "cargobuildscheduler.h"
+#include "cargofeaturematrixstep.h"
+#include "dependencyprebuilder.h"
+#include "heapprofiler.h"
+#include "optimizationremarks.h"
+#include "perfprofiler.h"
+#include "perfstatrunner.h"
+#include "perfstatview.h"
 #include "rssidebuildconfiguration.h"
 #include "rusteditor.h"
 #include "rustproject.h"
@@ -24,15 +37,19 @@
 #include "rustsettings.h"
 #include "rusttr.h"
 #include "rustwizardpagefactory.h"
+#include "sourceannotations.h"
+#include "targetusageview.h"
 
 #include <projectexplorer/buildtargetinfo.h>
 #include <projectexplorer/jsonwizard/jsonwizardfactory.h>
+#include <projectexplorer/projectexplorer.h>
 #include <projectexplorer/projectexplorerconstants.h>
 #include <projectexplorer/projectmanager.h>
 #include <projectexplorer/taskhub.h>
 
 
 #include <utils/fsengine/fileiconprovider.h>
+#include <utils/hostosinfo.h>
 #include <utils/theme/theme.h>
 
 using namespace ProjectExplorer;
@@ -46,14 +63,24 @@ static RustyPlugin *m_instance = nullptr;
 class RustyPluginPrivate
 {
 public:
+    SourceAnnotations sourceAnnotations;
+    OptimizationRemarks optimizationRemarks;
     RustEditorFactory editorFactory;
     RustOutputFormatterFactory outputFormatterFactory;
     RustRunConfigurationFactory runConfigFactory;
     RsSideBuildStepFactory buildStepFactory;
     RsSideBuildConfigurationFactory buildConfigFactory;
+    CargoFeatureMatrixStepFactory featureMatrixStepFactory;
     SimpleTargetRunnerFactory runWorkerFactory{{runConfigFactory.runConfigurationId()}};
+    BenchmarkRunWorkerFactory benchmarkWorkerFactory;
+    PerfRecordRunWorkerFactory perfRecordWorkerFactory;
+    PerfStatRunWorkerFactory perfStatWorkerFactory;
+    HeapProfilerRunWorkerFactory heapProfilerWorkerFactory;
+    CachegrindRunWorkerFactory cachegrindWorkerFactory;
     RustSettings settings;
     RustWizardPageFactory rustWizardOageFactory;
+    DependencyPrebuilder dependencyPrebuilder;
+    CargoBuildScheduler buildScheduler;
 };
 
 
@@ -96,6 +123,125 @@ bool RustyPlugin::initialize(const QStringList &arguments, QString *errorString)
     menu->addAction(cmd);
     Core::ActionManager::actionContainer(Core::Constants::M_TOOLS)->addMenu(menu);
 
+    auto timingsAction = new QAction(tr("Build Timings..."), this);
+    menu->addAction(Core::ActionManager::registerAction(timingsAction,
+                                                        Constants::BUILD_TIMINGS_ACTION_ID));
+    connect(timingsAction, &QAction::triggered, this, [] {
+        showBuildTimings(ProjectManager::startupProject());
+    });
+
+    auto historyAction = new QAction(tr("Compile Time History..."), this);
+    menu->addAction(Core::ActionManager::registerAction(historyAction,
+                                                        Constants::BUILD_HISTORY_ACTION_ID));
+    connect(historyAction, &QAction::triggered, this, [] {
+        showBuildHistory(ProjectManager::startupProject());
+    });
+
+    auto targetUsageAction = new QAction(tr("Target Directory Usage..."), this);
+    menu->addAction(Core::ActionManager::registerAction(targetUsageAction,
+                                                        Constants::TARGET_USAGE_ACTION_ID));
+    connect(targetUsageAction, &QAction::triggered, this, [] {
+        showTargetUsage(ProjectManager::startupProject());
+    });
+
+    auto benchmarkAction = new QAction(tr("Benchmark Startup Project"), this);
+    menu->addAction(Core::ActionManager::registerAction(benchmarkAction,
+                                                        Constants::BENCHMARK_ACTION_ID));
+    connect(benchmarkAction, &QAction::triggered, this, [] {
+        ProjectExplorerPlugin::runStartupProject(Constants::BENCHMARK_RUN_MODE);
+    });
+
+    auto benchmarkResultsAction = new QAction(tr("Benchmark Results..."), this);
+    menu->addAction(Core::ActionManager::registerAction(benchmarkResultsAction,
+                                                        Constants::BENCHMARK_RESULTS_ACTION_ID));
+    connect(benchmarkResultsAction, &QAction::triggered, this, [] {
+        showBenchmarkResults(ProjectManager::startupProject());
+    });
+
+    auto perfAction = new QAction(tr("Profile Startup Project with perf"), this);
+    menu->addAction(Core::ActionManager::registerAction(perfAction,
+                                                        Constants::PERF_PROFILE_ACTION_ID));
+    perfAction->setVisible(HostOsInfo::isLinuxHost());
+    connect(perfAction, &QAction::triggered, this, [] {
+        profileStartupProject(Constants::PERF_RUN_MODE);
+    });
+
+    auto offCpuAction = new QAction(tr("Profile Off-CPU Time of Startup Project"), this);
+    offCpuAction->setToolTip(tr("Records where the threads of the program block on locks, "
+                                "futexes and system calls, and for how long."));
+    menu->addAction(Core::ActionManager::registerAction(offCpuAction,
+                                                        Constants::PERF_OFFCPU_ACTION_ID));
+    offCpuAction->setVisible(HostOsInfo::isLinuxHost());
+    connect(offCpuAction, &QAction::triggered, this, [] {
+        profileStartupProject(Constants::PERF_OFFCPU_RUN_MODE);
+    });
+
+    auto perfCompareAction = new QAction(tr("Compare perf Recordings..."), this);
+    menu->addAction(Core::ActionManager::registerAction(perfCompareAction,
+                                                        Constants::PERF_COMPARE_ACTION_ID));
+    perfCompareAction->setVisible(HostOsInfo::isLinuxHost());
+    connect(perfCompareAction, &QAction::triggered, this, &comparePerfRecordings);
+
+    auto perfStatAction = new QAction(tr("Count Hardware Events of Startup Project"), this);
+    menu->addAction(Core::ActionManager::registerAction(perfStatAction,
+                                                        Constants::PERF_STAT_ACTION_ID));
+    perfStatAction->setVisible(HostOsInfo::isLinuxHost());
+    connect(perfStatAction, &QAction::triggered, this, [] {
+        ProjectExplorerPlugin::runStartupProject(Constants::PERF_STAT_RUN_MODE);
+    });
+
+    auto perfStatHistoryAction = new QAction(tr("Hardware Counter History..."), this);
+    menu->addAction(Core::ActionManager::registerAction(perfStatHistoryAction,
+                                                        Constants::PERF_STAT_HISTORY_ACTION_ID));
+    perfStatHistoryAction->setVisible(HostOsInfo::isLinuxHost());
+    connect(perfStatHistoryAction, &QAction::triggered, this, [] {
+        showPerfStatHistory(ProjectManager::startupProject());
+    });
+
+    auto heapAction = new QAction(tr("Profile Heap Allocations of Startup Project"), this);
+    heapAction->setToolTip(tr("Runs the program under valgrind's DHAT and lists its "
+                              "allocations per call site."));
+    menu->addAction(Core::ActionManager::registerAction(heapAction,
+                                                        Constants::HEAP_PROFILE_ACTION_ID));
+    heapAction->setVisible(HostOsInfo::isLinuxHost());
+    connect(heapAction, &QAction::triggered, this, [] {
+        profileStartupProject(Constants::HEAP_RUN_MODE);
+    });
+
+    auto cachegrindAction = new QAction(tr("Simulate Caches of Startup Project"), this);
+    cachegrindAction->setToolTip(tr("Runs the program under valgrind's cachegrind and "
+                                    "annotates instructions and cache misses per line."));
+    menu->addAction(Core::ActionManager::registerAction(cachegrindAction,
+                                                        Constants::CACHEGRIND_ACTION_ID));
+    cachegrindAction->setVisible(HostOsInfo::isLinuxHost());
+    connect(cachegrindAction, &QAction::triggered, this, [] {
+        profileStartupProject(Constants::CACHEGRIND_RUN_MODE);
+    });
+
+    Core::ActionContainer *remarksMenu
+        = Core::ActionManager::createMenu(Constants::REMARKS_MENU_ID);
+    remarksMenu->menu()->setTitle(tr("Missed Optimizations"));
+    menu->addMenu(remarksMenu);
+    for (const QString &pass : OptimizationRemarks::passes()) {
+        auto passAction = new QAction(OptimizationRemarks::passDisplayName(pass), this);
+        passAction->setCheckable(true);
+        passAction->setChecked(true);
+        passAction->setToolTip(tr("Shows the missed %1 remarks of builds with optimization "
+                                  "remarks enabled.").arg(pass));
+        remarksMenu->addAction(Core::ActionManager::registerAction(
+            passAction, Id(Constants::REMARKS_PASS_ACTION_PREFIX).withSuffix(pass)));
+        connect(passAction, &QAction::toggled, this, [pass](bool shown) {
+            OptimizationRemarks::instance()->setPassShown(pass, shown);
+        });
+    }
+
+    auto clearAnnotationsAction = new QAction(tr("Clear Source Annotations"), this);
+    menu->addAction(Core::ActionManager::registerAction(clearAnnotationsAction,
+                                                        Constants::CLEAR_ANNOTATIONS_ACTION_ID));
+    connect(clearAnnotationsAction, &QAction::triggered, this, [] {
+        SourceAnnotations::instance()->clearAll();
+    });
+
     d = new RustyPluginPrivate;        
 
 
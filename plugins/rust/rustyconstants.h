@@ -5,6 +5,32 @@ namespace Rusty::Constants {
 
 const char ACTION_ID[] = "Rusty.Action";
 const char MENU_ID[] = "Rusty.Menu";
+const char BUILD_TIMINGS_ACTION_ID[] = "Rusty.BuildTimings";
+const char BUILD_HISTORY_ACTION_ID[] = "Rusty.BuildHistory";
+const char TARGET_USAGE_ACTION_ID[] = "Rusty.TargetUsage";
+const char BENCHMARK_ACTION_ID[] = "Rusty.Benchmark";
+const char BENCHMARK_RESULTS_ACTION_ID[] = "Rusty.BenchmarkResults";
+const char PERF_PROFILE_ACTION_ID[] = "Rusty.PerfProfile";
+const char PERF_OFFCPU_ACTION_ID[] = "Rusty.PerfOffCpu";
+const char PERF_COMPARE_ACTION_ID[] = "Rusty.PerfCompare";
+const char PERF_STAT_ACTION_ID[] = "Rusty.PerfStat";
+const char PERF_STAT_HISTORY_ACTION_ID[] = "Rusty.PerfStatHistory";
+const char HEAP_PROFILE_ACTION_ID[] = "Rusty.HeapProfile";
+const char CACHEGRIND_ACTION_ID[] = "Rusty.Cachegrind";
+const char REMARKS_MENU_ID[] = "Rusty.OptimizationRemarksMenu";
+const char REMARKS_PASS_ACTION_PREFIX[] = "Rusty.OptimizationRemarks.";
+const char CLEAR_ANNOTATIONS_ACTION_ID[] = "Rusty.ClearSourceAnnotations";
+
+const char BENCHMARK_RUN_MODE[] = "Rusty.BenchmarkRunMode";
+const char PERF_RUN_MODE[] = "Rusty.PerfRecordRunMode";
+const char PERF_OFFCPU_RUN_MODE[] = "Rusty.PerfOffCpuRunMode";
+const char PERF_STAT_RUN_MODE[] = "Rusty.PerfStatRunMode";
+const char HEAP_RUN_MODE[] = "Rusty.HeapRunMode";
+const char CACHEGRIND_RUN_MODE[] = "Rusty.CachegrindRunMode";
+const char BENCHMARK_RUNS_ID[] = "RustEditor.RunConfiguration.BenchmarkRuns";
+const char BENCHMARK_WARMUPS_ID[] = "RustEditor.RunConfiguration.BenchmarkWarmups";
+const char BENCHMARK_INPUT_ID[] = "RustEditor.RunConfiguration.BenchmarkInput";
+const char PERF_STAT_EVENTS_ID[] = "RustEditor.RunConfiguration.PerfStatEvents";
 
 const char RUST_LANGUAGE_ID[] = "Rust";
 
@@ -20,6 +46,9 @@ const char C_RUST_SETTINGS_CATEGORY[] = "R.Rust";
 const char RUST_OPEN_REPL[] = "Rust.OpenRepl";
 const char RUST_OPEN_REPL_IMPORT[] = "Rust.OpenReplImport";
 const char RUST_OPEN_REPL_IMPORT_TOPLEVEL[] = "Rust.OpenReplImportToplevel";
+const char RUST_SHOW_ASSEMBLY[] = "Rust.ShowAssembly";
+const char RUST_IR_BLOAT_REPORT[] = "Rust.IrBloatReport";
+const char M_RUST_EDITOR_CONTEXT[] = "Rust.EditorContextMenu";
 
 const char RSLS_SETTINGS_ID[] = "Rust.RsLSSettingsID";
 
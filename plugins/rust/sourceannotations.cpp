@@ -0,0 +1,127 @@
+#include "sourceannotations.h"
+
+#include <texteditor/textdocument.h>
+#include <texteditor/texteditor.h>
+#include <texteditor/textmark.h>
+
+#include <QTextBlock>
+
+#include <algorithm>
+
+using namespace TextEditor;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+// Text marks are not free for the editor, only the hottest lines get one.
+// Backgrounds are cheap and shown for all annotated lines.
+const int maxMarksPerSource = 500;
+
+static SourceAnnotations *s_instance = nullptr;
+
+SourceAnnotations::SourceAnnotations()
+{
+    s_instance = this;
+}
+
+SourceAnnotations::~SourceAnnotations()
+{
+    s_instance = nullptr;
+}
+
+SourceAnnotations *SourceAnnotations::instance()
+{
+    return s_instance;
+}
+
+void SourceAnnotations::setAnnotations(Id source, const QString &displayName,
+                                       const SourceAnnotationMap &annotations,
+                                       const QColor &color)
+{
+    auto entry = std::make_shared<Source>();
+    entry->displayName = displayName;
+    entry->color = color;
+    entry->annotations = annotations;
+
+    QList<QPair<FilePath, const SourceAnnotation *>> hottest;
+    for (auto it = annotations.cbegin(), end = annotations.cend(); it != end; ++it) {
+        for (const SourceAnnotation &annotation : it.value())
+            hottest.append({it.key(), &annotation});
+    }
+    const auto marked = hottest.begin() + qMin(qsizetype(maxMarksPerSource), hottest.size());
+    std::partial_sort(hottest.begin(), marked, hottest.end(), [](const auto &a, const auto &b) {
+        return a.second->heat > b.second->heat;
+    });
+    hottest.erase(marked, hottest.end());
+
+    const TextMarkCategory category{displayName, source};
+    for (const auto &[file, annotation] : std::as_const(hottest)) {
+        auto mark = std::make_unique<TextMark>(file, annotation->line, category);
+        mark->setLineAnnotation(annotation->text);
+        mark->setToolTip(annotation->toolTip);
+        mark->setPriority(TextMark::LowPriority);
+        entry->marks.push_back(std::move(mark));
+    }
+
+    m_sources.insert(source, entry);
+    m_appliedSources.insert(source);
+    emit annotationsChanged();
+}
+
+void SourceAnnotations::clear(Id source)
+{
+    if (m_sources.remove(source))
+        emit annotationsChanged();
+}
+
+void SourceAnnotations::clearAll()
+{
+    if (m_sources.isEmpty())
+        return;
+    m_sources.clear();
+    emit annotationsChanged();
+}
+
+bool SourceAnnotations::hasAnnotations() const
+{
+    return !m_sources.isEmpty();
+}
+
+void SourceAnnotations::attach(TextEditorWidget *widget)
+{
+    const auto apply = [this, widget] { applyTo(widget); };
+    connect(this, &SourceAnnotations::annotationsChanged, widget, apply);
+    TextDocument *document = widget->textDocument();
+    // The widget is created before the document is loaded.
+    connect(document, &TextDocument::openFinishedSuccessfully, widget, apply);
+    connect(document, &TextDocument::filePathChanged, widget, apply);
+    connect(document, &TextDocument::reloadFinished, widget, apply);
+    applyTo(widget);
+}
+
+void SourceAnnotations::applyTo(TextEditorWidget *widget) const
+{
+    const FilePath file = widget->textDocument()->filePath();
+    QTextDocument *document = widget->document();
+    for (const Id source : m_appliedSources) {
+        QList<QTextEdit::ExtraSelection> selections;
+        if (const std::shared_ptr<Source> entry = m_sources.value(source)) {
+            for (const SourceAnnotation &annotation : entry->annotations.value(file)) {
+                const QTextBlock block = document->findBlockByNumber(annotation.line - 1);
+                if (!block.isValid())
+                    continue;
+                QColor background = entry->color;
+                background.setAlphaF(0.06 + 0.5 * qBound(0.0, annotation.heat, 1.0));
+                QTextEdit::ExtraSelection selection;
+                selection.cursor = QTextCursor(block);
+                selection.format.setBackground(background);
+                selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+                selection.format.setToolTip(annotation.toolTip);
+                selections.append(selection);
+            }
+        }
+        widget->setExtraSelections(source.withPrefix("Rusty.SourceAnnotations."), selections);
+    }
+}
+
+} // Rusty::Internal
@@ -0,0 +1,82 @@
+#ifndef SOURCEANNOTATIONS_H
+#define SOURCEANNOTATIONS_H
+
+#include <utils/filepath.h>
+#include <utils/id.h>
+
+#include <QColor>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+#include <memory>
+
+namespace TextEditor {
+class TextEditorWidget;
+class TextMark;
+}
+
+namespace Rusty::Internal {
+
+class SourceAnnotation
+{
+public:
+    int line = 0;
+    double heat = 0;   // 0 to 1, how strongly the line background is colored.
+    QString text;      // Shown at the end of the line.
+    QString toolTip;
+};
+
+using SourceAnnotationMap = QHash<Utils::FilePath, QList<SourceAnnotation>>;
+
+/**
+ * @brief Per-line annotations of source files from analysis tools
+ *
+ * Each source (a profiler, a heap profiler, the compiler's optimization
+ * remarks, ...) sets all of its annotations at once, they replace the
+ * previous ones of that source. Annotations are indexed by file, so editors
+ * find theirs with a single lookup when they are opened.
+ *
+ * Lines get a text mark with the annotation text at their end and, in
+ * editors attached with attach(), a background colored by their heat.
+ */
+class SourceAnnotations : public QObject
+{
+    Q_OBJECT
+
+public:
+    SourceAnnotations();
+    ~SourceAnnotations() override;
+
+    static SourceAnnotations *instance();
+
+    void setAnnotations(Utils::Id source, const QString &displayName,
+                        const SourceAnnotationMap &annotations, const QColor &color);
+    void clear(Utils::Id source);
+    void clearAll();
+    bool hasAnnotations() const;
+
+    void attach(TextEditor::TextEditorWidget *widget);
+
+signals:
+    void annotationsChanged();
+
+private:
+    class Source
+    {
+    public:
+        QString displayName;
+        QColor color;
+        SourceAnnotationMap annotations;
+        std::vector<std::unique_ptr<TextEditor::TextMark>> marks;
+    };
+
+    void applyTo(TextEditor::TextEditorWidget *widget) const;
+
+    QHash<Utils::Id, std::shared_ptr<Source>> m_sources;
+    QSet<Utils::Id> m_appliedSources; // Also the cleared ones, editors still show them.
+};
+
+} // Rusty::Internal
+
+#endif // SOURCEANNOTATIONS_H
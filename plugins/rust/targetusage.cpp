@@ -0,0 +1,318 @@
+#include "targetusage.h"
+
+#include "rusttr.h"
+
+#include <utils/async.h>
+
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+// Cargo's metadata hash, appended to every file and directory of a unit.
+const int unitHashLength = 16;
+
+QString artifactKindName(ArtifactKind kind)
+{
+    switch (kind) {
+    case ArtifactKind::Rlib: return Tr::tr("Rust libraries");
+    case ArtifactKind::Rmeta: return Tr::tr("Metadata");
+    case ArtifactKind::SharedLibrary: return Tr::tr("Shared libraries");
+    case ArtifactKind::Executable: return Tr::tr("Executables");
+    case ArtifactKind::DebugInfo: return Tr::tr("Debug information");
+    case ArtifactKind::DepInfo: return Tr::tr("Dependency files");
+    case ArtifactKind::BuildScript: return Tr::tr("Build scripts");
+    case ArtifactKind::Incremental: return Tr::tr("Incremental caches");
+    case ArtifactKind::Fingerprint: return Tr::tr("Fingerprints");
+    case ArtifactKind::Other: break;
+    }
+    return Tr::tr("Other");
+}
+
+qint64 TargetUsageReport::totalSize() const
+{
+    qint64 size = 0;
+    for (const TargetArtifact &artifact : artifacts)
+        size += artifact.size;
+    return size;
+}
+
+qint64 TargetUsageReport::staleSize() const
+{
+    qint64 size = 0;
+    for (const TargetArtifact &artifact : artifacts) {
+        if (artifact.stale)
+            size += artifact.size;
+    }
+    return size;
+}
+
+QList<TargetArtifact> TargetUsageReport::staleArtifacts() const
+{
+    QList<TargetArtifact> result;
+    for (const TargetArtifact &artifact : artifacts) {
+        if (artifact.stale)
+            result.append(artifact);
+    }
+    return result;
+}
+
+QHash<QString, qint64> TargetUsageReport::sizeByProfile() const
+{
+    QHash<QString, qint64> result;
+    for (const TargetArtifact &artifact : artifacts)
+        result[artifact.profile] += artifact.size;
+    return result;
+}
+
+QHash<QString, qint64> TargetUsageReport::sizeByCrate() const
+{
+    QHash<QString, qint64> result;
+    for (const TargetArtifact &artifact : artifacts)
+        result[artifact.crate] += artifact.size;
+    return result;
+}
+
+QHash<ArtifactKind, qint64> TargetUsageReport::sizeByKind() const
+{
+    QHash<ArtifactKind, qint64> result;
+    for (const TargetArtifact &artifact : artifacts)
+        result[artifact.kind] += artifact.size;
+    return result;
+}
+
+FilePaths cargoTargetDirectories(const FilePath &projectDirectory)
+{
+    const FilePath target = projectDirectory.pathAppended("target");
+    FilePaths roots;
+    if (target.isDir())
+        roots.append(target);
+    roots << target.pathAppended("qtc").dirEntries(QDir::Dirs | QDir::NoDotAndDotDot);
+    // Each slot of the feature matrix step is a target directory of its own.
+    FilePaths result = roots;
+    for (const FilePath &root : std::as_const(roots)) {
+        result << root.pathAppended("feature-matrix")
+                      .dirEntries(FileFilter({"slot-*"}, QDir::Dirs | QDir::NoDotAndDotDot));
+    }
+    return result;
+}
+
+static qint64 directorySize(const QString &path)
+{
+    qint64 size = 0;
+    QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::System | QDir::NoSymLinks,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext())
+        size += it.nextFileInfo().size();
+    return size;
+}
+
+// "serde_json-0a1b2c3d4e5f6789" -> "serde_json", "0a1b2c3d4e5f6789"
+static bool splitUnitName(const QString &stem, QString *name, QString *hash)
+{
+    const int dash = stem.lastIndexOf('-');
+    if (dash <= 0 || stem.size() - dash - 1 != unitHashLength)
+        return false;
+    bool ok = false;
+    stem.mid(dash + 1).toULongLong(&ok, 16);
+    if (!ok)
+        return false;
+    *name = stem.left(dash);
+    *hash = stem.mid(dash + 1);
+    return true;
+}
+
+static ArtifactKind kindForFile(const QFileInfo &info)
+{
+    const QString suffix = info.suffix();
+    if (suffix == "rlib")
+        return ArtifactKind::Rlib;
+    if (suffix == "rmeta")
+        return ArtifactKind::Rmeta;
+    if (suffix == "so" || suffix == "dylib" || suffix == "dll")
+        return ArtifactKind::SharedLibrary;
+    if (suffix == "d")
+        return ArtifactKind::DepInfo;
+    if (suffix == "dwp" || suffix == "dwo" || suffix == "pdb" || suffix == "dSYM")
+        return ArtifactKind::DebugInfo;
+    if (info.isFile() && info.isExecutable() && (suffix.isEmpty() || suffix == "exe"))
+        return ArtifactKind::Executable;
+    return ArtifactKind::Other;
+}
+
+// The fingerprint of a unit built from a registry or git source records the
+// package version (or git revision) as "Precalculated" local fingerprint,
+// path dependencies use their dep-info file instead and are never stale.
+static QString precalculatedVersion(const QString &fingerprintDirectory)
+{
+    QDirIterator it(fingerprintDirectory, {"*.json"}, QDir::Files);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        const QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+        for (const QJsonValue &local : object.value("local").toArray()) {
+            const QString version = local.toObject().value("Precalculated").toString();
+            if (!version.isEmpty())
+                return version;
+        }
+    }
+    return {};
+}
+
+class UnitDirectoryScan
+{
+public:
+    QList<TargetArtifact> artifacts;
+    QHash<QString, QPair<QString, QString>> packages; // Hash -> package name and version.
+};
+
+static UnitDirectoryScan scanUnitDirectory(const QString &directory, const QString &profile)
+{
+    UnitDirectoryScan result;
+    const QString subdirectory = QFileInfo(directory).fileName();
+    QDirIterator it(directory, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden);
+    while (it.hasNext()) {
+        const QFileInfo info = it.nextFileInfo();
+        TargetArtifact artifact;
+        artifact.path = FilePath::fromFileInfo(info);
+        artifact.profile = profile;
+        artifact.size = info.isDir() ? directorySize(info.filePath()) : info.size();
+
+        QString stem = info.fileName().section('.', 0, 0);
+        if (subdirectory == ".fingerprint") {
+            artifact.kind = ArtifactKind::Fingerprint;
+        } else if (subdirectory == "build") {
+            artifact.kind = ArtifactKind::BuildScript;
+        } else if (subdirectory == "incremental") {
+            artifact.kind = ArtifactKind::Incremental;
+        } else {
+            artifact.kind = kindForFile(info);
+            if (stem.startsWith("lib") && artifact.kind != ArtifactKind::Executable)
+                stem = stem.mid(3);
+        }
+
+        if (!splitUnitName(stem, &artifact.crate, &artifact.hash))
+            artifact.crate = stem;
+        if (artifact.kind == ArtifactKind::Fingerprint && !artifact.hash.isEmpty()) {
+            result.packages.insert(artifact.hash,
+                                   {artifact.crate, precalculatedVersion(info.filePath())});
+        }
+        result.artifacts.append(artifact);
+    }
+    return result;
+}
+
+static bool isProfileDirectory(const FilePath &directory)
+{
+    return directory.pathAppended("deps").isDir() || directory.pathAppended(".fingerprint").isDir();
+}
+
+// Cargo.lock is TOML, but only the [[package]] tables are of interest and
+// cargo always writes them one key per line.
+static QSet<QString> lockedPackages(const FilePath &cargoLock, bool *ok)
+{
+    QSet<QString> result;
+    const expected_str<QByteArray> contents = cargoLock.fileContents();
+    *ok = bool(contents);
+    if (!contents)
+        return result;
+
+    QString name;
+    const auto value = [](const QString &line) {
+        return line.section('"', 1, 1);
+    };
+    for (const QByteArray &rawLine : contents->split('\n')) {
+        const QString line = QString::fromUtf8(rawLine).trimmed();
+        if (line.startsWith('[')) {
+            name.clear();
+        } else if (line.startsWith("name ")) {
+            name = value(line);
+        } else if (line.startsWith("version ")) {
+            result.insert(name + '@' + value(line));
+        } else if (line.startsWith("source ") && line.contains("git+")) {
+            // Git dependencies are fingerprinted by the locked revision.
+            result.insert(name + '@' + value(line).section('#', -1));
+        }
+    }
+    return result;
+}
+
+TargetUsageReport scanTargetDirectories(const FilePaths &targetDirectories,
+                                        const FilePath &cargoLock)
+{
+    // One job per subdirectory of each profile directory, deps/ of a large
+    // workspace holds tens of thousands of files.
+    QList<QFuture<UnitDirectoryScan>> jobs;
+    for (const FilePath &root : targetDirectories) {
+        const QString rootName = root.parentDir().fileName() == "feature-matrix"
+                                     ? "feature-matrix/" + root.fileName()
+                                     : root.fileName();
+        QList<QPair<FilePath, QString>> profiles;
+        // target/qtc holds no profile directories itself, the managed
+        // target directories below it are passed in on their own.
+        for (const FilePath &child : root.dirEntries(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            if (isProfileDirectory(child)) {
+                profiles.append({child, rootName + '/' + child.fileName()});
+                continue;
+            }
+            // target/<triple>/<profile> when building for an explicit target.
+            for (const FilePath &grandChild : child.dirEntries(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                if (isProfileDirectory(grandChild)) {
+                    profiles.append({grandChild, rootName + '/' + child.fileName() + '/'
+                                                     + grandChild.fileName()});
+                }
+            }
+        }
+        for (const auto &[directory, profile] : std::as_const(profiles)) {
+            for (const FilePath &unitDirectory :
+                 directory.dirEntries(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden)) {
+                jobs.append(Utils::asyncRun(scanUnitDirectory, unitDirectory.toFSPathString(),
+                                            profile));
+            }
+            // Files directly in the profile directory are hard links into
+            // deps/, counting them would count every binary twice.
+        }
+    }
+
+    TargetUsageReport report;
+    QHash<QString, QPair<QString, QString>> packages;
+    for (QFuture<UnitDirectoryScan> &job : jobs) {
+        const UnitDirectoryScan scan = job.result();
+        report.artifacts << scan.artifacts;
+        packages.insert(scan.packages);
+    }
+
+    const QSet<QString> locked = lockedPackages(cargoLock, &report.lockFileRead);
+    for (TargetArtifact &artifact : report.artifacts) {
+        const auto package = packages.constFind(artifact.hash);
+        if (package == packages.constEnd())
+            continue;
+        // Package names use dashes, file names the crate name with underscores.
+        artifact.crate = package->first;
+        artifact.version = package->second;
+        artifact.stale = report.lockFileRead && !artifact.version.isEmpty()
+                         && !locked.contains(artifact.crate + '@' + artifact.version);
+    }
+    return report;
+}
+
+QStringList removeArtifacts(const QList<TargetArtifact> &artifacts)
+{
+    QStringList failed;
+    for (const TargetArtifact &artifact : artifacts) {
+        const bool removed = artifact.path.isDir() ? artifact.path.removeRecursively()
+                                                   : artifact.path.removeFile();
+        if (!removed && artifact.path.exists())
+            failed << artifact.path.toUserOutput();
+    }
+    return failed;
+}
+
+} // Rusty::Internal
@@ -0,0 +1,73 @@
+#ifndef TARGETUSAGE_H
+#define TARGETUSAGE_H
+
+#include <utils/filepath.h>
+
+#include <QHash>
+
+namespace Rusty::Internal {
+
+enum class ArtifactKind {
+    Rlib,
+    Rmeta,
+    SharedLibrary,
+    Executable,
+    DebugInfo,
+    DepInfo,
+    BuildScript,
+    Incremental,
+    Fingerprint,
+    Other
+};
+
+QString artifactKindName(ArtifactKind kind);
+
+class TargetArtifact
+{
+public:
+    Utils::FilePath path;
+    QString profile;  // "target/debug", "gnu-dev-1a2b3c4d/x86_64-unknown-linux-gnu/release", ...
+    QString crate;
+    QString version;  // Only known for dependencies built from a registry or git.
+    QString hash;     // The metadata hash cargo appends to file and directory names.
+    ArtifactKind kind = ArtifactKind::Other;
+    qint64 size = 0;
+    bool stale = false;
+};
+
+/**
+ * @brief Disk usage of the Cargo target directories of a project
+ *
+ * An artifact is stale when it was built for a dependency version that is
+ * no longer in Cargo.lock. Cargo never removes those by itself, after a few
+ * dependency updates they make up most of a target directory.
+ */
+class TargetUsageReport
+{
+public:
+    QList<TargetArtifact> artifacts;
+    bool lockFileRead = false;
+
+    qint64 totalSize() const;
+    qint64 staleSize() const;
+    QList<TargetArtifact> staleArtifacts() const;
+
+    QHash<QString, qint64> sizeByProfile() const;
+    QHash<QString, qint64> sizeByCrate() const;
+    QHash<ArtifactKind, qint64> sizeByKind() const;
+};
+
+// The project's target directory, the managed ones below target/qtc and the
+// feature matrix slots of both.
+Utils::FilePaths cargoTargetDirectories(const Utils::FilePath &projectDirectory);
+
+// Scans the profile directories in parallel, meant to be run on a worker thread.
+TargetUsageReport scanTargetDirectories(const Utils::FilePaths &targetDirectories,
+                                        const Utils::FilePath &cargoLock);
+
+// Returns the paths that could not be removed.
+QStringList removeArtifacts(const QList<TargetArtifact> &artifacts);
+
+} // Rusty::Internal
+
+#endif // TARGETUSAGE_H
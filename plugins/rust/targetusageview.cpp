@@ -0,0 +1,229 @@
+#include "targetusageview.h"
+
+#include "cargobuildscheduler.h"
+#include "resultutils.h"
+#include "rusttr.h"
+#include "targetusage.h"
+
+#include <coreplugin/messagemanager.h>
+
+#include <extensionsystem/pluginmanager.h>
+
+#include <projectexplorer/project.h>
+
+#include <utils/async.h>
+#include <utils/futuresynchronizer.h>
+#include <utils/layoutbuilder.h>
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QLocale>
+#include <QPushButton>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QTabWidget>
+#include <QTreeView>
+
+using namespace ProjectExplorer;
+using namespace Utils;
+
+namespace Rusty::Internal {
+
+static QString dataSize(qint64 bytes)
+{
+    return QLocale::system().formattedDataSize(bytes);
+}
+
+// Sizes are displayed human readable but sorted by their byte count.
+static QStandardItem *sizeItem(qint64 bytes)
+{
+    return sortedItem(dataSize(bytes), bytes);
+}
+
+class UsageTable : public QTreeView
+{
+public:
+    explicit UsageTable(const QStringList &headers)
+        : m_headers(headers)
+    {
+        m_proxy.setSourceModel(&m_model);
+        m_proxy.setSortRole(Qt::UserRole);
+        setModel(&m_proxy);
+        setRootIsDecorated(false);
+        setSortingEnabled(true);
+        setUniformRowHeights(true);
+        header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+        clear();
+    }
+
+    void clear()
+    {
+        m_model.clear();
+        m_model.setHorizontalHeaderLabels(m_headers);
+    }
+
+    void appendRow(const QList<QStandardItem *> &row) { m_model.appendRow(row); }
+
+private:
+    const QStringList m_headers;
+    QStandardItemModel m_model;
+    QSortFilterProxyModel m_proxy;
+};
+
+class TargetUsageView : public QWidget
+{
+public:
+    explicit TargetUsageView(const FilePath &projectDirectory)
+        : m_projectDirectory(projectDirectory)
+    {
+        setWindowTitle(Tr::tr("Target Directory Usage"));
+        resize(900, 650);
+
+        m_summary = new QLabel;
+        m_summary->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        m_profiles = new UsageTable({Tr::tr("Profile"), Tr::tr("Size")});
+        m_crates = new UsageTable({Tr::tr("Crate"), Tr::tr("Size")});
+        m_kinds = new UsageTable({Tr::tr("Artifact Type"), Tr::tr("Size")});
+        m_stale = new UsageTable({Tr::tr("Crate"), Tr::tr("Version"), Tr::tr("Profile"),
+                                  Tr::tr("Type"), Tr::tr("Size"), Tr::tr("Path")});
+
+        auto tabs = new QTabWidget;
+        tabs->addTab(m_profiles, Tr::tr("By Profile"));
+        tabs->addTab(m_crates, Tr::tr("By Crate"));
+        tabs->addTab(m_kinds, Tr::tr("By Artifact Type"));
+        tabs->addTab(m_stale, Tr::tr("Stale Artifacts"));
+
+        m_rescan = new QPushButton(Tr::tr("Rescan"));
+        m_prune = new QPushButton(Tr::tr("Remove Stale Artifacts"));
+        m_prune->setToolTip(Tr::tr("Removes artifacts of dependency versions that are no longer "
+                                   "in Cargo.lock. Not available while cargo is running."));
+
+        using namespace Layouting;
+        Column {
+            m_summary,
+            tabs,
+            Row { st, m_rescan, m_prune }
+        }.attachTo(this);
+
+        connect(m_rescan, &QPushButton::clicked, this, &TargetUsageView::scan);
+        connect(m_prune, &QPushButton::clicked, this, &TargetUsageView::prune);
+        if (CargoBuildScheduler *scheduler = CargoBuildScheduler::instance()) {
+            connect(scheduler, &CargoBuildScheduler::cargoRunningChanged,
+                    this, &TargetUsageView::updateButtons);
+        }
+        scan();
+    }
+
+private:
+    void scan()
+    {
+        m_busy = true;
+        updateButtons();
+        m_summary->setText(Tr::tr("Scanning target directories..."));
+        const auto future = Utils::asyncRun(scanTargetDirectories,
+                                            cargoTargetDirectories(m_projectDirectory),
+                                            m_projectDirectory.pathAppended("Cargo.lock"));
+        Utils::onResultReady(future, this, [this](const TargetUsageReport &report) {
+            m_report = report;
+            m_busy = false;
+            updateView();
+            updateButtons();
+        });
+        ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(future);
+    }
+
+    void prune()
+    {
+        // Cargo would happily pick up a half removed unit, or write into one
+        // that is just being removed. Besides builds, that is any pre-build,
+        // feature matrix or emit build, the scheduler holds all of them back
+        // until the removal is done.
+        CargoBuildScheduler *scheduler = CargoBuildScheduler::instance();
+        if (!scheduler || !scheduler->startPrune())
+            return;
+        m_busy = true;
+        updateButtons();
+        m_summary->setText(Tr::tr("Removing stale artifacts..."));
+        const auto future = Utils::asyncRun(removeArtifacts, m_report.staleArtifacts());
+        // Also when the view is gone by then.
+        Utils::onFinished(future, scheduler, [scheduler](const QFuture<QStringList> &) {
+            scheduler->pruneFinished();
+        });
+        Utils::onResultReady(future, this, [this](const QStringList &failed) {
+            for (const QString &path : failed)
+                Core::MessageManager::writeSilently(Tr::tr("Could not remove \"%1\".").arg(path));
+            scan();
+        });
+        ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(future);
+    }
+
+    void updateButtons()
+    {
+        m_rescan->setEnabled(!m_busy);
+        m_prune->setEnabled(!m_busy && !CargoBuildScheduler::isCargoRunning()
+                            && m_report.staleSize() > 0);
+    }
+
+    void updateView()
+    {
+        m_profiles->clear();
+        const QHash<QString, qint64> profiles = m_report.sizeByProfile();
+        for (auto it = profiles.cbegin(), end = profiles.cend(); it != end; ++it)
+            m_profiles->appendRow({textItem(it.key()), sizeItem(it.value())});
+        m_profiles->sortByColumn(1, Qt::DescendingOrder);
+
+        m_crates->clear();
+        const QHash<QString, qint64> crates = m_report.sizeByCrate();
+        for (auto it = crates.cbegin(), end = crates.cend(); it != end; ++it)
+            m_crates->appendRow({textItem(it.key()), sizeItem(it.value())});
+        m_crates->sortByColumn(1, Qt::DescendingOrder);
+
+        m_kinds->clear();
+        const QHash<ArtifactKind, qint64> kinds = m_report.sizeByKind();
+        for (auto it = kinds.cbegin(), end = kinds.cend(); it != end; ++it)
+            m_kinds->appendRow({textItem(artifactKindName(it.key())), sizeItem(it.value())});
+        m_kinds->sortByColumn(1, Qt::DescendingOrder);
+
+        m_stale->clear();
+        const QList<TargetArtifact> stale = m_report.staleArtifacts();
+        for (const TargetArtifact &artifact : stale) {
+            m_stale->appendRow({textItem(artifact.crate), textItem(artifact.version),
+                                textItem(artifact.profile),
+                                textItem(artifactKindName(artifact.kind)),
+                                sizeItem(artifact.size),
+                                textItem(artifact.path.toUserOutput())});
+        }
+        m_stale->sortByColumn(4, Qt::DescendingOrder);
+
+        QString summary = Tr::tr("%1 in %n profiles, %2 of it in %3 stale artifacts.", nullptr,
+                                 profiles.size())
+                              .arg(dataSize(m_report.totalSize()),
+                                   dataSize(m_report.staleSize()))
+                              .arg(stale.size());
+        if (!m_report.lockFileRead)
+            summary += '\n' + Tr::tr("Cargo.lock could not be read, stale artifacts are not "
+                                     "detected.");
+        m_summary->setText(summary);
+    }
+
+    const FilePath m_projectDirectory;
+    TargetUsageReport m_report;
+    bool m_busy = false;
+    QLabel *m_summary = nullptr;
+    UsageTable *m_profiles = nullptr;
+    UsageTable *m_crates = nullptr;
+    UsageTable *m_kinds = nullptr;
+    UsageTable *m_stale = nullptr;
+    QPushButton *m_rescan = nullptr;
+    QPushButton *m_prune = nullptr;
+};
+
+void showTargetUsage(Project *project)
+{
+    if (!project)
+        return;
+    auto view = new TargetUsageView(project->projectDirectory());
+    showResultWindow(view);
+}
+
+} // Rusty::Internal
@@ -0,0 +1,12 @@
+#ifndef TARGETUSAGEVIEW_H
+#define TARGETUSAGEVIEW_H
+
+namespace ProjectExplorer { class Project; }
+
+namespace Rusty::Internal {
+
+void showTargetUsage(ProjectExplorer::Project *project);
+
+} // Rusty::Internal
+
+#endif // TARGETUSAGEVIEW_H
@@ -0,0 +1,77 @@
+#include "rustdemangle.h"
+
+#include <QTest>
+
+using namespace Rusty::Internal;
+
+class tst_RustDemangle : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void demangle_data();
+    void demangle();
+    void demangleText();
+};
+
+void tst_RustDemangle::demangle_data()
+{
+    QTest::addColumn<QString>("symbol");
+    QTest::addColumn<QString>("demangled");
+
+    QTest::newRow("legacy") << "_ZN4core3fmt9Formatter3pad17h0123456789abcdefE"
+                            << "core::fmt::Formatter::pad";
+    QTest::newRow("legacy escapes")
+        << "_ZN4core3ptr46drop_in_place$LT$alloc..vec..Vec$LT$u8$GT$$GT$17h0123456789abcdefE"
+        << "core::ptr::drop_in_place<alloc::vec::Vec<u8>>";
+    QTest::newRow("legacy closure")
+        << "_ZN3std2rt10lang_start28_$u7b$$u7b$closure$u7d$$u7d$17h0123456789abcdefE"
+        << "std::rt::lang_start::{{closure}}";
+    QTest::newRow("legacy macOS") << "__ZN4core3fmt9Formatter3pad17h0123456789abcdefE"
+                                  << "core::fmt::Formatter::pad";
+    QTest::newRow("legacy without hash") << "_ZN3foo3barE" << "";
+    QTest::newRow("C++") << "_Z3foov" << "";
+
+    QTest::newRow("v0") << "_RNvC6_123foo3bar" << "123foo::bar";
+    QTest::newRow("v0 generic") << "_RINvNtC3std3mem8align_ofdE" << "std::mem::align_of::<f64>";
+    QTest::newRow("v0 inherent impl") << "_RMC0INtC8arrayvec8ArrayVechKj7b_E"
+                                      << "<arrayvec::ArrayVec<u8, 123>>";
+    QTest::newRow("v0 closures and backref") << "_RNCNCNgCs6DXkGYLi8lr_2cc5spawn00B5_"
+                                             << "cc::spawn::{closure#0}::{closure#0}";
+    QTest::newRow("v0 bool constant") << "_RINvC4test3fooKb1_E" << "test::foo::<true>";
+    QTest::newRow("v0 char constant") << "_RINvC4test3fooKc76_E" << "test::foo::<'v'>";
+    QTest::newRow("v0 vendor suffix") << "_RNvC4test3foo.llvm.123" << "test::foo";
+    QTest::newRow("v0 punycode")
+        << "_RNqCs4fqI2P2rA04_11utf8_identsu30____7hkackfecea1cbdathfdh9hlq6y"
+        << QString::fromUtf8("utf8_idents::საჭმელად_გემრიელი_სადილი");
+    QTest::newRow("v0 truncated") << "_RNvC4test3fo" << "";
+    // Each function type repeats the previous one three times.
+    QTest::newRow("v0 exponential backrefs")
+        << "_RINvC1a1bShFB7_B7_EB7_FB9_B9_EB9_FBk_Bk_EBk_FBv_Bv_EBv_FBG_BG_EBG_FBR_BR_EBR_FB12_B"
+           "12_EB12_FB1d_B1d_EB1d_FB1r_B1r_EB1r_FB1F_B1F_EB1F_FB1T_B1T_EB1T_FB27_B27_EB27_FB2l_B"
+           "2l_EB2l_FB2z_B2z_EB2z_FB2N_B2N_EB2N_FB31_B31_EB31_FB3f_B3f_EB3f_FB3t_B3t_EB3t_FB3H_B"
+           "3H_EB3H_FB3V_B3V_EB3V_FB49_B49_EB49_FB4n_B4n_EB4n_FB4B_B4B_EB4B_FB4P_B4P_EB4P_FB53_B"
+           "53_EB53_FB5h_B5h_EB5h_FB5v_B5v_EB5v_FB5J_B5J_EB5J_FB5X_B5X_EB5X_FB6b_B6b_EB6b_E"
+        << "";
+}
+
+void tst_RustDemangle::demangle()
+{
+    QFETCH(QString, symbol);
+    QFETCH(QString, demangled);
+
+    QCOMPARE(demangleRustSymbol(symbol), demangled);
+}
+
+void tst_RustDemangle::demangleText()
+{
+    QCOMPARE(demangleRustSymbols("  3: _ZN4core3fmt9Formatter3pad17h0123456789abcdefE+0x12"),
+             QString("  3: core::fmt::Formatter::pad+0x12"));
+    QCOMPARE(demangleRustSymbols("at _RNvC6_123foo3bar and _Z3foov"),
+             QString("at 123foo::bar and _Z3foov"));
+    QVERIFY(!mayContainRustSymbol("no symbols here"));
+}
+
+QTEST_GUILESS_MAIN(tst_RustDemangle)
+
+#include "tst_rustdemangle.moc"